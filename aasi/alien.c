@@ -5,6 +5,7 @@
 #include "screen_obj.h"
 #include "alien.h"
 #include "ooc.h"
+#include "so_pool.h"
 
 
 static const unsigned long _aasi_alien_interval = 50;
@@ -15,6 +16,8 @@ struct _aasi_alien_t {
 	unsigned long ts;
 };
 
+_Static_assert(sizeof(aasi_alien_t) <= AASI_SO_POOL_SLOT_SIZE, "alien does not fit a pool slot");
+
 static void _aasi_alien_task(aasi_screen_obj_t *this);
 static void _aasi_alien_hit(aasi_screen_obj_t *this);
 
@@ -39,14 +42,7 @@ static bool _aasi_alien_init(aasi_alien_t *this, aasi_game_t *game, int height)
 }
 
 aasi_alien_t* aasi_alien_new(aasi_game_t *game, int height) {
-	aasi_alien_t *this = NEW(aasi_alien_t);
-	if (this) {
-		if (!_aasi_alien_init(this, game, height)) {
-			free(this);
-			this = NULL;
-		}
-	}
-	return this;
+	return GAME_NEW_INIT(game, aasi_alien_t, _aasi_alien_init, game, height);
 }
 
 void _aasi_alien_task(aasi_screen_obj_t *base) {
@@ -2,12 +2,15 @@
 #include "screen_obj.h"
 #include "block.h"
 #include "ooc.h"
+#include "so_pool.h"
 
 struct _aasi_block_t {
 	aasi_screen_obj_t so;
 	int hp;
 };
 
+_Static_assert(sizeof(aasi_block_t) <= AASI_SO_POOL_SLOT_SIZE, "block does not fit a pool slot");
+
 static void _aasi_block_hit(aasi_screen_obj_t *base);
 
 static const int aasi_block_init_hit_points = 4;
@@ -29,7 +32,7 @@ static bool _aasi_block_init(aasi_block_t *this, struct _aasi_game_t *game) {
 }
 
 aasi_block_t *aasi_block_new(struct _aasi_game_t *game) {
-	return NEW_INIT(aasi_block_t, _aasi_block_init, game);
+	return GAME_NEW_INIT(game, aasi_block_t, _aasi_block_init, game);
 }
 
 void _aasi_block_hit(aasi_screen_obj_t *base) {
@@ -1,7 +1,9 @@
 #include <aasi/display.h>
+#include <aasi/game.h>
 #include "screen_obj.h"
 #include "bomb.h"
 #include "ooc.h"
+#include "so_pool.h"
 
 static const unsigned long aasi_bomb_interval = 40;
 
@@ -10,14 +12,21 @@ struct _aasi_bomb_t {
 	int y_dir;
 	const aasi_screen_obj_t *src;
 	unsigned long ts;
+	int impact_y;
+	unsigned short impact_gen;
 	bool offscreen;
+	bool impact_valid;
 };
 
+_Static_assert(sizeof(aasi_bomb_t) <= AASI_SO_POOL_SLOT_SIZE, "bomb does not fit a pool slot");
+
 static void _aasi_bomb_task(aasi_screen_obj_t *this);
+static void _aasi_bomb_relocate(aasi_screen_obj_t *this, ptrdiff_t delta);
 
 static const char _aasi_bomb_shape[] = "o";
 static const aasi_screen_obj_ops_t _aasi_bomb_ops = {
-	.task = _aasi_bomb_task,
+	.task     = _aasi_bomb_task,
+	.relocate = _aasi_bomb_relocate,
 };
 
 bool _aasi_bomb_init(aasi_bomb_t *this, const aasi_screen_obj_t *source, int y_dir) {
@@ -31,6 +40,7 @@ bool _aasi_bomb_init(aasi_bomb_t *this, const aasi_screen_obj_t *source, int y_d
 	this->src = source;
 	this->ts = _aasi_screen_obj_millis(source);
 	this->offscreen = false;
+	this->impact_valid = false;
 
 	const int y = aasi_screen_obj_get_y(source) + this->y_dir;
 	const int x = aasi_screen_obj_get_center(source);
@@ -38,7 +48,7 @@ bool _aasi_bomb_init(aasi_bomb_t *this, const aasi_screen_obj_t *source, int y_d
 }
 
 aasi_bomb_t* aasi_bomb_new(const aasi_screen_obj_t *source, int y_dir) {
-	return NEW_INIT(aasi_bomb_t, _aasi_bomb_init, source, y_dir);
+	return GAME_NEW_INIT(source->_game, aasi_bomb_t, _aasi_bomb_init, source, y_dir);
 }
 
 const aasi_screen_obj_t* aasi_bomb_get_source(const aasi_bomb_t *this) {
@@ -63,6 +73,34 @@ void _aasi_bomb_task(aasi_screen_obj_t *base) {
 	}
 }
 
+void _aasi_bomb_relocate(aasi_screen_obj_t *base, ptrdiff_t delta) {
+	aasi_bomb_t *const this = (aasi_bomb_t*)base;
+	// the source may already be destroyed, it is only compared, never dereferenced
+	this->src = (const aasi_screen_obj_t*)((const char*)this->src + delta);
+}
+
 bool aasi_bomb_is_off_screen(const aasi_bomb_t *this) {
 	return this->offscreen;
 }
+
+int aasi_bomb_get_y_dir(const aasi_bomb_t *this) {
+	return this->y_dir;
+}
+
+void aasi_bomb_set_impact(aasi_bomb_t *this, int impact_y, unsigned short column_gen) {
+	this->impact_y = impact_y;
+	this->impact_gen = column_gen;
+	this->impact_valid = true;
+}
+
+bool aasi_bomb_is_impact_valid(const aasi_bomb_t *this, unsigned short column_gen) {
+	return this->impact_valid && this->impact_gen == column_gen;
+}
+
+int aasi_bomb_get_impact_y(const aasi_bomb_t *this) {
+	return this->impact_y;
+}
+
+void aasi_bomb_invalidate_impact(aasi_bomb_t *this) {
+	this->impact_valid = false;
+}
@@ -10,5 +10,14 @@ typedef struct _aasi_bomb_t aasi_bomb_t;
 aasi_bomb_t* aasi_bomb_new(const struct _aasi_screen_obj_t *source, int y_dir);
 const struct _aasi_screen_obj_t* aasi_bomb_get_source(const aasi_bomb_t *this);
 bool aasi_bomb_is_off_screen(const aasi_bomb_t *this);
+int aasi_bomb_get_y_dir(const aasi_bomb_t *this);
+
+// Predicted impact: the first row on the bomb's path occupied by something it can hit,
+// valid while the generation of its column stays the same and what it can hit does not
+// change, which its source dying does.
+void aasi_bomb_set_impact(aasi_bomb_t *this, int impact_y, unsigned short column_gen);
+bool aasi_bomb_is_impact_valid(const aasi_bomb_t *this, unsigned short column_gen);
+int aasi_bomb_get_impact_y(const aasi_bomb_t *this);
+void aasi_bomb_invalidate_impact(aasi_bomb_t *this);
 
 #endif
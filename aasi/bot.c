@@ -0,0 +1,151 @@
+#include <stdlib.h>
+
+#include <aasi/bot.h>
+#include <aasi/game.h>
+#include "screen_obj.h"
+#include "ooc.h"
+
+#define AASI_BOT_CANDIDATES 4
+
+struct _aasi_bot_t {
+	aasi_bot_config_t cfg;
+	aasi_game_t *scratch;
+	unsigned long rollouts;
+	unsigned long ticks;
+};
+
+static const aasi_button_t _aasi_bot_candidates[AASI_BOT_CANDIDATES] = {
+	AASI_GAME_KEY_NOT_MAPPED,
+	AASI_GAME_KEY_LEFT,
+	AASI_GAME_KEY_RIGHT,
+	AASI_GAME_KEY_FIRE,
+};
+
+// The random provider has no context, rollouts of all bots share one xorshift state.
+static unsigned int _aasi_bot_rng_state = 1;
+
+static unsigned int _aasi_bot_rand() {
+	unsigned int x = _aasi_bot_rng_state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	_aasi_bot_rng_state = x;
+	return x;
+}
+
+void aasi_bot_default_config(aasi_bot_config_t *cfg) {
+	cfg->rollouts = 16;
+	cfg->depth = 8;
+	cfg->step_ms = 300 / GAME_SPEED_FACTOR;
+	cfg->tick_ms = 10 / GAME_SPEED_FACTOR;
+	cfg->seed = 1;
+}
+
+static bool _aasi_bot_init(aasi_bot_t *this, const aasi_bot_config_t *cfg) {
+	if (cfg) {
+		this->cfg = *cfg;
+	} else {
+		aasi_bot_default_config(&this->cfg);
+	}
+	if (this->cfg.rollouts < 1 || this->cfg.depth < 1 || !this->cfg.tick_ms || !this->cfg.step_ms) {
+		return false;
+	}
+	if (this->cfg.seed) {
+		_aasi_bot_rng_state = this->cfg.seed;
+	}
+	this->scratch = NULL;
+	this->rollouts = 0;
+	this->ticks = 0;
+	return true;
+}
+
+aasi_bot_t *aasi_bot_new(const aasi_bot_config_t *cfg) {
+	return NEW_INIT(aasi_bot_t, _aasi_bot_init, cfg);
+}
+
+void aasi_bot_delete(aasi_bot_t *this) {
+	if (this->scratch) {
+		aasi_game_delete(this->scratch);
+	}
+	free(this);
+}
+
+static void _aasi_bot_advance(aasi_bot_t *this, aasi_game_t *game) {
+	const unsigned long ts_end = aasi_game_get_duration_ms(game) + this->cfg.step_ms;
+	unsigned long ts = aasi_game_get_duration_ms(game);
+	while (ts < ts_end && aasi_game_is_running(game)) {
+		ts += this->cfg.tick_ms;
+		aasi_game_task(game, ts);
+		this->ticks++;
+	}
+}
+
+static int _aasi_bot_aim_distance(const aasi_game_t *game) {
+	const int hero_x = aasi_screen_obj_get_center(_aasi_game_get_hero_obj(game));
+	int best = -1;
+	const aasi_screen_obj_t *alien;
+	for (int i = 0; (alien = _aasi_game_get_alien_obj(game, i)); ++i) {
+		const int dist = abs(aasi_screen_obj_get_center(alien) - hero_x);
+		if (best < 0 || dist < best) {
+			best = dist;
+		}
+	}
+	return best < 0 ? 0 : best;
+}
+
+static long _aasi_bot_evaluate(const aasi_game_t *game, int aliens_before) {
+	long score = 1000L * (aliens_before - aasi_game_get_alien_count(game));
+	switch (aasi_game_get_winner(game)) {
+		case AASI_GAME_WINNER_HERO:   score += 10000 - (long)aasi_game_get_duration_ms(game); break;
+		case AASI_GAME_WINNER_ALIENS: score -= 10000;                                         break;
+		default:                                                                              break;
+	}
+	return score - _aasi_bot_aim_distance(game);
+}
+
+static long _aasi_bot_rollout(aasi_bot_t *this, const aasi_game_t *game, aasi_button_t first) {
+	aasi_game_copy(this->scratch, game);
+	aasi_game_set_random_provider(this->scratch, _aasi_bot_rand);
+	const int aliens_before = aasi_game_get_alien_count(game);
+
+	aasi_button_t key = first;
+	for (int step = 0; step < this->cfg.depth && aasi_game_is_running(this->scratch); ++step) {
+		aasi_game_handle_key(this->scratch, key);
+		_aasi_bot_advance(this, this->scratch);
+		key = _aasi_bot_candidates[_aasi_bot_rand() % AASI_BOT_CANDIDATES];
+	}
+	this->rollouts++;
+	return _aasi_bot_evaluate(this->scratch, aliens_before);
+}
+
+aasi_button_t aasi_bot_choose(aasi_bot_t *this, const aasi_game_t *game) {
+	if (!this->scratch) {
+		// the only allocation, every rollout reuses it
+		this->scratch = aasi_game_new_clone(game);
+		if (!this->scratch) {
+			return AASI_GAME_KEY_NOT_MAPPED;
+		}
+	}
+
+	aasi_button_t best_key = AASI_GAME_KEY_NOT_MAPPED;
+	long best_total = 0;
+	for (int c = 0; c < AASI_BOT_CANDIDATES; ++c) {
+		long total = 0;
+		for (int r = 0; r < this->cfg.rollouts; ++r) {
+			total += _aasi_bot_rollout(this, game, _aasi_bot_candidates[c]);
+		}
+		if (c == 0 || total > best_total) {
+			best_total = total;
+			best_key = _aasi_bot_candidates[c];
+		}
+	}
+	return best_key;
+}
+
+unsigned long aasi_bot_get_rollouts(const aasi_bot_t *this) {
+	return this->rollouts;
+}
+
+unsigned long aasi_bot_get_ticks(const aasi_bot_t *this) {
+	return this->ticks;
+}
@@ -1,4 +1,7 @@
+#include <stddef.h>
+
 #include <aasi/display.h>
+#include "prof.h"
 
 bool aasi_display_init(aasi_display_t *this, const aasi_display_ops_t *ops, int width, int height) {
 	if (!this || !ops || !ops->mvputs || width < 8 || height < 3) {
@@ -7,6 +10,23 @@ bool aasi_display_init(aasi_display_t *this, const aasi_display_ops_t *ops, int
 	this->_ops = ops;
 	this->_width = width;
 	this->_height = height;
+#if CONFIG_AASI_PROFILER
+	this->_prof = NULL;
+#endif
+	return true;
+}
+
+// A display without a backend: sizes only, every draw call is dropped.
+bool aasi_display_init_headless(aasi_display_t *this, int width, int height) {
+	if (!this || width < 8 || height < 3) {
+		return false;
+	}
+	this->_ops = NULL;
+	this->_width = width;
+	this->_height = height;
+#if CONFIG_AASI_PROFILER
+	this->_prof = NULL;
+#endif
 	return true;
 }
 
@@ -22,24 +42,104 @@ void aasi_display_start(aasi_display_t *this) {
 	}
 }
 
+#if CONFIG_AASI_DISPLAY_STATIC
+
 void aasi_display_mvclr(aasi_display_t *this, void **obj, int y, int x, const char *s) {
-	if (this && this->_ops->mvclr) {
+	if (this && this->_ops) {
+		AASI_PROF_BEGIN(t0);
+		aasi_display_backend_mvclr(this, obj, y, x, s);
+		AASI_PROF_END(this->_prof, AASI_PROF_PHASE_DISPLAY_MVCLR, t0);
+	}
+}
+
+void aasi_display_mvputs(aasi_display_t *this, void **obj, int y, int x, const char *s) {
+	if (this && this->_ops) {
+		AASI_PROF_BEGIN(t0);
+		aasi_display_backend_mvputs(this, obj, y, x, s);
+		AASI_PROF_END(this->_prof, AASI_PROF_PHASE_DISPLAY_MVPUTS, t0);
+	}
+}
+
+void aasi_display_objdel(aasi_display_t *this, void **obj) {
+	if (this && this->_ops) {
+		AASI_PROF_BEGIN(t0);
+		aasi_display_backend_objdel(this, obj);
+		AASI_PROF_END(this->_prof, AASI_PROF_PHASE_DISPLAY_OBJDEL, t0);
+	}
+}
+
+// The ops table still tells whether the backend clears, like in the dynamic build.
+bool aasi_display_clear(aasi_display_t *this) {
+	if (!this || !this->_ops) {
+		return true;
+	}
+	if (this->_ops->clear) {
+		AASI_PROF_BEGIN(t0);
+		aasi_display_backend_clear(this);
+		AASI_PROF_END(this->_prof, AASI_PROF_PHASE_DISPLAY_OBJDEL, t0);
+		return true;
+	}
+	return !this->_ops->objdel;
+}
+
+void aasi_display_present(aasi_display_t *this) {
+	if (this && this->_ops) {
+		AASI_PROF_BEGIN(t0);
+		aasi_display_backend_present(this);
+		AASI_PROF_END(this->_prof, AASI_PROF_PHASE_DISPLAY_PRESENT, t0);
+	}
+}
+
+#else
+
+void aasi_display_mvclr(aasi_display_t *this, void **obj, int y, int x, const char *s) {
+	if (this && this->_ops && this->_ops->mvclr) {
+		AASI_PROF_BEGIN(t0);
 		this->_ops->mvclr(this, obj, y, x, s);
+		AASI_PROF_END(this->_prof, AASI_PROF_PHASE_DISPLAY_MVCLR, t0);
 	}
 }
 
 void aasi_display_mvputs(aasi_display_t *this, void **obj, int y, int x, const char *s) {
 	if (this && this->_ops) {
+		AASI_PROF_BEGIN(t0);
 		this->_ops->mvputs(this, obj, y, x, s);
+		AASI_PROF_END(this->_prof, AASI_PROF_PHASE_DISPLAY_MVPUTS, t0);
 	}
 }
 
 void aasi_display_objdel(aasi_display_t *this, void **obj) {
-	if (this && this->_ops->objdel) {
+	if (this && this->_ops && this->_ops->objdel) {
+		AASI_PROF_BEGIN(t0);
 		this->_ops->objdel(this, obj);
+		AASI_PROF_END(this->_prof, AASI_PROF_PHASE_DISPLAY_OBJDEL, t0);
 	}
 }
 
+// Returns false if the objects have to be deleted one by one instead.
+bool aasi_display_clear(aasi_display_t *this) {
+	if (!this || !this->_ops) {
+		return true;
+	}
+	if (this->_ops->clear) {
+		AASI_PROF_BEGIN(t0);
+		this->_ops->clear(this);
+		AASI_PROF_END(this->_prof, AASI_PROF_PHASE_DISPLAY_OBJDEL, t0);
+		return true;
+	}
+	return !this->_ops->objdel;
+}
+
+void aasi_display_present(aasi_display_t *this) {
+	if (this && this->_ops && this->_ops->present) {
+		AASI_PROF_BEGIN(t0);
+		this->_ops->present(this);
+		AASI_PROF_END(this->_prof, AASI_PROF_PHASE_DISPLAY_PRESENT, t0);
+	}
+}
+
+#endif
+
 int aasi_display_width(const aasi_display_t *this) {
 	return this->_width;
 }
@@ -48,3 +148,10 @@ int aasi_display_height(const aasi_display_t *this) {
 	return this->_height;
 }
 
+void _aasi_display_set_prof(aasi_display_t *this, struct _aasi_prof_t *prof) {
+#if CONFIG_AASI_PROFILER
+	if (this) {
+		this->_prof = prof;
+	}
+#endif
+}
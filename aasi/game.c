@@ -1,29 +1,70 @@
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
+#include <aasi/config.h>
+#include <aasi/display.h>
 #include <aasi/game.h>
 #include "screen_obj.h"
 #include "so_list.h"
+#include "so_pool.h"
 #include "alien.h"
 #include "block.h"
 #include "bomb.h"
 #include "hero.h"
+#include "input.h"
 #include "ooc.h"
+#include "prof.h"
+
+#define _AASI_GAME_KEYS (AASI_GAME_KEY_DIE + 1)
+// Must be a power of two.
+#define _AASI_GAME_APPLIED_SIZE 32
+// Columns share generation counters modulo this, which only costs extra predictions.
+#define _AASI_GAME_COLUMN_GENS 64
 
 typedef struct _aasi_game_t {
+	bool in_arena;	// memory is owned by the caller, not the heap
 	struct _aasi_display_t *disp;
+	aasi_display_t headless;	// used by copies, which never draw
+	aasi_so_pool_t pool;
 	aasi_so_list_t aliens;
 	aasi_so_list_t bombs;
 	aasi_so_list_t blocks;
 	aasi_hero_t *hero;
 	unsigned long ts_start;
 	unsigned long ts_now;
+	unsigned long ticks;
+
+	int world_width;
+	int world_height;
+	int view_x;		// top left corner of the display in the world
+	int view_y;
 
 	aasi_ctxcb_t on_alien_hit;
 	aasi_ctxcb_t on_block_destroyed;
 	aasi_ctxcb_t on_hero_fire;
 
 	aasi_game_random_provider_t random_provider;
+
+	aasi_game_collision_mode_t collision_mode;
+	unsigned long collision_tests;
+	unsigned short column_gen[_AASI_GAME_COLUMN_GENS];	// bumped when a target enters or leaves a column
+
+	aasi_gov_t gov;
+	bool render;	// draws of this tick go to the display, otherwise they are deferred
+
+	aasi_input_t input;
+	struct {
+		uint32_t tag;
+		unsigned long tick;
+	} applied[_AASI_GAME_APPLIED_SIZE];	// tagged keys applied but not yet popped
+	unsigned int applied_head;
+	unsigned int applied_tail;
+
+#if CONFIG_AASI_PROFILER
+	aasi_prof_t prof;
+#endif
 } aasi_game_t;
 
 static const unsigned long _aasi_game_max_time = 30*1000UL / GAME_SPEED_FACTOR;
@@ -68,11 +109,67 @@ static unsigned int _aasi_game_default_random_provider() {
 	return rand();
 }
 
-static bool _aasi_game_init(aasi_game_t *this, struct _aasi_display_t *disp, int num_aliens, int num_blocks) {
+static int _aasi_game_clamp(int v, int lo, int hi) {
+	return v < lo ? lo : (v > hi ? hi : v);
+}
+
+static void _aasi_game_redraw_all(aasi_game_t *this) {
+	_aasi_screen_obj_redraw((aasi_screen_obj_t*)this->hero);
+	aasi_so_list_t *const lists[] = { &this->aliens, &this->blocks, &this->bombs };
+	for (size_t l = 0; l < sizeof(lists) / sizeof(*lists); ++l) {
+		AASI_SO_LIST_FOR_EACH(lists[l], so) {
+			_aasi_screen_obj_redraw(so);
+		}
+	}
+}
+
+// The viewport only scrolls once the hero leaves the middle half of the display,
+// every scroll redraws all objects.
+static void _aasi_game_follow_hero(aasi_game_t *this) {
+	const aasi_screen_obj_t *hero = (const aasi_screen_obj_t*)this->hero;
+	const int disp_width = aasi_display_width(this->disp);
+	const int disp_height = aasi_display_height(this->disp);
+	const int margin_x = disp_width / 4;
+	const int margin_y = disp_height / 4;
+	const int hero_x = aasi_screen_obj_get_center(hero);
+	const int hero_y = aasi_screen_obj_get_y(hero);
+
+	int view_x = _aasi_game_clamp(this->view_x, hero_x - disp_width + margin_x + 1, hero_x - margin_x);
+	int view_y = _aasi_game_clamp(this->view_y, hero_y - disp_height + margin_y + 1, hero_y - margin_y);
+	view_x = _aasi_game_clamp(view_x, 0, this->world_width - disp_width);
+	view_y = _aasi_game_clamp(view_y, 0, this->world_height - disp_height);
+	if (view_x != this->view_x || view_y != this->view_y) {
+		this->view_x = view_x;
+		this->view_y = view_y;
+		_aasi_game_redraw_all(this);
+	}
+}
+
+static bool _aasi_game_init(aasi_game_t *this, struct _aasi_display_t *disp, int world_width, int world_height,
+                            int num_aliens, int num_blocks, aasi_game_random_provider_t rnd) {
+	if (world_width < aasi_display_width(disp) || world_height < aasi_display_height(disp)) {
+		return false;
+	}
+	this->in_arena = false;
 	this->disp = disp;
 	this->ts_start = 0;
 	this->ts_now = 0;
-	this->random_provider = _aasi_game_default_random_provider;
+	this->ticks = 0;
+	this->world_width = world_width;
+	this->world_height = world_height;
+	this->view_x = 0;
+	this->view_y = world_height - aasi_display_height(disp);
+	this->random_provider = rnd ? rnd : _aasi_game_default_random_provider;
+	aasi_display_init_headless(&this->headless, aasi_display_width(disp), aasi_display_height(disp));
+	aasi_so_pool_init(&this->pool);
+	aasi_input_init(&this->input);
+	this->applied_head = 0;
+	this->applied_tail = 0;
+	aasi_gov_init(&this->gov, CONFIG_AASI_FRAME_BUDGET_US);
+	this->render = true;
+	this->collision_mode = AASI_GAME_COLLISION_PREDICTIVE;
+	this->collision_tests = 0;
+	memset(this->column_gen, 0, sizeof(this->column_gen));
 
 	aasi_so_list_init(&this->aliens);
 	aasi_so_list_init(&this->blocks);
@@ -82,6 +179,11 @@ static bool _aasi_game_init(aasi_game_t *this, struct _aasi_display_t *disp, int
 	aasi_ctxcb_init(&this->on_block_destroyed);
 	aasi_ctxcb_init(&this->on_hero_fire);
 
+#if CONFIG_AASI_PROFILER
+	aasi_prof_init(&this->prof);
+	_aasi_display_set_prof(disp, &this->prof);
+#endif
+
 	_aasi_game_add_aliens(this, num_aliens);
 	_aasi_game_add_blocks(this, num_blocks);
 
@@ -91,19 +193,110 @@ static bool _aasi_game_init(aasi_game_t *this, struct _aasi_display_t *disp, int
 		aasi_so_list_destroy(&this->blocks);
 		return false;
 	}
+	const int hero_x = aasi_screen_obj_get_center((aasi_screen_obj_t*)this->hero);
+	this->view_x = _aasi_game_clamp(hero_x - aasi_display_width(disp) / 2,
+	                                0, world_width - aasi_display_width(disp));
 	return true;
 }
 
 aasi_game_t* aasi_game_new(struct _aasi_display_t *disp, int num_aliens, int num_blocks) {
-	return NEW_INIT(aasi_game_t, _aasi_game_init, disp, num_aliens, num_blocks);
+	return aasi_game_new_with_random_provider(disp, num_aliens, num_blocks, NULL);
+}
+
+aasi_game_t* aasi_game_new_with_random_provider(struct _aasi_display_t *disp, int num_aliens, int num_blocks,
+                                                aasi_game_random_provider_t rnd) {
+	return aasi_game_new_in_world(disp, aasi_display_width(disp), aasi_display_height(disp),
+	                              num_aliens, num_blocks, rnd);
+}
+
+aasi_game_t* aasi_game_new_in_world(struct _aasi_display_t *disp, int world_width, int world_height,
+                                    int num_aliens, int num_blocks, aasi_game_random_provider_t rnd) {
+	return NEW_INIT(aasi_game_t, _aasi_game_init, disp, world_width, world_height, num_aliens, num_blocks, rnd);
+}
+
+size_t aasi_game_arena_size(void) {
+	return sizeof(aasi_game_t);
+}
+
+// All objects of a game live inside aasi_game_t, so one arena reused for every
+// session keeps the heap untouched by games.
+aasi_game_t* aasi_game_new_in_arena(void *arena, size_t size, struct _aasi_display_t *disp,
+                                    int world_width, int world_height,
+                                    int num_aliens, int num_blocks, aasi_game_random_provider_t rnd) {
+	aasi_game_t *this = arena;
+	if (!this || size < sizeof(aasi_game_t) || (uintptr_t)arena % _Alignof(aasi_game_t)) {
+		return NULL;
+	}
+	if (!_aasi_game_init(this, disp, world_width, world_height, num_aliens, num_blocks, rnd)) {
+		return NULL;
+	}
+	this->in_arena = true;
+	return this;
+}
+
+// A copy is a single memcpy: all objects live in the pool inside the game,
+// so every internal pointer only has to be moved by the distance between the two.
+void aasi_game_copy(aasi_game_t *dst, const aasi_game_t *src) {
+	if (dst == src) {
+		return;
+	}
+	const ptrdiff_t delta = (const char*)dst - (const char*)src;
+	const bool in_arena = dst->in_arena;
+	memcpy(dst, src, sizeof(*dst));
+	dst->in_arena = in_arena;
+	aasi_display_init_headless(&dst->headless, aasi_display_width(src->disp), aasi_display_height(src->disp));
+	dst->disp = &dst->headless;
+	aasi_input_init(&dst->input);
+	dst->applied_tail = dst->applied_head;
+	aasi_ctxcb_init(&dst->on_alien_hit);
+	aasi_ctxcb_init(&dst->on_block_destroyed);
+	aasi_ctxcb_init(&dst->on_hero_fire);
+
+	dst->hero = (aasi_hero_t*)((char*)src->hero + delta);
+	_aasi_screen_obj_relocate((aasi_screen_obj_t*)dst->hero, dst, delta);
+	aasi_so_list_t *const lists[] = { &dst->aliens, &dst->blocks, &dst->bombs };
+	for (size_t l = 0; l < sizeof(lists) / sizeof(*lists); ++l) {
+		aasi_so_list_relocate(lists[l], delta);
+		AASI_SO_LIST_FOR_EACH(lists[l], so) {
+			_aasi_screen_obj_relocate(so, dst, delta);
+		}
+	}
+}
+
+aasi_game_t* aasi_game_new_clone(const aasi_game_t *src) {
+	aasi_game_t *this = NEW(aasi_game_t);
+	if (this) {
+		this->in_arena = false;
+		aasi_game_copy(this, src);
+	}
+	return this;
+}
+
+// Objects own nothing but pool memory and display objects: when the display
+// drops all of its objects at once, the pool and the lists are simply reset.
+static void _aasi_game_release_objects(aasi_game_t *this) {
+	if (aasi_display_clear(this->disp)) {
+		aasi_so_list_init(&this->aliens);
+		aasi_so_list_init(&this->bombs);
+		aasi_so_list_init(&this->blocks);
+		aasi_so_pool_init(&this->pool);
+	} else {
+		aasi_hero_delete(this->hero);
+		aasi_so_list_destroy(&this->aliens);
+		aasi_so_list_destroy(&this->bombs);
+		aasi_so_list_destroy(&this->blocks);
+	}
+	this->hero = NULL;
 }
 
 void aasi_game_delete(aasi_game_t *this) {
-	aasi_hero_delete(this->hero);
-	aasi_so_list_destroy(&this->aliens);
-	aasi_so_list_destroy(&this->bombs);
-	aasi_so_list_destroy(&this->blocks);
-	free(this);
+	_aasi_game_release_objects(this);
+#if CONFIG_AASI_PROFILER
+	_aasi_display_set_prof(this->disp, NULL);
+#endif
+	if (!this->in_arena) {
+		free(this);
+	}
 }
 
 struct _aasi_display_t *_aasi_game_get_display(aasi_game_t *this) {
@@ -114,6 +307,46 @@ unsigned long aasi_game_get_duration_ms(const aasi_game_t *this) {
 	return this->ts_now - this->ts_start;
 }
 
+int aasi_game_get_world_width(const aasi_game_t *this) {
+	return this->world_width;
+}
+
+int aasi_game_get_world_height(const aasi_game_t *this) {
+	return this->world_height;
+}
+
+int aasi_game_get_view_x(const aasi_game_t *this) {
+	return this->view_x;
+}
+
+int aasi_game_get_view_y(const aasi_game_t *this) {
+	return this->view_y;
+}
+
+int aasi_game_get_alien_count(const aasi_game_t *this) {
+	return aasi_so_list_size(&this->aliens);
+}
+
+int aasi_game_get_block_count(const aasi_game_t *this) {
+	return aasi_so_list_size(&this->blocks);
+}
+
+void *_aasi_game_obj_alloc(aasi_game_t *this) {
+	return aasi_so_pool_alloc(&this->pool);
+}
+
+void _aasi_game_obj_free(aasi_game_t *this, void *obj) {
+	aasi_so_pool_free(&this->pool, obj);
+}
+
+const aasi_screen_obj_t *_aasi_game_get_hero_obj(const aasi_game_t *this) {
+	return (const aasi_screen_obj_t*)this->hero;
+}
+
+const aasi_screen_obj_t *_aasi_game_get_alien_obj(const aasi_game_t *this, int pos) {
+	return aasi_so_list_get(&this->aliens, pos);
+}
+
 aasi_game_winner_t aasi_game_get_winner(const aasi_game_t *this) {
 	if (!aasi_hero_is_alive(this->hero)) {
 		if (aasi_so_list_empty(&this->aliens)) {
@@ -147,13 +380,89 @@ static void _aasi_game_hero_fire(aasi_game_t *this) {
 	aasi_ctxcb_call(&this->on_hero_fire);
 }
 
+static void _aasi_game_touch_columns(aasi_game_t *this, int x, int width) {
+	if (width > _AASI_GAME_COLUMN_GENS) {
+		width = _AASI_GAME_COLUMN_GENS;
+	}
+	for (int c = x; c < x + width; ++c) {
+		this->column_gen[c % _AASI_GAME_COLUMN_GENS]++;
+	}
+}
+
+static void _aasi_game_touch_obj(aasi_game_t *this, const aasi_screen_obj_t *so) {
+	_aasi_game_touch_columns(this, aasi_screen_obj_get_x(so), aasi_screen_obj_get_width(so));
+}
+
+// Runs the task of something bombs can hit, if it moved or changed its shape the
+// predicted impacts in the columns it left and entered are no longer valid.
+static void _aasi_game_target_task(aasi_game_t *this, aasi_screen_obj_t *so) {
+	const int x = aasi_screen_obj_get_x(so);
+	const int y = aasi_screen_obj_get_y(so);
+	const int width = aasi_screen_obj_get_width(so);
+	aasi_screen_obj_task(so);
+	if (x != aasi_screen_obj_get_x(so) || y != aasi_screen_obj_get_y(so) || width != aasi_screen_obj_get_width(so)) {
+		_aasi_game_touch_columns(this, x, width);
+		_aasi_game_touch_obj(this, so);
+	}
+}
+
+static void _aasi_game_hero_move(aasi_game_t *this, int dir) {
+	_aasi_game_touch_obj(this, (aasi_screen_obj_t*)this->hero);
+	aasi_hero_move(this->hero, dir);
+	_aasi_game_touch_obj(this, (aasi_screen_obj_t*)this->hero);
+}
+
 void aasi_game_handle_key(aasi_game_t *this, aasi_button_t key) {
 	switch (key) {
-		case AASI_GAME_KEY_DIE:   aasi_hero_kill(this->hero);     break;
-		case AASI_GAME_KEY_LEFT:  aasi_hero_move(this->hero, -1); break;
-		case AASI_GAME_KEY_RIGHT: aasi_hero_move(this->hero, +1); break;
-		case AASI_GAME_KEY_FIRE:  _aasi_game_hero_fire(this);     break;
-		case AASI_GAME_KEY_NOT_MAPPED: 						      break;
+		case AASI_GAME_KEY_DIE:   aasi_hero_kill(this->hero);           break;
+		case AASI_GAME_KEY_LEFT:  _aasi_game_hero_move(this, -1);       break;
+		case AASI_GAME_KEY_RIGHT: _aasi_game_hero_move(this, +1);       break;
+		case AASI_GAME_KEY_FIRE:  _aasi_game_hero_fire(this);           break;
+		case AASI_GAME_KEY_NOT_MAPPED: 						            break;
+	}
+}
+
+bool aasi_game_post_key(aasi_game_t *this, aasi_button_t key) {
+	return aasi_game_post_tagged_key(this, key, 0);
+}
+
+bool aasi_game_post_tagged_key(aasi_game_t *this, aasi_button_t key, uint32_t tag) {
+	if (key < 0 || key >= _AASI_GAME_KEYS) {
+		return false;
+	}
+	return aasi_input_post_tagged(&this->input, key, tag);
+}
+
+bool aasi_game_pop_applied_key(aasi_game_t *this, uint32_t *tag, unsigned long *tick) {
+	if (this->applied_tail == this->applied_head) {
+		return false;
+	}
+	const unsigned int pos = this->applied_tail++ & (_AASI_GAME_APPLIED_SIZE - 1);
+	*tag = this->applied[pos].tag;
+	*tick = this->applied[pos].tick;
+	return true;
+}
+
+unsigned int aasi_game_get_dropped_keys(const aasi_game_t *this) {
+	return aasi_input_dropped(&this->input);
+}
+
+// Posted events are applied in order, one each. Held keys repeat in the button driver, which
+// posts every repeat like a press.
+static void _aasi_game_input_task(aasi_game_t *this) {
+	int key;
+	uint32_t tag;
+	while (aasi_input_pop(&this->input, &key, &tag)) {
+		aasi_game_handle_key(this, key);
+		if (tag) {
+			// the oldest tags are overwritten if nobody pops them
+			if (this->applied_head - this->applied_tail == _AASI_GAME_APPLIED_SIZE) {
+				this->applied_tail++;
+			}
+			const unsigned int pos = this->applied_head++ & (_AASI_GAME_APPLIED_SIZE - 1);
+			this->applied[pos].tag = tag;
+			this->applied[pos].tick = this->ticks;
+		}
 	}
 }
 
@@ -175,28 +484,117 @@ aasi_screen_obj_t* _aasi_game_find_hit_obj(aasi_game_t *this, aasi_bomb_t *bomb)
 	return NULL;
 }
 
+// Objects outside of the viewport are only simulated every few ticks.
+static bool _aasi_game_is_obj_due(const aasi_game_t *this, const aasi_screen_obj_t *so) {
+	const unsigned long divider = CONFIG_AASI_OFFSCREEN_TASK_DIVIDER * aasi_gov_far_divider(&this->gov);
+	return this->ticks % divider == 0 || aasi_screen_obj_is_in_view(so);
+}
+
+static void _aasi_game_flush_deferred(aasi_game_t *this) {
+	_aasi_screen_obj_flush((aasi_screen_obj_t*)this->hero);
+	aasi_so_list_t *const lists[] = { &this->aliens, &this->blocks, &this->bombs };
+	for (size_t l = 0; l < sizeof(lists) / sizeof(*lists); ++l) {
+		AASI_SO_LIST_FOR_EACH(lists[l], so) {
+			_aasi_screen_obj_flush(so);
+		}
+	}
+}
+
+void aasi_game_get_cells(const aasi_game_t *this, char *cells) {
+	const int width = aasi_display_width(this->disp);
+	memset(cells, ' ', width * aasi_display_height(this->disp));
+	if (this->hero) {
+		_aasi_screen_obj_put_cells((aasi_screen_obj_t*)this->hero, cells, width);
+	}
+	const aasi_so_list_t *const lists[] = { &this->aliens, &this->blocks, &this->bombs };
+	for (size_t l = 0; l < sizeof(lists) / sizeof(*lists); ++l) {
+		AASI_SO_LIST_FOR_EACH(lists[l], so) {
+			_aasi_screen_obj_put_cells(so, cells, width);
+		}
+	}
+}
+
 static void _aasi_game_aliens_task(aasi_game_t *this) {
 	AASI_SO_LIST_FOR_EACH(&this->aliens, alien) {
-		aasi_screen_obj_task(alien);
+		if (_aasi_game_is_obj_due(this, alien)) {
+			_aasi_game_target_task(this, alien);
+		}
 	}
 }
 
 static void _aasi_game_blocks_task(aasi_game_t *this) {
 	AASI_SO_LIST_FOR_EACH(&this->blocks, block) {
-		aasi_screen_obj_task(block);
+		if (_aasi_game_is_obj_due(this, block)) {
+			_aasi_game_target_task(this, block);
+		}
 	}
 }
 
+static bool _aasi_game_is_on_path(const aasi_screen_obj_t *so, int x, int y, int y_dir, int *impact_y) {
+	const int so_y = aasi_screen_obj_get_y(so);
+	const int so_x = aasi_screen_obj_get_x(so);
+	if (x < so_x || x >= so_x + aasi_screen_obj_get_width(so) || (so_y - y) * y_dir < 0) {
+		return false;
+	}
+	if ((so_y - *impact_y) * y_dir < 0) {
+		*impact_y = so_y;
+	}
+	return true;
+}
+
+// Bombs fly straight, so the only row where the bomb can hit anything is the first
+// occupied one on its path, as long as nothing enters or leaves its column.
+static void _aasi_game_predict_impact(aasi_game_t *this, aasi_bomb_t *bomb) {
+	const aasi_screen_obj_t *bomb_so = (const aasi_screen_obj_t*)bomb;
+	const int x = aasi_screen_obj_get_x(bomb_so);
+	const int y = aasi_screen_obj_get_y(bomb_so);
+	const int y_dir = aasi_bomb_get_y_dir(bomb);
+	int impact_y = y_dir > 0 ? this->world_height : -1;
+	this->collision_tests++;
+
+	if (aasi_so_list_find(&this->aliens, (aasi_screen_obj_t*)aasi_bomb_get_source(bomb)) < 0) {
+		AASI_SO_LIST_FOR_EACH(&this->aliens, alien) {
+			_aasi_game_is_on_path(alien, x, y, y_dir, &impact_y);
+		}
+	}
+	AASI_SO_LIST_FOR_EACH(&this->blocks, block) {
+		_aasi_game_is_on_path(block, x, y, y_dir, &impact_y);
+	}
+	_aasi_game_is_on_path((aasi_screen_obj_t*)this->hero, x, y, y_dir, &impact_y);
+	aasi_bomb_set_impact(bomb, impact_y, this->column_gen[x % _AASI_GAME_COLUMN_GENS]);
+}
+
+static aasi_screen_obj_t *_aasi_game_bomb_collision(aasi_game_t *this, aasi_bomb_t *bomb) {
+	if (this->collision_mode == AASI_GAME_COLLISION_PREDICTIVE) {
+		const aasi_screen_obj_t *bomb_so = (const aasi_screen_obj_t*)bomb;
+		const int x = aasi_screen_obj_get_x(bomb_so);
+		if (!aasi_bomb_is_impact_valid(bomb, this->column_gen[x % _AASI_GAME_COLUMN_GENS])) {
+			_aasi_game_predict_impact(this, bomb);
+		}
+		if (aasi_screen_obj_get_y(bomb_so) != aasi_bomb_get_impact_y(bomb)) {
+			return NULL;
+		}
+		aasi_bomb_invalidate_impact(bomb);
+	}
+	this->collision_tests++;
+	return _aasi_game_find_hit_obj(this, bomb);
+}
+
 static void _aasi_game_bombs_task(aasi_game_t *this) {
 	AASI_SO_LIST_FOR_EACH(&this->bombs, bomb_so) {
 		aasi_bomb_t *const bomb = (aasi_bomb_t*)bomb_so;
+		if (!_aasi_game_is_obj_due(this, bomb_so)) {
+			continue;
+		}
 		aasi_screen_obj_task(bomb_so);
 		if (aasi_bomb_is_off_screen(bomb)) {
 			aasi_so_list_erase(&this->bombs, bomb_so);
 			continue;
 		}
 
-		aasi_screen_obj_t *hit_obj = _aasi_game_find_hit_obj(this, bomb);
+		AASI_PROF_BEGIN(t0);
+		aasi_screen_obj_t *hit_obj = _aasi_game_bomb_collision(this, bomb);
+		AASI_PROF_END(&this->prof, AASI_PROF_PHASE_COLLISION, t0);
 		if (hit_obj) {
 			aasi_so_list_erase(&this->bombs, bomb_so);
 			aasi_screen_obj_hit(hit_obj);
@@ -205,19 +603,69 @@ static void _aasi_game_bombs_task(aasi_game_t *this) {
 }
 
 void aasi_game_task(aasi_game_t *this, unsigned long timestamp_ms) {
+	AASI_PROF_BEGIN(t_frame);
 	this->ts_now = timestamp_ms;
+	this->render = aasi_gov_tick(&this->gov, this->ticks);
+	if (this->render) {
+		_aasi_game_flush_deferred(this);
+	}
+	_aasi_game_input_task(this);
+
+	AASI_PROF_BEGIN(t_hero);
 	aasi_hero_task(this->hero);
+	_aasi_game_follow_hero(this);
+	AASI_PROF_END(&this->prof, AASI_PROF_PHASE_HERO, t_hero);
+
+	AASI_PROF_BEGIN(t_aliens);
 	_aasi_game_aliens_task(this);
+	AASI_PROF_END(&this->prof, AASI_PROF_PHASE_ALIENS, t_aliens);
+
+	AASI_PROF_BEGIN(t_blocks);
 	_aasi_game_blocks_task(this);
+	AASI_PROF_END(&this->prof, AASI_PROF_PHASE_BLOCKS, t_blocks);
+
+	AASI_PROF_BEGIN(t_bombs);
 	_aasi_game_bombs_task(this);
+	AASI_PROF_END(&this->prof, AASI_PROF_PHASE_BOMBS, t_bombs);
+
+	if (this->render) {
+		aasi_display_present(this->disp);
+	}
+	this->ticks++;
+	AASI_PROF_END(&this->prof, AASI_PROF_PHASE_FRAME, t_frame);
+#if CONFIG_AASI_PROFILER
+	aasi_prof_periodic_dump(&this->prof, timestamp_ms);
+#endif
+}
+
+bool aasi_game_get_profile(const aasi_game_t *this, aasi_prof_phase_t phase, aasi_prof_stats_t *stats) {
+#if CONFIG_AASI_PROFILER
+	return aasi_prof_get(&this->prof, phase, stats);
+#else
+	return false;
+#endif
+}
+
+void aasi_game_dump_profile(const aasi_game_t *this) {
+#if CONFIG_AASI_PROFILER
+	aasi_prof_dump(&this->prof);
+#endif
 }
 
 void _aasi_game_on_alien_killed(aasi_game_t *this, aasi_alien_t *alien) {
+	_aasi_game_touch_obj(this, (aasi_screen_obj_t*)alien);
+	// the bombs it dropped can hit the other aliens from now on, whichever column they are in
+	AASI_SO_LIST_FOR_EACH(&this->bombs, bomb_so) {
+		if (aasi_bomb_get_source((aasi_bomb_t*)bomb_so) == (aasi_screen_obj_t*)alien) {
+			aasi_bomb_invalidate_impact((aasi_bomb_t*)bomb_so);
+		}
+	}
 	aasi_so_list_erase(&this->aliens, (aasi_screen_obj_t*)alien);
 	aasi_ctxcb_call(&this->on_alien_hit);
 }
 
 void _aasi_game_on_block_destroyed(aasi_game_t *this, aasi_block_t *block) {
+	_aasi_game_touch_obj(this, (aasi_screen_obj_t*)block);
 	aasi_so_list_erase(&this->blocks, (aasi_screen_obj_t*)block);
 	aasi_ctxcb_call(&this->on_block_destroyed);
 }
@@ -240,6 +688,34 @@ void aasi_game_set_random_provider(aasi_game_t *game, aasi_game_random_provider_
 	}
 }
 
+bool _aasi_game_is_render_tick(const aasi_game_t *this) {
+	return this->render;
+}
+
+void aasi_game_report_frame_time(aasi_game_t *this, uint32_t frame_us) {
+	aasi_gov_frame(&this->gov, frame_us);
+}
+
+bool aasi_game_did_render(const aasi_game_t *this) {
+	return this->render;
+}
+
+const aasi_gov_stats_t *aasi_game_get_governor_stats(const aasi_game_t *this) {
+	return aasi_gov_get_stats(&this->gov);
+}
+
+void aasi_game_dump_governor(const aasi_game_t *this) {
+	aasi_gov_print(&this->gov, "aasi governor");
+}
+
+void aasi_game_set_collision_mode(aasi_game_t *this, aasi_game_collision_mode_t mode) {
+	this->collision_mode = mode;
+}
+
+unsigned long aasi_game_get_collision_tests(const aasi_game_t *this) {
+	return this->collision_tests;
+}
+
 unsigned int _aasi_game_rand(const aasi_game_t *game) {
 	return game->random_provider();
 }
\ No newline at end of file
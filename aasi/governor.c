@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <aasi/governor.h>
+
+// Step up quickly once the average is over budget, step down only after it
+// stayed within budget for much longer, so the levels do not oscillate.
+#define AASI_GOV_UP_FRAMES 4
+#define AASI_GOV_DOWN_FRAMES 128
+#define AASI_GOV_AVG_SHIFT 3
+
+static const uint8_t _aasi_gov_render_every[AASI_GOV_LEVEL_COUNT] = { 1, 2, 2, 4 };
+static const uint8_t _aasi_gov_far_divider[AASI_GOV_LEVEL_COUNT] = { 1, 1, 2, 4 };
+
+static const char *const _aasi_gov_level_names[AASI_GOV_LEVEL_COUNT] = {
+	"none", "coalesce", "far", "max",
+};
+
+void aasi_gov_init(aasi_gov_t *this, uint32_t budget_us) {
+	memset(this, 0, sizeof(*this));
+	this->_budget_us = budget_us;
+}
+
+void aasi_gov_frame(aasi_gov_t *this, uint32_t frame_us) {
+	aasi_gov_stats_t *const stats = &this->_stats;
+	if (!this->_budget_us) {
+		return;
+	}
+	stats->frames++;
+	stats->frames_at_level[stats->level]++;
+	if (frame_us > this->_budget_us) {
+		stats->over_budget++;
+	}
+	// exponential moving average, 1/8 weight for the new sample
+	stats->avg_us = stats->avg_us + ((int32_t)(frame_us - stats->avg_us) >> AASI_GOV_AVG_SHIFT);
+
+	if (stats->avg_us > this->_budget_us) {
+		this->_under = 0;
+		if (++this->_over >= AASI_GOV_UP_FRAMES && stats->level < AASI_GOV_LEVEL_MAX) {
+			stats->level++;
+			stats->level_ups++;
+			this->_over = 0;
+		}
+	} else {
+		this->_over = 0;
+		if (++this->_under >= AASI_GOV_DOWN_FRAMES && stats->level > AASI_GOV_LEVEL_NONE) {
+			stats->level--;
+			stats->level_downs++;
+			this->_under = 0;
+		}
+	}
+}
+
+// Returns whether the tick should render, counting the ones that do not.
+bool aasi_gov_tick(aasi_gov_t *this, unsigned long tick) {
+	if (tick % _aasi_gov_render_every[this->_stats.level] == 0) {
+		return true;
+	}
+	this->_stats.skipped_renders++;
+	return false;
+}
+
+int aasi_gov_far_divider(const aasi_gov_t *this) {
+	return _aasi_gov_far_divider[this->_stats.level];
+}
+
+const aasi_gov_stats_t *aasi_gov_get_stats(const aasi_gov_t *this) {
+	return &this->_stats;
+}
+
+void aasi_gov_print(const aasi_gov_t *this, const char *name) {
+	const aasi_gov_stats_t *const stats = &this->_stats;
+	printf("%s: budget=%uus avg=%uus level=%s frames=%lu over=%lu skipped=%lu up=%lu down=%lu\n", name,
+	       (unsigned)this->_budget_us, (unsigned)stats->avg_us, _aasi_gov_level_names[stats->level],
+	       stats->frames, stats->over_budget, stats->skipped_renders, stats->level_ups, stats->level_downs);
+	for (int i = 0; i < AASI_GOV_LEVEL_COUNT; ++i) {
+		printf("  %-8s %lu\n", _aasi_gov_level_names[i], stats->frames_at_level[i]);
+	}
+}
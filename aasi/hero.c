@@ -1,15 +1,19 @@
 #include <stdlib.h>
 
 #include <aasi/display.h>
+#include <aasi/game.h>
 #include "screen_obj.h"
 #include "hero.h"
 #include "ooc.h"
+#include "so_pool.h"
 
 struct _aasi_hero_t {
 	aasi_screen_obj_t so;
 	bool alive;
 };
 
+_Static_assert(sizeof(aasi_hero_t) <= AASI_SO_POOL_SLOT_SIZE, "hero does not fit a pool slot");
+
 //static void _aasi_hero_task(aasi_screen_obj_t *base);
 static void _aasi_hero_hit(aasi_screen_obj_t *base);
 
@@ -30,7 +34,7 @@ static bool _aasi_hero_init(aasi_hero_t *this, struct _aasi_game_t *game) {
 }
 
 aasi_hero_t *aasi_hero_new(struct _aasi_game_t *game) {
-	return NEW_INIT(aasi_hero_t, _aasi_hero_init, game);
+	return GAME_NEW_INIT(game, aasi_hero_t, _aasi_hero_init, game);
 }
 
 bool aasi_hero_is_alive(const aasi_hero_t *this) {
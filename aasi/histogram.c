@@ -0,0 +1,59 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <aasi/histogram.h>
+
+void aasi_hist_init(aasi_hist_t *this, uint8_t shift) {
+	memset(this, 0, sizeof(*this));
+	this->shift = shift;
+}
+
+uint32_t aasi_hist_mean(const aasi_hist_t *this) {
+	return this->count ? (uint32_t)(this->sum / this->count) : 0;
+}
+
+// Upper bound of the bucket holding the pct-th percentile, or max for the last one.
+uint32_t aasi_hist_percentile(const aasi_hist_t *this, unsigned int pct) {
+	if (!this->count) {
+		return 0;
+	}
+	const uint64_t rank = ((uint64_t)this->count * pct + 99) / 100;
+	uint64_t seen = 0;
+	for (int i = 0; i < AASI_HIST_BUCKETS - 1; ++i) {
+		seen += this->bucket[i];
+		if (seen >= rank) {
+			const uint32_t upper = ((uint32_t)(i + 1) << this->shift) - 1;
+			return upper < this->max ? upper : this->max;
+		}
+	}
+	return this->max;
+}
+
+// Number of samples in buckets that lie entirely above value.
+uint32_t aasi_hist_count_above(const aasi_hist_t *this, uint32_t value) {
+	uint32_t n = 0;
+	for (int i = AASI_HIST_BUCKETS - 1; i >= 0; --i) {
+		if (((uint32_t)i << this->shift) <= value) {
+			break;
+		}
+		n += this->bucket[i];
+	}
+	return n;
+}
+
+void aasi_hist_print(const aasi_hist_t *this, const char *name) {
+	printf("%s: n=%u mean=%u p50<=%u p99<=%u max=%u\n", name,
+	       (unsigned)this->count, (unsigned)aasi_hist_mean(this),
+	       (unsigned)aasi_hist_percentile(this, 50),
+	       (unsigned)aasi_hist_percentile(this, 99),
+	       (unsigned)this->max);
+	for (int i = 0; i < AASI_HIST_BUCKETS; ++i) {
+		if (this->bucket[i]) {
+			printf("  [%6u..%6u%s] %u\n",
+			       (unsigned)((uint32_t)i << this->shift),
+			       (unsigned)(((uint32_t)(i + 1) << this->shift) - 1),
+			       i == AASI_HIST_BUCKETS - 1 ? "+" : "",
+			       (unsigned)this->bucket[i]);
+		}
+	}
+}
@@ -0,0 +1,25 @@
+#ifndef _AASI_BOT_H_
+#define _AASI_BOT_H_
+
+#include <aasi/game.h>
+
+struct _aasi_bot_t;
+typedef struct _aasi_bot_t aasi_bot_t;
+
+typedef struct _aasi_bot_config_t {
+	int rollouts;			// random rollouts per candidate move
+	int depth;				// decisions simulated in each rollout
+	unsigned long step_ms;	// game time between two decisions
+	unsigned long tick_ms;	// game time advanced by one simulated aasi_game_task
+	unsigned int seed;
+} aasi_bot_config_t;
+
+void aasi_bot_default_config(aasi_bot_config_t *cfg);
+aasi_bot_t *aasi_bot_new(const aasi_bot_config_t *cfg);
+void aasi_bot_delete(aasi_bot_t *this);
+// Picks AASI_GAME_KEY_LEFT, _RIGHT, _FIRE or _NOT_MAPPED (wait) for the current state.
+aasi_button_t aasi_bot_choose(aasi_bot_t *this, const aasi_game_t *game);
+unsigned long aasi_bot_get_rollouts(const aasi_bot_t *this);
+unsigned long aasi_bot_get_ticks(const aasi_bot_t *this);
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef _AASI_CONFIG_H_
+#define _AASI_CONFIG_H_
+
+// On ESP-IDF the options come from Kconfig.projbuild, on hosts pass them with -D.
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+#ifndef CONFIG_AASI_PROFILER
+#define CONFIG_AASI_PROFILER 0
+#endif
+
+#ifndef CONFIG_AASI_PROFILER_WINDOW
+#define CONFIG_AASI_PROFILER_WINDOW 64
+#endif
+
+#ifndef CONFIG_AASI_PROFILER_DUMP_INTERVAL_MS
+#define CONFIG_AASI_PROFILER_DUMP_INTERVAL_MS 0
+#endif
+
+#ifndef CONFIG_AASI_DISPLAY_STATIC
+#define CONFIG_AASI_DISPLAY_STATIC 0
+#endif
+
+#ifndef CONFIG_AASI_OFFSCREEN_TASK_DIVIDER
+#define CONFIG_AASI_OFFSCREEN_TASK_DIVIDER 4
+#endif
+
+#ifndef CONFIG_AASI_FRAME_BUDGET_US
+#define CONFIG_AASI_FRAME_BUDGET_US 5000
+#endif
+
+#ifndef CONFIG_AASI_SPECTATOR
+#define CONFIG_AASI_SPECTATOR 0
+#endif
+
+#ifndef CONFIG_AASI_SPECTATOR_INTERVAL_MS
+#define CONFIG_AASI_SPECTATOR_INTERVAL_MS 100
+#endif
+
+#ifndef CONFIG_AASI_SPECTATOR_KEYFRAME_MS
+#define CONFIG_AASI_SPECTATOR_KEYFRAME_MS 2000
+#endif
+
+#ifndef CONFIG_AASI_SPECTATOR_BACKLOG
+#define CONFIG_AASI_SPECTATOR_BACKLOG 2048
+#endif
+
+#ifndef CONFIG_AASI_REMOTE
+#define CONFIG_AASI_REMOTE 0
+#endif
+
+#ifndef CONFIG_AASI_LATENCY_TRACE
+#define CONFIG_AASI_LATENCY_TRACE 0
+#endif
+
+#endif
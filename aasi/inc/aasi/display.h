@@ -2,9 +2,11 @@
 #define _AASI_DISPLAY_H_
 
 #include <stdbool.h>
+#include <aasi/config.h>
 
 struct _aasi_display_t;
 typedef struct _aasi_display_t aasi_display_t;
+struct _aasi_prof_t;
 
 typedef struct _aasi_display_ops_t {
 	void (*start)(aasi_display_t *this);
@@ -12,6 +14,10 @@ typedef struct _aasi_display_ops_t {
 	void (*mvclr)(aasi_display_t *this, void **obj, int y, int x, const char *s);
 	void (*mvputs)(aasi_display_t *this, void **obj, int y, int x, const char *s);
 	void (*objdel)(aasi_display_t *this, void **obj);
+	// deletes every object drawn so far at once
+	void (*clear)(aasi_display_t *this);
+	// called once the objects of a rendered frame are all drawn
+	void (*present)(aasi_display_t *this);
 } aasi_display_ops_t;
 
 struct _aasi_display_t {
@@ -19,15 +25,34 @@ struct _aasi_display_t {
 	const aasi_display_ops_t *_ops;
 	int _width;
 	int _height;
+#if CONFIG_AASI_PROFILER
+	struct _aasi_prof_t *_prof;
+#endif
 };
 
 bool aasi_display_init(aasi_display_t *this, const aasi_display_ops_t *ops, int width, int height);
+bool aasi_display_init_headless(aasi_display_t *this, int width, int height);
 void aasi_display_destroy(aasi_display_t *this);
 void aasi_display_start(aasi_display_t *this);
 void aasi_display_mvclr(aasi_display_t *this, void **obj, int y, int x, const char *s);
 void aasi_display_mvputs(aasi_display_t *this, void **obj, int y, int x, const char *s);
 void aasi_display_objdel(aasi_display_t *this, void **obj);
+bool aasi_display_clear(aasi_display_t *this);
+void aasi_display_present(aasi_display_t *this);
 int aasi_display_width(const aasi_display_t *this);
 int aasi_display_height(const aasi_display_t *this);
 
+#if CONFIG_AASI_DISPLAY_STATIC
+// Implemented by the single display backend of the build, the ops table then only
+// tells a real display from a headless one and whether it clears.
+void aasi_display_backend_mvclr(aasi_display_t *this, void **obj, int y, int x, const char *s);
+void aasi_display_backend_mvputs(aasi_display_t *this, void **obj, int y, int x, const char *s);
+void aasi_display_backend_objdel(aasi_display_t *this, void **obj);
+void aasi_display_backend_clear(aasi_display_t *this);
+void aasi_display_backend_present(aasi_display_t *this);
+#endif
+
+// protected, for the game only
+void _aasi_display_set_prof(aasi_display_t *this, struct _aasi_prof_t *prof);
+
 #endif
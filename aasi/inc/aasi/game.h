@@ -2,9 +2,14 @@
 #define _AASI_GAME_H_
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <aasi/ctxcb.h>
+#include <aasi/governor.h>
 
 #define GAME_SPEED_FACTOR 4
+// Key tags with this bit set belong to latency traces, remote controller tags never have it.
+#define AASI_GAME_TAG_TRACE 0x80000000u
 typedef enum
 {
 	AASI_GAME_KEY_NOT_MAPPED = -1,
@@ -30,17 +35,60 @@ typedef enum _aasi_game_winner_t {
 
 typedef unsigned int (*aasi_game_random_provider_t)();
 
+typedef enum _aasi_game_collision_mode_t {
+	AASI_GAME_COLLISION_PREDICTIVE = 0,	// bombs only test for hits on their predicted impact row
+	AASI_GAME_COLLISION_SCAN,			// bombs test every object on every tick
+} aasi_game_collision_mode_t;
+
 aasi_game_t* aasi_game_new(struct _aasi_display_t *disp, int num_aliens, int num_blocks);
+aasi_game_t* aasi_game_new_with_random_provider(struct _aasi_display_t *disp, int num_aliens, int num_blocks,
+                                                aasi_game_random_provider_t rnd);
+// The world may be larger than the display, the display then shows a viewport that follows the hero.
+aasi_game_t* aasi_game_new_in_world(struct _aasi_display_t *disp, int world_width, int world_height,
+                                    int num_aliens, int num_blocks, aasi_game_random_provider_t rnd);
+size_t aasi_game_arena_size(void);
+// Creates the game in caller owned memory of aasi_game_arena_size() bytes, aasi_game_delete() does not free it.
+aasi_game_t* aasi_game_new_in_arena(void *arena, size_t size, struct _aasi_display_t *disp,
+                                    int world_width, int world_height,
+                                    int num_aliens, int num_blocks, aasi_game_random_provider_t rnd);
+aasi_game_t* aasi_game_new_clone(const aasi_game_t *src);
+void aasi_game_copy(aasi_game_t *dst, const aasi_game_t *src);
 bool aasi_game_is_running(const aasi_game_t *this);
 void aasi_game_task(aasi_game_t *this, unsigned long timestamp_ms);
 void aasi_game_delete(aasi_game_t *this);
 void aasi_game_handle_key(aasi_game_t *this, aasi_button_t key);
+// Safe from any task or ISR, the key is applied at the start of the next aasi_game_task().
+bool aasi_game_post_key(aasi_game_t *this, aasi_button_t key);
+// Like aasi_game_post_key(), a tag other than 0 is reported by aasi_game_pop_applied_key().
+bool aasi_game_post_tagged_key(aasi_game_t *this, aasi_button_t key, uint32_t tag);
+// Returns tagged keys in the order they were applied, with the tick they were applied on.
+// Call it from the task that runs aasi_game_task().
+bool aasi_game_pop_applied_key(aasi_game_t *this, uint32_t *tag, unsigned long *tick);
+unsigned int aasi_game_get_dropped_keys(const aasi_game_t *this);
 aasi_game_winner_t aasi_game_get_winner(const aasi_game_t *this);
 unsigned long aasi_game_get_duration_ms(const aasi_game_t *this);
+int aasi_game_get_world_width(const aasi_game_t *this);
+int aasi_game_get_world_height(const aasi_game_t *this);
+int aasi_game_get_view_x(const aasi_game_t *this);
+int aasi_game_get_view_y(const aasi_game_t *this);
+int aasi_game_get_alien_count(const aasi_game_t *this);
+int aasi_game_get_block_count(const aasi_game_t *this);
 void aasi_game_on_alien_hit(aasi_game_t *this, aasi_ctxcb_cb_t cb, void *priv);
 void aasi_game_on_block_destroyed(aasi_game_t *this, aasi_ctxcb_cb_t cb, void *priv);
 void aasi_game_on_hero_fire(aasi_game_t *this, aasi_ctxcb_cb_t cb, void *priv);
 void aasi_game_set_random_provider(aasi_game_t *this, aasi_game_random_provider_t rnd);
+void aasi_game_set_collision_mode(aasi_game_t *this, aasi_game_collision_mode_t mode);
+// Number of times bombs were tested against all objects, including impact predictions.
+unsigned long aasi_game_get_collision_tests(const aasi_game_t *this);
+// Wall time the work of the last loop iteration took, without the wait for the
+// next tick, feeds the frame budget governor.
+void aasi_game_report_frame_time(aasi_game_t *this, uint32_t frame_us);
+// True if the last aasi_game_task() drew its changes to the display.
+bool aasi_game_did_render(const aasi_game_t *this);
+// Fills display width * height cells, row by row, with what the display shows.
+void aasi_game_get_cells(const aasi_game_t *this, char *cells);
+const aasi_gov_stats_t *aasi_game_get_governor_stats(const aasi_game_t *this);
+void aasi_game_dump_governor(const aasi_game_t *this);
 
 // protected, for screen_obj_t based objects only
 struct _aasi_alien_t;
@@ -50,6 +98,11 @@ void _aasi_game_on_alien_killed(aasi_game_t *this, struct _aasi_alien_t *alien);
 void _aasi_game_on_block_destroyed(aasi_game_t *this, struct _aasi_block_t *alien);
 void _aasi_game_bomb_new(aasi_game_t *this, struct _aasi_screen_obj_t *source, int y_dir);
 struct _aasi_display_t *_aasi_game_get_display(aasi_game_t *this);
+bool _aasi_game_is_render_tick(const aasi_game_t *this);
 unsigned int _aasi_game_rand(const aasi_game_t *game);
+void *_aasi_game_obj_alloc(aasi_game_t *this);
+void _aasi_game_obj_free(aasi_game_t *this, void *obj);
+const struct _aasi_screen_obj_t *_aasi_game_get_hero_obj(const aasi_game_t *this);
+const struct _aasi_screen_obj_t *_aasi_game_get_alien_obj(const aasi_game_t *this, int pos);
 
 #endif
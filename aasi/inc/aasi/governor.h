@@ -0,0 +1,44 @@
+#ifndef _AASI_GOVERNOR_H_
+#define _AASI_GOVERNOR_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum _aasi_gov_level_t {
+	AASI_GOV_LEVEL_NONE = 0,	// render every frame
+	AASI_GOV_LEVEL_COALESCE,	// render every other frame, moves in between are coalesced
+	AASI_GOV_LEVEL_FAR,			// as above, objects outside the viewport updated half as often
+	AASI_GOV_LEVEL_MAX,			// render every fourth frame, far objects a quarter as often
+	AASI_GOV_LEVEL_COUNT,
+} aasi_gov_level_t;
+
+typedef struct _aasi_gov_stats_t {
+	aasi_gov_level_t level;
+	uint32_t avg_us;			// smoothed frame time
+	unsigned long frames;
+	unsigned long over_budget;	// frames that took longer than the budget
+	unsigned long skipped_renders;
+	unsigned long level_ups;
+	unsigned long level_downs;
+	unsigned long frames_at_level[AASI_GOV_LEVEL_COUNT];
+} aasi_gov_stats_t;
+
+// Trades render rate and far object update rate for keeping the frame time within
+// a budget. The loop reports how long each frame really took, the game asks it
+// what to skip.
+typedef struct _aasi_gov_t {
+	// private:
+	uint32_t _budget_us;
+	int _over;
+	int _under;
+	aasi_gov_stats_t _stats;
+} aasi_gov_t;
+
+void aasi_gov_init(aasi_gov_t *this, uint32_t budget_us);
+void aasi_gov_frame(aasi_gov_t *this, uint32_t frame_us);
+bool aasi_gov_tick(aasi_gov_t *this, unsigned long tick);
+int aasi_gov_far_divider(const aasi_gov_t *this);
+const aasi_gov_stats_t *aasi_gov_get_stats(const aasi_gov_t *this);
+void aasi_gov_print(const aasi_gov_t *this, const char *name);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef _AASI_HISTOGRAM_H_
+#define _AASI_HISTOGRAM_H_
+
+#include <stdint.h>
+
+#define AASI_HIST_BUCKETS 32
+
+// Fixed-width buckets of (1 << shift) units, the last bucket also takes
+// everything above the range. Adding a sample is a shift and an increment.
+typedef struct _aasi_hist_t {
+	uint32_t bucket[AASI_HIST_BUCKETS];
+	uint32_t count;
+	uint32_t max;
+	uint64_t sum;
+	uint8_t shift;
+} aasi_hist_t;
+
+void aasi_hist_init(aasi_hist_t *this, uint8_t shift);
+uint32_t aasi_hist_mean(const aasi_hist_t *this);
+uint32_t aasi_hist_percentile(const aasi_hist_t *this, unsigned int pct);
+uint32_t aasi_hist_count_above(const aasi_hist_t *this, uint32_t value);
+void aasi_hist_print(const aasi_hist_t *this, const char *name);
+
+static inline void aasi_hist_add(aasi_hist_t *this, uint32_t value) {
+	uint32_t idx = value >> this->shift;
+	if (idx >= AASI_HIST_BUCKETS) {
+		idx = AASI_HIST_BUCKETS - 1;
+	}
+	this->bucket[idx]++;
+	this->count++;
+	this->sum += value;
+	if (value > this->max) {
+		this->max = value;
+	}
+}
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef _AASI_LATENCY_H_
+#define _AASI_LATENCY_H_
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <aasi/histogram.h>
+
+// Input to photon latency: a traced press is stamped when the button is read, when it is
+// taken off the input queue, when the game applies it, when the game draws the tick and
+// when the display flushes the frame containing that draw. The first four stamps come from
+// the game task, the flush from the display task, each trace is handed over once drawn.
+
+// Must be a power of two.
+#define AASI_LAT_TRACES 8
+
+typedef enum _aasi_lat_stage_t {
+	AASI_LAT_STAGE_QUEUE,	// press to taken off the input queue
+	AASI_LAT_STAGE_APPLY,	// taken to applied by a game tick
+	AASI_LAT_STAGE_DRAW,	// applied to drawn by a rendering tick
+	AASI_LAT_STAGE_FLUSH,	// drawn to flushed to the panel
+	AASI_LAT_STAGE_TOTAL,	// press to flushed
+	AASI_LAT_STAGE_COUNT
+} aasi_lat_stage_t;
+
+typedef struct _aasi_lat_trace_t {
+	// private:
+	atomic_uint _state;
+	uint32_t _tag;
+	int64_t _press_us;
+	int64_t _stage_us;		// time of the last stage
+} aasi_lat_trace_t;
+
+typedef struct _aasi_lat_t {
+	// private:
+	aasi_lat_trace_t _traces[AASI_LAT_TRACES];
+	uint32_t _seq;
+	unsigned long _untraced;	// presses while all traces were in flight
+	aasi_hist_t _hist[AASI_LAT_STAGE_COUNT];
+} aasi_lat_t;
+
+// Histograms have buckets of (1 << shift) us.
+void aasi_lat_init(aasi_lat_t *this, uint8_t shift);
+// Game task side. Returns the tag to post the key with, 0 if the press is not traced.
+uint32_t aasi_lat_begin(aasi_lat_t *this, int64_t press_us, int64_t now_us);
+// The key was not posted after all.
+void aasi_lat_cancel(aasi_lat_t *this, uint32_t tag);
+// Returns false if the tag is not a trace of this tracer.
+bool aasi_lat_applied(aasi_lat_t *this, uint32_t tag, int64_t now_us);
+// A tick rendered, all applied presses are drawn.
+void aasi_lat_drawn(aasi_lat_t *this, int64_t now_us);
+// Drops the traces not drawn yet, the game they were posted to is gone.
+void aasi_lat_abort(aasi_lat_t *this);
+// Display task side, call it once the last area of a frame is flushed.
+void aasi_lat_flushed(aasi_lat_t *this, int64_t now_us);
+const aasi_hist_t *aasi_lat_get_hist(const aasi_lat_t *this, aasi_lat_stage_t stage);
+void aasi_lat_print(const aasi_lat_t *this, const char *name);
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef _AASI_PROFILER_H_
+#define _AASI_PROFILER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Phases are inclusive: display calls made by an object are also counted in
+// the phase that moved it, collision search is also counted in the bombs phase.
+typedef enum _aasi_prof_phase_t {
+	AASI_PROF_PHASE_FRAME = 0,		// whole aasi_game_task
+	AASI_PROF_PHASE_HERO,
+	AASI_PROF_PHASE_ALIENS,
+	AASI_PROF_PHASE_BLOCKS,
+	AASI_PROF_PHASE_BOMBS,
+	AASI_PROF_PHASE_COLLISION,		// one hit object search
+	AASI_PROF_PHASE_DISPLAY_MVPUTS,
+	AASI_PROF_PHASE_DISPLAY_MVCLR,
+	AASI_PROF_PHASE_DISPLAY_OBJDEL,
+	AASI_PROF_PHASE_DISPLAY_PRESENT,
+	AASI_PROF_PHASE_COUNT,
+} aasi_prof_phase_t;
+
+// Durations are in profiler ticks: CPU cycles on device, nanoseconds on host.
+typedef struct _aasi_prof_stats_t {
+	unsigned long total;	// samples recorded since the game started
+	unsigned int window;	// samples the statistics below are computed from
+	uint32_t min;
+	uint32_t mean;
+	uint32_t p99;
+	uint32_t max;
+} aasi_prof_stats_t;
+
+struct _aasi_game_t;
+
+bool aasi_game_get_profile(const struct _aasi_game_t *this, aasi_prof_phase_t phase, aasi_prof_stats_t *stats);
+void aasi_game_dump_profile(const struct _aasi_game_t *this);
+const char *aasi_prof_phase_name(aasi_prof_phase_t phase);
+unsigned long aasi_prof_ticks_to_us(uint32_t ticks);
+
+#endif
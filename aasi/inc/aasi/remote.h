@@ -0,0 +1,64 @@
+#ifndef _AASI_REMOTE_H_
+#define _AASI_REMOTE_H_
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <aasi/game.h>
+
+// Remote controller: key events received as "<id> <timestamp> <button>" text, button being
+// an index into the map given at init, are posted to the game like physical button presses.
+// Each event is acknowledged with "<id> <timestamp> <tick>", tick being the game tick the key
+// was applied on, or -1 if it was not (no game running, unknown button, full mailbox). The
+// timestamp is only echoed, so senders can measure round trips on their own clock.
+
+// Must be a power of two, larger than the input mailbox.
+#define AASI_REMOTE_PENDING 32
+#define AASI_REMOTE_MSG_MAX 48
+
+// Returns false if the acknowledgement could not be sent.
+typedef bool (*aasi_remote_ack_t)(void *priv, const char *msg, size_t len);
+
+typedef struct _aasi_remote_stats_t {
+	unsigned long received;
+	unsigned long applied;
+	unsigned long rejected;		// acknowledged with tick -1
+	unsigned long malformed;	// not acknowledged at all
+	unsigned long aborted;		// still in the mailbox when the game ended, acknowledged with tick -1
+} aasi_remote_stats_t;
+
+// Written by the receiving task and read by the game task. The tag doubles as the sequence
+// of a seqlock: it is 0 while id and ts change and once the event was acknowledged.
+typedef struct _aasi_remote_pending_t {
+	atomic_uint tag;
+	atomic_uint id;
+	_Atomic unsigned long long ts;
+} aasi_remote_pending_t;
+
+typedef struct _aasi_remote_t {
+	// private:
+	const aasi_button_t *_map;
+	int _map_len;
+	aasi_remote_ack_t _ack;
+	void *_priv;
+	uint32_t _tag;
+	aasi_remote_pending_t _pending[AASI_REMOTE_PENDING];
+	aasi_remote_stats_t _stats;
+} aasi_remote_t;
+
+bool aasi_remote_init(aasi_remote_t *this, const aasi_button_t *map, int map_len,
+                      aasi_remote_ack_t ack, void *priv);
+// Called by the one task receiving the events, game is NULL while no game runs.
+void aasi_remote_on_event(aasi_remote_t *this, aasi_game_t *game, const uint8_t *data, size_t len);
+// Acknowledges the applied events, call it after every aasi_game_task().
+void aasi_remote_task(aasi_remote_t *this, aasi_game_t *game);
+// For loops that pop the applied keys themselves, returns false if the tag is not a remote one.
+bool aasi_remote_on_applied(aasi_remote_t *this, uint32_t tag, unsigned long tick);
+// Acknowledges the events never applied with tick -1. Call it from the game task once the game
+// ended and no aasi_remote_on_event() can post to it anymore.
+void aasi_remote_abort(aasi_remote_t *this);
+const aasi_remote_stats_t *aasi_remote_get_stats(const aasi_remote_t *this);
+void aasi_remote_print(const aasi_remote_t *this, const char *name);
+
+#endif
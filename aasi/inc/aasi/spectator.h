@@ -0,0 +1,90 @@
+#ifndef _AASI_SPECTATOR_H_
+#define _AASI_SPECTATOR_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <aasi/game.h>
+
+// Spectator stream: the cells a game shows, sent as a keyframe followed by diffs against
+// the previously sent frame.
+//
+// Every packet is a header of version, flags, little endian sequence number, width and
+// height, followed by runs of varint skipped cells, varint run length and the character
+// the run is set to. Keyframes apply to a blank grid, diffs to the grid of the previous
+// sequence number, a receiver that missed one waits for the next keyframe.
+
+#define AASI_SPEC_VERSION 1
+#define AASI_SPEC_FLAG_KEYFRAME 0x01
+#define AASI_SPEC_HEADER_SIZE 6
+#define AASI_SPEC_CELLS_MAX 2048
+#define AASI_SPEC_PACKET_MAX 1024
+
+// Returns false if the packet could not be queued.
+typedef bool (*aasi_spec_publish_t)(void *priv, const uint8_t *data, size_t len);
+// Returns the bytes still waiting to be sent by the transport.
+typedef int (*aasi_spec_backlog_t)(void *priv);
+
+typedef struct _aasi_spec_config_t {
+	unsigned long interval_ms;	// shortest time between two packets
+	unsigned long keyframe_ms;	// longest time between two keyframes
+	int backlog_max;			// packets are held back while the backlog is larger
+} aasi_spec_config_t;
+
+typedef struct _aasi_spec_stats_t {
+	unsigned long keyframes;
+	unsigned long diffs;
+	unsigned long bytes;
+	unsigned long held_back;	// ticks a due packet waited for the backlog to drain
+	unsigned long failed;		// packets the transport did not take
+} aasi_spec_stats_t;
+
+typedef struct _aasi_spec_t {
+	// private:
+	aasi_spec_config_t _cfg;
+	aasi_spec_publish_t _publish;
+	aasi_spec_backlog_t _backlog;
+	void *_priv;
+	int _width;
+	int _height;
+	bool _need_key;
+	uint16_t _seq;
+	unsigned long _ts_sent;
+	unsigned long _ts_key;
+	char _sent[AASI_SPEC_CELLS_MAX];	// the cells receivers have
+	char _cells[AASI_SPEC_CELLS_MAX];
+	uint8_t _packet[AASI_SPEC_PACKET_MAX];
+	aasi_spec_stats_t _stats;
+} aasi_spec_t;
+
+// Receiver side of the stream.
+typedef struct _aasi_spec_view_t {
+	int width;
+	int height;
+	bool synced;		// has a keyframe and every diff since
+	uint16_t seq;
+	unsigned long lost;	// packets that could not be applied
+	char cells[AASI_SPEC_CELLS_MAX];
+} aasi_spec_view_t;
+
+void aasi_spec_default_config(aasi_spec_config_t *cfg);
+// backlog may be NULL if the transport has no queue to watch.
+bool aasi_spec_init(aasi_spec_t *this, const aasi_spec_config_t *cfg, int width, int height,
+                    aasi_spec_publish_t publish, aasi_spec_backlog_t backlog, void *priv);
+// The next frame is sent as a keyframe, call it when a new game starts.
+void aasi_spec_restart(aasi_spec_t *this);
+// Sends the cells the game shows if it is time to, returns true if a packet was queued.
+bool aasi_spec_frame(aasi_spec_t *this, const aasi_game_t *game, unsigned long ts_ms);
+const aasi_spec_stats_t *aasi_spec_get_stats(const aasi_spec_t *this);
+void aasi_spec_print(const aasi_spec_t *this, const char *name);
+
+// Encodes cells as a keyframe, or as a diff against prev. Returns the packet length,
+// 0 if it does not fit into size bytes.
+size_t aasi_spec_encode(const char *prev, const char *cells, int width, int height,
+                        uint16_t seq, bool keyframe, uint8_t *out, size_t size);
+
+void aasi_spec_view_init(aasi_spec_view_t *this);
+// Returns true if the packet was applied and cells show the new frame.
+bool aasi_spec_view_apply(aasi_spec_view_t *this, const uint8_t *data, size_t len);
+
+#endif
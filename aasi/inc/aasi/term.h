@@ -0,0 +1,62 @@
+#ifndef _AASI_TERM_H_
+#define _AASI_TERM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <aasi/display.h>
+
+// ANSI terminal display backend of the host tools, the firmware does not build it.
+// Objects are kept in a slot table, every present composes them into a cell grid
+// and writes only the escape sequences and characters that turn the previous
+// frame into the new one.
+
+#define AASI_TERM_SLOTS 32
+#define AASI_TERM_TEXT_MAX 16
+#define AASI_TERM_OUT_SIZE 1024
+
+typedef void (*aasi_term_write_t)(void *priv, const char *buf, size_t len);
+
+typedef struct _aasi_term_stats_t {
+	unsigned long frames;		// presents
+	unsigned long idle_frames;	// presents that changed nothing
+	unsigned long bytes;		// bytes written by presents
+	unsigned long cells;		// cells changed by presents
+	unsigned long dropped;		// draws lost to a full slot table
+	unsigned int last_bytes;
+	unsigned int max_bytes;
+} aasi_term_stats_t;
+
+typedef struct _aasi_term_slot_t {
+	// private:
+	bool _used;
+	short _y;
+	short _x;
+	char _text[AASI_TERM_TEXT_MAX + 1];
+} aasi_term_slot_t;
+
+typedef struct _aasi_term_t {
+	aasi_display_t base;
+	// private:
+	aasi_term_write_t _write;
+	void *_priv;
+	int _cur_y;		// -1 if the cursor position is unknown
+	int _cur_x;
+	char *_front;	// what the terminal shows
+	char *_back;	// what the next present should show
+	aasi_term_slot_t _slots[AASI_TERM_SLOTS];
+	char _out[AASI_TERM_OUT_SIZE];
+	size_t _out_len;
+	aasi_term_stats_t _stats;
+} aasi_term_t;
+
+// With a NULL write callback nothing is written, only the byte counts are kept.
+aasi_term_t *aasi_term_new(int width, int height, aasi_term_write_t write, void *priv);
+void aasi_term_delete(aasi_term_t *this);
+aasi_display_t *aasi_term_display(aasi_term_t *this);
+// Presents a row major grid of width * height cells instead of the drawn objects.
+void aasi_term_show_cells(aasi_term_t *this, const char *cells);
+const aasi_term_stats_t *aasi_term_get_stats(const aasi_term_t *this);
+void aasi_term_reset_stats(aasi_term_t *this);
+void aasi_term_print(const aasi_term_t *this, const char *name);
+
+#endif
@@ -0,0 +1,67 @@
+#include "input.h"
+
+_Static_assert((AASI_INPUT_RING_SIZE & (AASI_INPUT_RING_SIZE - 1)) == 0, "ring size must be a power of two");
+
+// Each slot carries a sequence number: pos while free for the producer that
+// reserves pos, pos + 1 once the key is published for the consumer.
+
+void aasi_input_init(aasi_input_t *this) {
+	atomic_init(&this->_head, 0);
+	atomic_init(&this->_posted, 0);
+	atomic_init(&this->_dropped, 0);
+	this->_tail = 0;
+	for (unsigned int i = 0; i < AASI_INPUT_RING_SIZE; ++i) {
+		atomic_init(&this->_ring[i]._seq, i);
+		this->_ring[i]._key = -1;
+		this->_ring[i]._tag = 0;
+	}
+}
+
+bool aasi_input_post(aasi_input_t *this, int key) {
+	return aasi_input_post_tagged(this, key, 0);
+}
+
+bool aasi_input_post_tagged(aasi_input_t *this, int key, uint32_t tag) {
+	unsigned int pos = atomic_load_explicit(&this->_head, memory_order_relaxed);
+	aasi_input_slot_t *slot;
+	for (;;) {
+		slot = &this->_ring[pos & (AASI_INPUT_RING_SIZE - 1)];
+		const int diff = (int)(atomic_load_explicit(&slot->_seq, memory_order_acquire) - pos);
+		if (diff == 0) {
+			if (atomic_compare_exchange_weak_explicit(&this->_head, &pos, pos + 1,
+			                                          memory_order_relaxed, memory_order_relaxed)) {
+				break;
+			}
+		} else if (diff < 0) {
+			atomic_fetch_add_explicit(&this->_dropped, 1, memory_order_relaxed);
+			return false;
+		} else {
+			pos = atomic_load_explicit(&this->_head, memory_order_relaxed);
+		}
+	}
+	slot->_key = key;
+	slot->_tag = tag;
+	atomic_store_explicit(&slot->_seq, pos + 1, memory_order_release);
+	atomic_fetch_add_explicit(&this->_posted, 1, memory_order_relaxed);
+	return true;
+}
+
+bool aasi_input_pop(aasi_input_t *this, int *key, uint32_t *tag) {
+	aasi_input_slot_t *slot = &this->_ring[this->_tail & (AASI_INPUT_RING_SIZE - 1)];
+	if (atomic_load_explicit(&slot->_seq, memory_order_acquire) != this->_tail + 1) {
+		return false;
+	}
+	*key = slot->_key;
+	*tag = slot->_tag;
+	atomic_store_explicit(&slot->_seq, this->_tail + AASI_INPUT_RING_SIZE, memory_order_release);
+	this->_tail++;
+	return true;
+}
+
+unsigned int aasi_input_posted(const aasi_input_t *this) {
+	return atomic_load_explicit(&((aasi_input_t*)this)->_posted, memory_order_relaxed);
+}
+
+unsigned int aasi_input_dropped(const aasi_input_t *this) {
+	return atomic_load_explicit(&((aasi_input_t*)this)->_dropped, memory_order_relaxed);
+}
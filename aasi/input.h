@@ -0,0 +1,37 @@
+#ifndef _AASI_INPUT_H_
+#define _AASI_INPUT_H_
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Must be a power of two.
+#define AASI_INPUT_RING_SIZE 16
+
+typedef struct _aasi_input_slot_t {
+	atomic_uint _seq;
+	int _key;
+	uint32_t _tag;
+} aasi_input_slot_t;
+
+// Lock-free mailbox between any number of producers (tasks or ISRs) and the
+// game task: a bounded ring of discrete key events.
+typedef struct _aasi_input_t {
+	// private:
+	atomic_uint _head;
+	unsigned int _tail;			// consumer only
+	atomic_uint _posted;
+	atomic_uint _dropped;
+	aasi_input_slot_t _ring[AASI_INPUT_RING_SIZE];
+} aasi_input_t;
+
+void aasi_input_init(aasi_input_t *this);
+bool aasi_input_post(aasi_input_t *this, int key);
+// The tag is handed back by aasi_input_pop(), untagged keys have tag 0.
+bool aasi_input_post_tagged(aasi_input_t *this, int key, uint32_t tag);
+// consumer side
+bool aasi_input_pop(aasi_input_t *this, int *key, uint32_t *tag);
+unsigned int aasi_input_posted(const aasi_input_t *this);
+unsigned int aasi_input_dropped(const aasi_input_t *this);
+
+#endif
@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <aasi/latency.h>
+#include <aasi/game.h>
+
+_Static_assert((AASI_LAT_TRACES & (AASI_LAT_TRACES - 1)) == 0, "trace count must be a power of two");
+
+// A trace belongs to the game task until it is drawn, then to the display task until flushed.
+enum {
+	_AASI_LAT_FREE = 0,
+	_AASI_LAT_QUEUED,
+	_AASI_LAT_APPLIED,
+	_AASI_LAT_DRAWN,
+};
+
+static const char *const _aasi_lat_stage_names[AASI_LAT_STAGE_COUNT] = {
+	[AASI_LAT_STAGE_QUEUE] = "queue",
+	[AASI_LAT_STAGE_APPLY] = "apply",
+	[AASI_LAT_STAGE_DRAW]  = "draw",
+	[AASI_LAT_STAGE_FLUSH] = "flush",
+	[AASI_LAT_STAGE_TOTAL] = "total",
+};
+
+static uint32_t _aasi_lat_delta(int64_t from_us, int64_t to_us) {
+	return to_us > from_us ? (uint32_t)(to_us - from_us) : 0;
+}
+
+static unsigned int _aasi_lat_state(aasi_lat_trace_t *trace) {
+	return atomic_load_explicit(&trace->_state, memory_order_acquire);
+}
+
+static void _aasi_lat_set_state(aasi_lat_trace_t *trace, unsigned int state) {
+	atomic_store_explicit(&trace->_state, state, memory_order_release);
+}
+
+void aasi_lat_init(aasi_lat_t *this, uint8_t shift) {
+	memset(this, 0, sizeof(aasi_lat_t));
+	for (int i = 0; i < AASI_LAT_TRACES; ++i) {
+		atomic_init(&this->_traces[i]._state, _AASI_LAT_FREE);
+	}
+	for (int i = 0; i < AASI_LAT_STAGE_COUNT; ++i) {
+		aasi_hist_init(&this->_hist[i], shift);
+	}
+}
+
+uint32_t aasi_lat_begin(aasi_lat_t *this, int64_t press_us, int64_t now_us) {
+	for (int i = 0; i < AASI_LAT_TRACES; ++i) {
+		aasi_lat_trace_t *const trace = &this->_traces[i];
+		if (_aasi_lat_state(trace) != _AASI_LAT_FREE) {
+			continue;
+		}
+		// the index in the low bits finds the trace again, the sequence tells reuses apart
+		trace->_tag = AASI_GAME_TAG_TRACE | ((++this->_seq * AASI_LAT_TRACES + i) & ~AASI_GAME_TAG_TRACE);
+		trace->_press_us = press_us;
+		trace->_stage_us = now_us;
+		aasi_hist_add(&this->_hist[AASI_LAT_STAGE_QUEUE], _aasi_lat_delta(press_us, now_us));
+		_aasi_lat_set_state(trace, _AASI_LAT_QUEUED);
+		return trace->_tag;
+	}
+	this->_untraced++;
+	return 0;
+}
+
+void aasi_lat_cancel(aasi_lat_t *this, uint32_t tag) {
+	aasi_lat_trace_t *const trace = &this->_traces[tag & (AASI_LAT_TRACES - 1)];
+	if (tag && trace->_tag == tag && _aasi_lat_state(trace) == _AASI_LAT_QUEUED) {
+		_aasi_lat_set_state(trace, _AASI_LAT_FREE);
+	}
+}
+
+bool aasi_lat_applied(aasi_lat_t *this, uint32_t tag, int64_t now_us) {
+	aasi_lat_trace_t *const trace = &this->_traces[tag & (AASI_LAT_TRACES - 1)];
+	if (!(tag & AASI_GAME_TAG_TRACE) || trace->_tag != tag || _aasi_lat_state(trace) != _AASI_LAT_QUEUED) {
+		return false;
+	}
+	aasi_hist_add(&this->_hist[AASI_LAT_STAGE_APPLY], _aasi_lat_delta(trace->_stage_us, now_us));
+	trace->_stage_us = now_us;
+	_aasi_lat_set_state(trace, _AASI_LAT_APPLIED);
+	return true;
+}
+
+void aasi_lat_drawn(aasi_lat_t *this, int64_t now_us) {
+	for (int i = 0; i < AASI_LAT_TRACES; ++i) {
+		aasi_lat_trace_t *const trace = &this->_traces[i];
+		if (_aasi_lat_state(trace) != _AASI_LAT_APPLIED) {
+			continue;
+		}
+		aasi_hist_add(&this->_hist[AASI_LAT_STAGE_DRAW], _aasi_lat_delta(trace->_stage_us, now_us));
+		trace->_stage_us = now_us;
+		// hands the trace over to the display task
+		_aasi_lat_set_state(trace, _AASI_LAT_DRAWN);
+	}
+}
+
+void aasi_lat_abort(aasi_lat_t *this) {
+	for (int i = 0; i < AASI_LAT_TRACES; ++i) {
+		aasi_lat_trace_t *const trace = &this->_traces[i];
+		const unsigned int state = _aasi_lat_state(trace);
+		if (state == _AASI_LAT_QUEUED || state == _AASI_LAT_APPLIED) {
+			_aasi_lat_set_state(trace, _AASI_LAT_FREE);
+		}
+	}
+}
+
+void aasi_lat_flushed(aasi_lat_t *this, int64_t now_us) {
+	for (int i = 0; i < AASI_LAT_TRACES; ++i) {
+		aasi_lat_trace_t *const trace = &this->_traces[i];
+		if (_aasi_lat_state(trace) != _AASI_LAT_DRAWN) {
+			continue;
+		}
+		aasi_hist_add(&this->_hist[AASI_LAT_STAGE_FLUSH], _aasi_lat_delta(trace->_stage_us, now_us));
+		aasi_hist_add(&this->_hist[AASI_LAT_STAGE_TOTAL], _aasi_lat_delta(trace->_press_us, now_us));
+		_aasi_lat_set_state(trace, _AASI_LAT_FREE);
+	}
+}
+
+const aasi_hist_t *aasi_lat_get_hist(const aasi_lat_t *this, aasi_lat_stage_t stage) {
+	if (stage < 0 || stage >= AASI_LAT_STAGE_COUNT) {
+		return NULL;
+	}
+	return &this->_hist[stage];
+}
+
+void aasi_lat_print(const aasi_lat_t *this, const char *name) {
+	printf("%s [us]: untraced=%lu\n", name, this->_untraced);
+	for (int i = 0; i < AASI_LAT_STAGE_COUNT; ++i) {
+		const aasi_hist_t *const hist = &this->_hist[i];
+		printf("  %-6s n=%u mean=%u p50<=%u p99<=%u max=%u\n", _aasi_lat_stage_names[i], hist->count,
+		       aasi_hist_mean(hist), aasi_hist_percentile(hist, 50), aasi_hist_percentile(hist, 99), hist->max);
+	}
+}
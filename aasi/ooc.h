@@ -15,4 +15,14 @@
 	this; \
 })
 
+// Screen objects live in the pool of the game that owns them, not on the heap.
+#define GAME_NEW_INIT(game, T, initf, ...) ({ \
+	T *this = (T*)_aasi_game_obj_alloc(game); \
+	if (this && !initf(this, __VA_ARGS__)) { \
+		_aasi_game_obj_free(game, this); \
+		this = NULL; \
+	} \
+	this; \
+})
+
 #endif
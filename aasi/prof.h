@@ -0,0 +1,39 @@
+#ifndef _AASI_PROF_H_
+#define _AASI_PROF_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <aasi/config.h>
+#include <aasi/profiler.h>
+
+typedef struct _aasi_prof_window_t {
+	uint32_t samples[CONFIG_AASI_PROFILER_WINDOW];
+	uint64_t sum;
+	unsigned long total;
+	int pos;
+	int size;
+} aasi_prof_window_t;
+
+typedef struct _aasi_prof_t {
+	aasi_prof_window_t phase[AASI_PROF_PHASE_COUNT];
+	unsigned long ts_dump;
+} aasi_prof_t;
+
+void aasi_prof_init(aasi_prof_t *this);
+uint32_t aasi_prof_now(void);
+void aasi_prof_record(aasi_prof_t *this, aasi_prof_phase_t phase, uint32_t ticks);
+bool aasi_prof_get(const aasi_prof_t *this, aasi_prof_phase_t phase, aasi_prof_stats_t *stats);
+void aasi_prof_dump(const aasi_prof_t *this);
+void aasi_prof_periodic_dump(aasi_prof_t *this, unsigned long ts_ms);
+
+// Instrumentation compiles to nothing unless CONFIG_AASI_PROFILER is set.
+#if CONFIG_AASI_PROFILER
+#define AASI_PROF_BEGIN(t0) const uint32_t t0 = aasi_prof_now()
+#define AASI_PROF_END(prof, phase, t0) aasi_prof_record((prof), (phase), aasi_prof_now() - (t0))
+#else
+#define AASI_PROF_BEGIN(t0)
+#define AASI_PROF_END(prof, phase, t0) do {} while (0)
+#endif
+
+#endif
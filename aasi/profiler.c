@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "prof.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_cpu.h"
+#else
+#include <time.h>
+#endif
+
+static const char *const _aasi_prof_phase_names[AASI_PROF_PHASE_COUNT] = {
+	[AASI_PROF_PHASE_FRAME]          = "frame",
+	[AASI_PROF_PHASE_HERO]           = "hero",
+	[AASI_PROF_PHASE_ALIENS]         = "aliens",
+	[AASI_PROF_PHASE_BLOCKS]         = "blocks",
+	[AASI_PROF_PHASE_BOMBS]          = "bombs",
+	[AASI_PROF_PHASE_COLLISION]      = "collision",
+	[AASI_PROF_PHASE_DISPLAY_MVPUTS] = "mvputs",
+	[AASI_PROF_PHASE_DISPLAY_MVCLR]  = "mvclr",
+	[AASI_PROF_PHASE_DISPLAY_OBJDEL] = "objdel",
+	[AASI_PROF_PHASE_DISPLAY_PRESENT] = "present",
+};
+
+void aasi_prof_init(aasi_prof_t *this) {
+	memset(this, 0, sizeof(*this));
+}
+
+uint32_t aasi_prof_now(void) {
+#ifdef ESP_PLATFORM
+	return esp_cpu_get_ccount();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+#endif
+}
+
+unsigned long aasi_prof_ticks_to_us(uint32_t ticks) {
+#ifdef ESP_PLATFORM
+	return ticks / CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ;
+#else
+	return ticks / 1000;
+#endif
+}
+
+const char *aasi_prof_phase_name(aasi_prof_phase_t phase) {
+	if (phase < 0 || phase >= AASI_PROF_PHASE_COUNT) {
+		return "?";
+	}
+	return _aasi_prof_phase_names[phase];
+}
+
+void aasi_prof_record(aasi_prof_t *this, aasi_prof_phase_t phase, uint32_t ticks) {
+	if (!this || phase < 0 || phase >= AASI_PROF_PHASE_COUNT) {
+		return;
+	}
+	aasi_prof_window_t *const w = &this->phase[phase];
+	if (w->size == CONFIG_AASI_PROFILER_WINDOW) {
+		w->sum -= w->samples[w->pos];
+	} else {
+		w->size++;
+	}
+	w->samples[w->pos] = ticks;
+	w->sum += ticks;
+	w->pos = (w->pos + 1) % CONFIG_AASI_PROFILER_WINDOW;
+	w->total++;
+}
+
+static int _aasi_prof_cmp(const void *a, const void *b) {
+	const uint32_t x = *(const uint32_t*)a;
+	const uint32_t y = *(const uint32_t*)b;
+	return (x > y) - (x < y);
+}
+
+bool aasi_prof_get(const aasi_prof_t *this, aasi_prof_phase_t phase, aasi_prof_stats_t *stats) {
+	if (!this || !stats || phase < 0 || phase >= AASI_PROF_PHASE_COUNT) {
+		return false;
+	}
+	const aasi_prof_window_t *const w = &this->phase[phase];
+	memset(stats, 0, sizeof(*stats));
+	stats->total = w->total;
+	stats->window = w->size;
+	if (!w->size) {
+		return true;
+	}
+
+	// queries are rare, sorting a copy of the window keeps recording O(1)
+	uint32_t sorted[CONFIG_AASI_PROFILER_WINDOW];
+	memcpy(sorted, w->samples, w->size * sizeof(*sorted));
+	qsort(sorted, w->size, sizeof(*sorted), _aasi_prof_cmp);
+	stats->min = sorted[0];
+	stats->max = sorted[w->size - 1];
+	stats->p99 = sorted[(w->size * 99 - 1) / 100];
+	stats->mean = (uint32_t)(w->sum / w->size);
+	return true;
+}
+
+void aasi_prof_dump(const aasi_prof_t *this) {
+	printf("aasi profile [us]    min   mean    p99    max  samples\n");
+	for (int phase = 0; phase < AASI_PROF_PHASE_COUNT; ++phase) {
+		aasi_prof_stats_t st;
+		if (!aasi_prof_get(this, phase, &st) || !st.total) {
+			continue;
+		}
+		printf("  %-14s %6lu %6lu %6lu %6lu %8lu\n",
+		       aasi_prof_phase_name(phase),
+		       aasi_prof_ticks_to_us(st.min),
+		       aasi_prof_ticks_to_us(st.mean),
+		       aasi_prof_ticks_to_us(st.p99),
+		       aasi_prof_ticks_to_us(st.max),
+		       st.total);
+	}
+}
+
+void aasi_prof_periodic_dump(aasi_prof_t *this, unsigned long ts_ms) {
+#if CONFIG_AASI_PROFILER_DUMP_INTERVAL_MS > 0
+	if (ts_ms - this->ts_dump >= (unsigned long)CONFIG_AASI_PROFILER_DUMP_INTERVAL_MS) {
+		this->ts_dump = ts_ms;
+		aasi_prof_dump(this);
+	}
+#endif
+}
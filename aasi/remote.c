@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <aasi/remote.h>
+
+_Static_assert((AASI_REMOTE_PENDING & (AASI_REMOTE_PENDING - 1)) == 0, "pending size must be a power of two");
+
+static void _aasi_remote_ack(aasi_remote_t *this, uint32_t id, unsigned long long ts, long tick) {
+	char msg[AASI_REMOTE_MSG_MAX];
+	const int len = snprintf(msg, sizeof(msg), "%u %llu %ld", (unsigned)id, ts, tick);
+	this->_ack(this->_priv, msg, len);
+}
+
+bool aasi_remote_init(aasi_remote_t *this, const aasi_button_t *map, int map_len,
+                      aasi_remote_ack_t ack, void *priv) {
+	if (!this || !map || map_len < 1 || !ack) {
+		return false;
+	}
+	memset(this, 0, sizeof(aasi_remote_t));
+	this->_map = map;
+	this->_map_len = map_len;
+	this->_ack = ack;
+	this->_priv = priv;
+	return true;
+}
+
+void aasi_remote_on_event(aasi_remote_t *this, aasi_game_t *game, const uint8_t *data, size_t len) {
+	char msg[AASI_REMOTE_MSG_MAX];
+	unsigned int id;
+	unsigned long long ts;
+	int button;
+
+	this->_stats.received++;
+	if (len >= sizeof(msg)) {
+		this->_stats.malformed++;
+		return;
+	}
+	memcpy(msg, data, len);
+	msg[len] = '\0';
+	if (sscanf(msg, "%u %llu %d", &id, &ts, &button) != 3) {
+		this->_stats.malformed++;
+		return;
+	}
+
+	const aasi_button_t key = button >= 0 && button < this->_map_len ? this->_map[button] : AASI_GAME_KEY_NOT_MAPPED;
+	if (!game || key == AASI_GAME_KEY_NOT_MAPPED) {
+		this->_stats.rejected++;
+		_aasi_remote_ack(this, id, ts, -1);
+		return;
+	}
+	this->_tag = (this->_tag + 1) & ~AASI_GAME_TAG_TRACE;
+	if (this->_tag == 0) {
+		this->_tag = 1;
+	}
+	aasi_remote_pending_t *const pending = &this->_pending[this->_tag & (AASI_REMOTE_PENDING - 1)];
+	atomic_store_explicit(&pending->tag, 0, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	atomic_store_explicit(&pending->id, id, memory_order_relaxed);
+	atomic_store_explicit(&pending->ts, ts, memory_order_relaxed);
+	atomic_store_explicit(&pending->tag, this->_tag, memory_order_release);
+	if (!aasi_game_post_tagged_key(game, key, this->_tag)) {
+		atomic_store_explicit(&pending->tag, 0, memory_order_relaxed);
+		this->_stats.rejected++;
+		_aasi_remote_ack(this, id, ts, -1);
+	}
+}
+
+void aasi_remote_task(aasi_remote_t *this, aasi_game_t *game) {
+	uint32_t tag;
+	unsigned long tick;
+	while (aasi_game_pop_applied_key(game, &tag, &tick)) {
+		aasi_remote_on_applied(this, tag, tick);
+	}
+}
+
+// Copies a slot that still holds the given tag, false if it was acknowledged or reused meanwhile.
+static bool _aasi_remote_read(aasi_remote_pending_t *pending, uint32_t tag, uint32_t *id, unsigned long long *ts) {
+	if (atomic_load_explicit(&pending->tag, memory_order_acquire) != tag) {
+		return false;
+	}
+	*id = atomic_load_explicit(&pending->id, memory_order_relaxed);
+	*ts = atomic_load_explicit(&pending->ts, memory_order_relaxed);
+	atomic_thread_fence(memory_order_acquire);
+	unsigned int expected = tag;
+	// clearing it also keeps aasi_remote_abort() from acknowledging it a second time
+	return atomic_compare_exchange_strong_explicit(&pending->tag, &expected, 0,
+	                                               memory_order_relaxed, memory_order_relaxed);
+}
+
+bool aasi_remote_on_applied(aasi_remote_t *this, uint32_t tag, unsigned long tick) {
+	uint32_t id;
+	unsigned long long ts;
+	if (tag & AASI_GAME_TAG_TRACE || tag == 0 ||
+	    !_aasi_remote_read(&this->_pending[tag & (AASI_REMOTE_PENDING - 1)], tag, &id, &ts)) {
+		return false;
+	}
+	this->_stats.applied++;
+	_aasi_remote_ack(this, id, ts, tick);
+	return true;
+}
+
+void aasi_remote_abort(aasi_remote_t *this) {
+	uint32_t id;
+	unsigned long long ts;
+	for (int i = 0; i < AASI_REMOTE_PENDING; ++i) {
+		aasi_remote_pending_t *const pending = &this->_pending[i];
+		const uint32_t tag = atomic_load_explicit(&pending->tag, memory_order_acquire);
+		if (tag != 0 && _aasi_remote_read(pending, tag, &id, &ts)) {
+			this->_stats.aborted++;
+			_aasi_remote_ack(this, id, ts, -1);
+		}
+	}
+}
+
+const aasi_remote_stats_t *aasi_remote_get_stats(const aasi_remote_t *this) {
+	return &this->_stats;
+}
+
+void aasi_remote_print(const aasi_remote_t *this, const char *name) {
+	const aasi_remote_stats_t *const stats = &this->_stats;
+	printf("%s: received=%lu applied=%lu rejected=%lu aborted=%lu malformed=%lu\n", name,
+	       stats->received, stats->applied, stats->rejected, stats->aborted, stats->malformed);
+}
@@ -1,10 +1,10 @@
-#include <stdlib.h>
 #include <string.h>
 
 #include <aasi/display.h>
 #include <aasi/game.h>
 #include "screen_obj.h"
 
+static const char _aasi_screen_obj_spaces[] = "                ";
 
 static size_t _aasi_screen_obj_get_shape_width(const aasi_screen_obj_t *this) {
 	return strlen(this->_shape);
@@ -17,26 +17,20 @@ bool _aasi_screen_obj_init(aasi_screen_obj_t *this, const aasi_screen_obj_ops_t
 	this->_disp = _aasi_game_get_display(game);
 	this->_shape = shape;
 	this->_init_draw = true;
+	this->_dirty = false;
+	this->_visible = false;
 
 	if (y < 0) {
-		y += aasi_display_height(this->_disp);
+		y += aasi_game_get_world_height(game);
 	}
 	this->_y = y;
 
 	if (x < 0) {
-		x += aasi_display_width(this->_disp);
+		x += aasi_game_get_world_width(game);
 	}
 	this->_x = x;
 
-	size_t shape_width = _aasi_screen_obj_get_shape_width(this);
-	char *spaces = (char*)malloc(shape_width + 1);
-	if (!spaces) {
-		return false;
-	}
-	memset(spaces, ' ', shape_width);
-	spaces[shape_width] = 0;
-	this->_spaces = spaces;
-	return true;
+	return _aasi_screen_obj_get_shape_width(this) < sizeof(_aasi_screen_obj_spaces);
 }
 
 
@@ -45,8 +39,7 @@ void aasi_screen_obj_delete(aasi_screen_obj_t *this) {
 		this->_ops->destroy(this);
 	}
 	aasi_display_objdel(this->_disp, &this->priv);
-	free((char*)this->_spaces);
-	free(this);
+	_aasi_game_obj_free(this->_game, this);
 }
 
 void aasi_screen_obj_hit(aasi_screen_obj_t *this) {
@@ -55,8 +48,77 @@ void aasi_screen_obj_hit(aasi_screen_obj_t *this) {
 	}
 }
 
+static void _aasi_screen_obj_hide(aasi_screen_obj_t *this) {
+	_aasi_screen_obj_clear(this);
+	aasi_display_objdel(this->_disp, &this->priv);
+	this->_visible = false;
+}
+
+// Objects are drawn in viewport coordinates and clipped to it, objects outside
+// of the viewport make no display calls at all.
 void _aasi_screen_obj_draw(aasi_screen_obj_t *this) {
-	aasi_display_mvputs(this->_disp, &this->priv, this->_y, this->_x, this->_shape);
+	if (!_aasi_game_is_render_tick(this->_game)) {
+		this->_dirty = true;
+		return;
+	}
+	this->_dirty = false;
+
+	const int view_y = aasi_game_get_view_y(this->_game);
+	const int view_x = aasi_game_get_view_x(this->_game);
+	const int disp_y = this->_y - view_y;
+	int disp_x = this->_x - view_x;
+	int skip = 0;
+	int width = _aasi_screen_obj_get_shape_width(this);
+	if (disp_x < 0) {
+		skip = -disp_x;
+		disp_x = 0;
+	}
+	if (disp_x + width - skip > aasi_display_width(this->_disp)) {
+		width = aasi_display_width(this->_disp) - disp_x + skip;
+	}
+	if (disp_y < 0 || disp_y >= aasi_display_height(this->_disp) || width - skip <= 0) {
+		if (this->_visible) {
+			_aasi_screen_obj_hide(this);
+		}
+		return;
+	}
+
+	const char *text = this->_shape + skip;
+	char clipped[sizeof(_aasi_screen_obj_spaces)];
+	if (text[width - skip] != '\0') {
+		memcpy(clipped, text, width - skip);
+		clipped[width - skip] = '\0';
+		text = clipped;
+	}
+	aasi_display_mvputs(this->_disp, &this->priv, disp_y, disp_x, text);
+	this->_visible = true;
+	this->_disp_y = disp_y;
+	this->_disp_x = disp_x;
+	this->_disp_w = width - skip;
+	this->_disp_skip = skip;
+}
+
+void _aasi_screen_obj_redraw(aasi_screen_obj_t *this) {
+	if (!this->_init_draw) {
+		if (_aasi_game_is_render_tick(this->_game)) {
+			_aasi_screen_obj_clear(this);
+		}
+		_aasi_screen_obj_draw(this);
+	}
+}
+
+// Draws the latest state of an object whose draws were deferred, however often it moved since.
+void _aasi_screen_obj_flush(aasi_screen_obj_t *this) {
+	if (this->_dirty) {
+		_aasi_screen_obj_redraw(this);
+	}
+}
+
+// Writes what the display shows of the object into a row major cell grid.
+void _aasi_screen_obj_put_cells(const aasi_screen_obj_t *this, char *cells, int width) {
+	if (this->_visible) {
+		memcpy(cells + this->_disp_y * width + this->_disp_x, this->_shape + this->_disp_skip, this->_disp_w);
+	}
 }
 
 void aasi_screen_obj_task(aasi_screen_obj_t *this) {
@@ -71,29 +133,32 @@ void aasi_screen_obj_task(aasi_screen_obj_t *this) {
 }
 
 void _aasi_screen_obj_clear(aasi_screen_obj_t *this) {
-	aasi_display_mvclr(this->_disp, &this->priv, this->_y, this->_x, this->_spaces);
+	if (this->_visible) {
+		const char *spaces = _aasi_screen_obj_spaces + sizeof(_aasi_screen_obj_spaces) - 1 - this->_disp_w;
+		aasi_display_mvclr(this->_disp, &this->priv, this->_disp_y, this->_disp_x, spaces);
+	}
 }
 
 void _aasi_screen_obj_move_absolute(aasi_screen_obj_t *this, int abs_y, int abs_x) {
-	if (!this->_init_draw) {
+	if (!this->_init_draw && _aasi_game_is_render_tick(this->_game)) {
 		_aasi_screen_obj_clear(this);
 	}
 
 	this->_x = abs_x;
 	this->_y = abs_y;
 
-	const int disp_width = aasi_display_width(this->_disp);
+	const int world_width = aasi_game_get_world_width(this->_game);
 	if (this->_x < 0) {
 		this->_x = 0;
-	} else if (this->_x >= disp_width) {
-		this->_x = disp_width-1;
+	} else if (this->_x >= world_width) {
+		this->_x = world_width-1;
 	}
 
-	const int disp_height = aasi_display_height(this->_disp);
+	const int world_height = aasi_game_get_world_height(this->_game);
 	if (this->_y < 0) {
 		this->_y = 0;
-	} else if (this->_y >= disp_height) {
-		this->_y = disp_height-1;
+	} else if (this->_y >= world_height) {
+		this->_y = world_height-1;
 	}
 
 	if (!this->_init_draw) {
@@ -114,11 +179,15 @@ int aasi_screen_obj_get_x(const aasi_screen_obj_t *this) {
 }
 
 int aasi_screen_obj_max_y(const aasi_screen_obj_t *this) {
-	return aasi_display_height(this->_disp);
+	return aasi_game_get_world_height(this->_game);
 }
 
 int aasi_screen_obj_max_x(const aasi_screen_obj_t *this) {
-	return aasi_display_width(this->_disp);
+	return aasi_game_get_world_width(this->_game);
+}
+
+int aasi_screen_obj_get_width(const aasi_screen_obj_t *this) {
+	return _aasi_screen_obj_get_shape_width(this);
 }
 
 int aasi_screen_obj_get_center(const aasi_screen_obj_t *this) {
@@ -132,6 +201,15 @@ bool aasi_screen_obj_is_collision(const aasi_screen_obj_t *this, const aasi_scre
 		(this->_x + _aasi_screen_obj_get_shape_width(this) - 1) >= other->_x;
 }
 
+bool aasi_screen_obj_is_in_view(const aasi_screen_obj_t *this) {
+	const int view_y = aasi_game_get_view_y(this->_game);
+	const int view_x = aasi_game_get_view_x(this->_game);
+	return
+		this->_y >= view_y && this->_y < view_y + aasi_display_height(this->_disp) &&
+		this->_x + (int)_aasi_screen_obj_get_shape_width(this) > view_x &&
+		this->_x < view_x + aasi_display_width(this->_disp);
+}
+
 unsigned long _aasi_screen_obj_millis(const aasi_screen_obj_t *this) {
 	return aasi_game_get_duration_ms(this->_game);
 }
@@ -143,3 +221,12 @@ bool _aasi_screen_obj_is_timeout(const aasi_screen_obj_t *this, unsigned long ts
 unsigned int _aasi_screen_obj_rand(const aasi_screen_obj_t *this) {
 	return _aasi_game_rand(this->_game);
 }
+
+void _aasi_screen_obj_relocate(aasi_screen_obj_t *this, aasi_game_t *game, ptrdiff_t delta) {
+	this->priv = NULL;
+	this->_game = game;
+	this->_disp = _aasi_game_get_display(game);
+	if (this->_ops && this->_ops->relocate) {
+		this->_ops->relocate(this, delta);
+	}
+}
@@ -2,6 +2,7 @@
 #define _AASI_SCREEN_OBJ_H_
 
 #include <stdbool.h>
+#include <stddef.h>
 
 struct _aasi_screen_obj_t;
 typedef struct _aasi_screen_obj_t aasi_screen_obj_t;
@@ -12,6 +13,8 @@ typedef struct _aasi_screen_obj_ops_t {
 	void (*hit)(aasi_screen_obj_t *this);
 	void (*task)(aasi_screen_obj_t *this);
 	void (*destroy)(aasi_screen_obj_t *this);
+	// fix up pointers to other objects after the game was copied by delta bytes
+	void (*relocate)(aasi_screen_obj_t *this, ptrdiff_t delta);
 } aasi_screen_obj_ops_t;
 
 struct _aasi_screen_obj_t {
@@ -25,10 +28,15 @@ struct _aasi_screen_obj_t {
 	const aasi_screen_obj_ops_t *_ops;
 	struct _aasi_display_t *_disp;
 	const char *_shape;
-	const char *_spaces;
 	int _x;
 	int _y;
 	bool _init_draw;
+	bool _dirty;		// a draw was deferred to the next rendered tick
+	bool _visible;		// has a presence on the display
+	short _disp_y;		// where, and how wide, it was last drawn
+	short _disp_x;
+	short _disp_w;
+	short _disp_skip;	// leading shape characters cut off at the left edge
 };
 
 // public:
@@ -39,8 +47,10 @@ int aasi_screen_obj_get_x(const aasi_screen_obj_t *this);
 int aasi_screen_obj_max_y(const aasi_screen_obj_t *this);
 int aasi_screen_obj_max_x(const aasi_screen_obj_t *this);
 int aasi_screen_obj_get_center(const aasi_screen_obj_t *this);
+int aasi_screen_obj_get_width(const aasi_screen_obj_t *this);
 void aasi_screen_obj_hit(aasi_screen_obj_t *this);
 bool aasi_screen_obj_is_collision(const aasi_screen_obj_t *this, const aasi_screen_obj_t *other);
+bool aasi_screen_obj_is_in_view(const aasi_screen_obj_t *this);
 
 // protected:
 bool _aasi_screen_obj_init(aasi_screen_obj_t *this,
@@ -53,8 +63,12 @@ void _aasi_screen_obj_move_absolute(aasi_screen_obj_t *this, int abs_y, int abs_
 void _aasi_screen_obj_move_relative(aasi_screen_obj_t *this, int rel_y, int rel_x);
 void _aasi_screen_obj_draw(aasi_screen_obj_t *this);
 void _aasi_screen_obj_clear(aasi_screen_obj_t *this);
+void _aasi_screen_obj_redraw(aasi_screen_obj_t *this);
+void _aasi_screen_obj_flush(aasi_screen_obj_t *this);
+void _aasi_screen_obj_put_cells(const aasi_screen_obj_t *this, char *cells, int width);
 unsigned long _aasi_screen_obj_millis(const aasi_screen_obj_t *this);
 bool _aasi_screen_obj_is_timeout(const aasi_screen_obj_t *this, unsigned long ts_start, unsigned long interval);
 unsigned int _aasi_screen_obj_rand(const aasi_screen_obj_t *this);
+void _aasi_screen_obj_relocate(aasi_screen_obj_t *this, struct _aasi_game_t *game, ptrdiff_t delta);
 
 #endif
@@ -60,3 +60,13 @@ aasi_screen_obj_t* aasi_so_list_get(const aasi_so_list_t *this, int pos) {
 bool aasi_so_list_empty(const aasi_so_list_t *this) {
 	return this->_size == 0;
 }
+
+int aasi_so_list_size(const aasi_so_list_t *this) {
+	return this->_size;
+}
+
+void aasi_so_list_relocate(aasi_so_list_t *this, ptrdiff_t delta) {
+	for (int i = 0; i < this->_size; ++i) {
+		this->_elem[i] = (aasi_screen_obj_t*)((char*)this->_elem[i] + delta);
+	}
+}
@@ -2,6 +2,7 @@
 #define _AASI_SO_LIST_H_
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #define AASI_SO_LIST_SIZE 5
 #define AASI_SO_LIST_FOR_EACH(lst, elem) \
@@ -25,5 +26,7 @@ bool aasi_so_list_erase(aasi_so_list_t *this, struct _aasi_screen_obj_t *e);
 void aasi_so_list_destroy(aasi_so_list_t *this);
 struct _aasi_screen_obj_t* aasi_so_list_get(const aasi_so_list_t *this, int pos);
 bool aasi_so_list_empty(const aasi_so_list_t *this);
+int aasi_so_list_size(const aasi_so_list_t *this);
+void aasi_so_list_relocate(aasi_so_list_t *this, ptrdiff_t delta);
 
 #endif
@@ -0,0 +1,29 @@
+#include "so_pool.h"
+
+_Static_assert(AASI_SO_POOL_SLOTS <= 32, "pool usage is tracked in a 32 bit mask");
+
+void aasi_so_pool_init(aasi_so_pool_t *this) {
+	this->_used = 0;
+}
+
+void *aasi_so_pool_alloc(aasi_so_pool_t *this) {
+	const uint32_t free_mask = ~this->_used & (uint32_t)((1ULL << AASI_SO_POOL_SLOTS) - 1);
+	if (!free_mask) {
+		return NULL;
+	}
+	const int pos = __builtin_ctz(free_mask);
+	this->_used |= 1UL << pos;
+	return this->_slot[pos]._bytes;
+}
+
+void aasi_so_pool_free(aasi_so_pool_t *this, void *p) {
+	const aasi_so_slot_t *slot = (const aasi_so_slot_t*)p;
+	if (slot < this->_slot || slot >= this->_slot + AASI_SO_POOL_SLOTS) {
+		return;
+	}
+	this->_used &= ~(1UL << (slot - this->_slot));
+}
+
+int aasi_so_pool_used(const aasi_so_pool_t *this) {
+	return __builtin_popcount(this->_used);
+}
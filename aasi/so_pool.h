@@ -0,0 +1,30 @@
+#ifndef _AASI_SO_POOL_H_
+#define _AASI_SO_POOL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Enough for the hero, full alien/block/bomb lists and one object in flight per list.
+#define AASI_SO_POOL_SLOTS 24
+#define AASI_SO_POOL_SLOT_SIZE (16 * sizeof(void*))
+
+typedef union _aasi_so_slot_t {
+	max_align_t _align;
+	unsigned char _bytes[AASI_SO_POOL_SLOT_SIZE];
+} aasi_so_slot_t;
+
+// Fixed storage for all screen objects of one game, so a game is a single
+// block of memory that can be copied with memcpy and relocated.
+typedef struct _aasi_so_pool_t {
+	// private:
+	aasi_so_slot_t _slot[AASI_SO_POOL_SLOTS];
+	uint32_t _used;
+} aasi_so_pool_t;
+
+void aasi_so_pool_init(aasi_so_pool_t *this);
+void *aasi_so_pool_alloc(aasi_so_pool_t *this);
+void aasi_so_pool_free(aasi_so_pool_t *this, void *p);
+int aasi_so_pool_used(const aasi_so_pool_t *this);
+
+#endif
@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <aasi/config.h>
+#include <aasi/display.h>
+#include <aasi/spectator.h>
+
+#define _AASI_SPEC_BLANK ' '
+
+static size_t _aasi_spec_put_varint(uint8_t *out, size_t pos, size_t size, unsigned int v) {
+	do {
+		if (pos >= size) {
+			return 0;
+		}
+		out[pos++] = (v & 0x7f) | (v > 0x7f ? 0x80 : 0);
+		v >>= 7;
+	} while (v);
+	return pos;
+}
+
+static size_t _aasi_spec_get_varint(const uint8_t *data, size_t pos, size_t len, unsigned int *v) {
+	*v = 0;
+	for (int shift = 0; shift < 28; shift += 7) {
+		if (pos >= len) {
+			return 0;
+		}
+		const uint8_t b = data[pos++];
+		*v |= (unsigned int)(b & 0x7f) << shift;
+		if (!(b & 0x80)) {
+			return pos;
+		}
+	}
+	return 0;
+}
+
+void aasi_spec_default_config(aasi_spec_config_t *cfg) {
+	cfg->interval_ms = CONFIG_AASI_SPECTATOR_INTERVAL_MS;
+	cfg->keyframe_ms = CONFIG_AASI_SPECTATOR_KEYFRAME_MS;
+	cfg->backlog_max = CONFIG_AASI_SPECTATOR_BACKLOG;
+}
+
+bool aasi_spec_init(aasi_spec_t *this, const aasi_spec_config_t *cfg, int width, int height,
+                    aasi_spec_publish_t publish, aasi_spec_backlog_t backlog, void *priv) {
+	if (!this || !cfg || !publish || width < 1 || height < 1 || width > 255 || height > 255 ||
+	    width * height > AASI_SPEC_CELLS_MAX) {
+		return false;
+	}
+	memset(this, 0, sizeof(aasi_spec_t));
+	this->_cfg = *cfg;
+	this->_publish = publish;
+	this->_backlog = backlog;
+	this->_priv = priv;
+	this->_width = width;
+	this->_height = height;
+	this->_need_key = true;
+	return true;
+}
+
+void aasi_spec_restart(aasi_spec_t *this) {
+	this->_need_key = true;
+}
+
+bool aasi_spec_frame(aasi_spec_t *this, const aasi_game_t *game, unsigned long ts_ms) {
+	if (!this->_need_key && ts_ms - this->_ts_sent < this->_cfg.interval_ms) {
+		return false;
+	}
+	if (this->_backlog && this->_backlog(this->_priv) > this->_cfg.backlog_max) {
+		// diffs are against what was sent, so the next one catches up on everything held back
+		this->_stats.held_back++;
+		return false;
+	}
+
+	aasi_game_get_cells(game, this->_cells);
+	const size_t cells = this->_width * this->_height;
+	bool keyframe = this->_need_key || ts_ms - this->_ts_key >= this->_cfg.keyframe_ms;
+	if (!keyframe && !memcmp(this->_cells, this->_sent, cells)) {
+		return false;
+	}
+	size_t len = aasi_spec_encode(this->_sent, this->_cells, this->_width, this->_height,
+	                              this->_seq, keyframe, this->_packet, sizeof(this->_packet));
+	if (!len && !keyframe) {
+		keyframe = true;
+		len = aasi_spec_encode(NULL, this->_cells, this->_width, this->_height,
+		                       this->_seq, keyframe, this->_packet, sizeof(this->_packet));
+	}
+	if (!len || !this->_publish(this->_priv, this->_packet, len)) {
+		this->_stats.failed++;
+		return false;
+	}
+
+	memcpy(this->_sent, this->_cells, cells);
+	this->_seq++;
+	this->_ts_sent = ts_ms;
+	if (keyframe) {
+		this->_ts_key = ts_ms;
+		this->_need_key = false;
+		this->_stats.keyframes++;
+	} else {
+		this->_stats.diffs++;
+	}
+	this->_stats.bytes += len;
+	return true;
+}
+
+const aasi_spec_stats_t *aasi_spec_get_stats(const aasi_spec_t *this) {
+	return &this->_stats;
+}
+
+void aasi_spec_print(const aasi_spec_t *this, const char *name) {
+	const aasi_spec_stats_t *const stats = &this->_stats;
+	const unsigned long packets = stats->keyframes + stats->diffs;
+	printf("%s: keyframes=%lu diffs=%lu bytes=%lu (%.1f/packet) held_back=%lu failed=%lu\n", name,
+	       stats->keyframes, stats->diffs, stats->bytes, packets ? (double)stats->bytes / packets : 0.0,
+	       stats->held_back, stats->failed);
+}
+
+size_t aasi_spec_encode(const char *prev, const char *cells, int width, int height,
+                        uint16_t seq, bool keyframe, uint8_t *out, size_t size) {
+	if (size < AASI_SPEC_HEADER_SIZE) {
+		return 0;
+	}
+	out[0] = AASI_SPEC_VERSION;
+	out[1] = keyframe ? AASI_SPEC_FLAG_KEYFRAME : 0;
+	out[2] = seq & 0xff;
+	out[3] = seq >> 8;
+	out[4] = width;
+	out[5] = height;
+
+	size_t pos = AASI_SPEC_HEADER_SIZE;
+	const int count = width * height;
+	int last = 0;	// first cell after the previous run
+	for (int i = 0; i < count; ) {
+		const char base = keyframe ? _AASI_SPEC_BLANK : prev[i];
+		if (cells[i] == base) {
+			++i;
+			continue;
+		}
+		int end = i + 1;
+		while (end < count && cells[end] == cells[i] &&
+		       cells[end] != (keyframe ? _AASI_SPEC_BLANK : prev[end])) {
+			++end;
+		}
+		pos = _aasi_spec_put_varint(out, pos, size, i - last);
+		pos = pos ? _aasi_spec_put_varint(out, pos, size, end - i) : 0;
+		if (!pos || pos >= size) {
+			return 0;
+		}
+		out[pos++] = cells[i];
+		last = i = end;
+	}
+	return pos;
+}
+
+void aasi_spec_view_init(aasi_spec_view_t *this) {
+	memset(this, 0, sizeof(aasi_spec_view_t));
+}
+
+bool aasi_spec_view_apply(aasi_spec_view_t *this, const uint8_t *data, size_t len) {
+	if (len < AASI_SPEC_HEADER_SIZE || data[0] != AASI_SPEC_VERSION) {
+		this->lost++;
+		return false;
+	}
+	const bool keyframe = data[1] & AASI_SPEC_FLAG_KEYFRAME;
+	const uint16_t seq = data[2] | data[3] << 8;
+	const int width = data[4], height = data[5];
+	if (width * height > AASI_SPEC_CELLS_MAX ||
+	    (!keyframe && (!this->synced || seq != (uint16_t)(this->seq + 1) ||
+	                   width != this->width || height != this->height))) {
+		this->synced = false;
+		this->lost++;
+		return false;
+	}
+	if (keyframe) {
+		memset(this->cells, _AASI_SPEC_BLANK, width * height);
+		this->width = width;
+		this->height = height;
+	}
+
+	size_t pos = AASI_SPEC_HEADER_SIZE;
+	int cell = 0;
+	while (pos < len) {
+		unsigned int skip, run;
+		pos = _aasi_spec_get_varint(data, pos, len, &skip);
+		pos = pos ? _aasi_spec_get_varint(data, pos, len, &run) : 0;
+		if (!pos || pos >= len || skip > (unsigned int)(width * height - cell) ||
+		    run > (unsigned int)(width * height - cell) - skip) {
+			this->synced = false;
+			this->lost++;
+			return false;
+		}
+		cell += skip;
+		memset(this->cells + cell, data[pos++], run);
+		cell += run;
+	}
+	this->seq = seq;
+	this->synced = true;
+	return true;
+}
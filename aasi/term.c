@@ -0,0 +1,265 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <aasi/term.h>
+
+#define _AASI_TERM_BLANK ' '
+
+static void _aasi_term_start(aasi_display_t *base);
+static void _aasi_term_destroy(aasi_display_t *base);
+static void _aasi_term_mvputs(aasi_display_t *base, void **obj, int y, int x, const char *s);
+static void _aasi_term_objdel(aasi_display_t *base, void **obj);
+static void _aasi_term_clear(aasi_display_t *base);
+static void _aasi_term_present(aasi_display_t *base);
+static void _aasi_term_diff(aasi_term_t *this);
+
+// Labels are moved by mvputs like on the LVGL display, so there is no mvclr.
+static const aasi_display_ops_t _aasi_term_ops = {
+	.start   = _aasi_term_start,
+	.destroy = _aasi_term_destroy,
+	.mvputs  = _aasi_term_mvputs,
+	.objdel  = _aasi_term_objdel,
+	.clear   = _aasi_term_clear,
+	.present = _aasi_term_present,
+};
+
+aasi_term_t *aasi_term_new(int width, int height, aasi_term_write_t write, void *priv) {
+	aasi_term_t *this = malloc(sizeof(aasi_term_t));
+	if (!this) {
+		return NULL;
+	}
+	memset(this, 0, sizeof(aasi_term_t));
+	if (!aasi_display_init(&this->base, &_aasi_term_ops, width, height)) {
+		free(this);
+		return NULL;
+	}
+	this->_front = malloc(2 * width * height);
+	if (!this->_front) {
+		free(this);
+		return NULL;
+	}
+	this->_back = this->_front + width * height;
+	memset(this->_front, _AASI_TERM_BLANK, 2 * width * height);
+	this->_write = write;
+	this->_priv = priv;
+	this->_cur_y = -1;
+	return this;
+}
+
+void aasi_term_delete(aasi_term_t *this) {
+	if (this) {
+		free(this->_front);
+		free(this);
+	}
+}
+
+aasi_display_t *aasi_term_display(aasi_term_t *this) {
+	return &this->base;
+}
+
+const aasi_term_stats_t *aasi_term_get_stats(const aasi_term_t *this) {
+	return &this->_stats;
+}
+
+void aasi_term_reset_stats(aasi_term_t *this) {
+	memset(&this->_stats, 0, sizeof(this->_stats));
+}
+
+void aasi_term_print(const aasi_term_t *this, const char *name) {
+	const aasi_term_stats_t *const stats = &this->_stats;
+	printf("%s: frames=%lu idle=%lu bytes=%lu (%.1f/frame, max %u) cells=%lu (%.1f/frame) dropped=%lu\n",
+	       name, stats->frames, stats->idle_frames, stats->bytes,
+	       stats->frames ? (double)stats->bytes / stats->frames : 0.0, stats->max_bytes,
+	       stats->cells, stats->frames ? (double)stats->cells / stats->frames : 0.0, stats->dropped);
+}
+
+void aasi_term_show_cells(aasi_term_t *this, const char *cells) {
+	memcpy(this->_back, cells, this->base._width * this->base._height);
+	_aasi_term_diff(this);
+}
+
+// private:
+static void _aasi_term_flush(aasi_term_t *this) {
+	if (this->_write && this->_out_len) {
+		this->_write(this->_priv, this->_out, this->_out_len);
+	}
+	this->_out_len = 0;
+}
+
+static void _aasi_term_emit(aasi_term_t *this, const char *buf, size_t len) {
+	if (this->_out_len + len > sizeof(this->_out)) {
+		_aasi_term_flush(this);
+	}
+	// only a run of cells wider than the buffer is written in pieces
+	while (len > sizeof(this->_out)) {
+		memcpy(this->_out, buf, sizeof(this->_out));
+		this->_out_len = sizeof(this->_out);
+		_aasi_term_flush(this);
+		buf += sizeof(this->_out);
+		len -= sizeof(this->_out);
+	}
+	memcpy(this->_out + this->_out_len, buf, len);
+	this->_out_len += len;
+}
+
+static int _aasi_term_digits(int n) {
+	return n < 10 ? 1 : n < 100 ? 2 : n < 1000 ? 3 : 4;
+}
+
+// Takes the cheapest of an absolute move, a newline, a relative forward move or
+// rewriting the unchanged cells in between, these are the same in both grids.
+// Returns the number of bytes written.
+static int _aasi_term_move(aasi_term_t *this, int y, int x) {
+	char seq[32];
+	int len;
+	if (this->_cur_y == y && this->_cur_x == x) {
+		return 0;
+	}
+	if (this->_cur_y == y && this->_cur_x < x) {
+		const int gap = x - this->_cur_x;
+		if (gap <= 3 + _aasi_term_digits(gap)) {
+			_aasi_term_emit(this, this->_back + y * this->base._width + this->_cur_x, gap);
+			len = gap;
+		} else {
+			len = sprintf(seq, "\033[%dC", gap);
+			_aasi_term_emit(this, seq, len);
+		}
+	} else if (this->_cur_y >= 0 && this->_cur_y + 1 == y && x <= 2) {
+		_aasi_term_emit(this, "\r\n", 2);
+		_aasi_term_emit(this, this->_back + y * this->base._width, x);
+		len = 2 + x;
+	} else {
+		len = sprintf(seq, "\033[%d;%dH", y + 1, x + 1);
+		_aasi_term_emit(this, seq, len);
+	}
+	this->_cur_y = y;
+	this->_cur_x = x;
+	return len;
+}
+
+static void _aasi_term_compose(aasi_term_t *this) {
+	const int width = this->base._width;
+	memset(this->_back, _AASI_TERM_BLANK, width * this->base._height);
+	for (int i = 0; i < AASI_TERM_SLOTS; ++i) {
+		const aasi_term_slot_t *const slot = &this->_slots[i];
+		if (slot->_used) {
+			int len = strlen(slot->_text);
+			if (slot->_x + len > width) {
+				len = width - slot->_x;
+			}
+			memcpy(this->_back + slot->_y * width + slot->_x, slot->_text, len);
+		}
+	}
+}
+
+static void _aasi_term_start(aasi_display_t *base) {
+	aasi_term_t *this = (aasi_term_t*)base;
+	static const char init[] = "\033[?25l\033[H\033[2J";
+	_aasi_term_emit(this, init, sizeof(init) - 1);
+	_aasi_term_flush(this);
+	memset(this->_front, _AASI_TERM_BLANK, base->_width * base->_height);
+	this->_cur_y = 0;
+	this->_cur_x = 0;
+}
+
+// Leaves the cursor below the game and shows it again.
+static void _aasi_term_destroy(aasi_display_t *base) {
+	aasi_term_t *this = (aasi_term_t*)base;
+	char seq[32];
+	const int len = sprintf(seq, "\033[%d;1H\033[?25h", base->_height + 1);
+	_aasi_term_emit(this, seq, len);
+	_aasi_term_flush(this);
+	this->_cur_y = -1;
+}
+
+static void _aasi_term_mvputs(aasi_display_t *base, void **obj, int y, int x, const char *s) {
+	aasi_term_t *this = (aasi_term_t*)base;
+	aasi_term_slot_t *slot = *obj;
+	if (!slot) {
+		for (int i = 0; i < AASI_TERM_SLOTS && !slot; ++i) {
+			if (!this->_slots[i]._used) {
+				slot = &this->_slots[i];
+			}
+		}
+		if (!slot) {
+			this->_stats.dropped++;
+			return;
+		}
+		slot->_used = true;
+		*obj = slot;
+	}
+	if (y < 0 || y >= base->_height || x < 0 || x >= base->_width) {
+		slot->_text[0] = '\0';
+		return;
+	}
+	slot->_y = y;
+	slot->_x = x;
+	strncpy(slot->_text, s, AASI_TERM_TEXT_MAX);
+	slot->_text[AASI_TERM_TEXT_MAX] = '\0';
+}
+
+static void _aasi_term_objdel(aasi_display_t *base, void **obj) {
+	aasi_term_slot_t *slot = *obj;
+	if (slot) {
+		slot->_used = false;
+		*obj = NULL;
+	}
+}
+
+static void _aasi_term_clear(aasi_display_t *base) {
+	aasi_term_t *this = (aasi_term_t*)base;
+	for (int i = 0; i < AASI_TERM_SLOTS; ++i) {
+		this->_slots[i]._used = false;
+	}
+}
+
+// Writes what differs between the back and the front grid.
+static void _aasi_term_diff(aasi_term_t *this) {
+	const int width = this->base._width;
+	unsigned int bytes = 0, cells = 0;
+
+	for (int y = 0; y < this->base._height; ++y) {
+		const char *const back = this->_back + y * width;
+		char *const front = this->_front + y * width;
+		for (int x = 0; x < width; ++x) {
+			if (back[x] == front[x]) {
+				continue;
+			}
+			bytes += _aasi_term_move(this, y, x);
+			// write the whole run of changed cells at once
+			int end = x + 1;
+			while (end < width && back[end] != front[end]) {
+				++end;
+			}
+			_aasi_term_emit(this, back + x, end - x);
+			memcpy(front + x, back + x, end - x);
+			bytes += end - x;
+			cells += end - x;
+			x = end - 1;
+			// the cursor stays in the last column after writing it
+			this->_cur_x = end < width ? end : -1;
+			if (this->_cur_x < 0) {
+				this->_cur_y = -1;
+			}
+		}
+	}
+	_aasi_term_flush(this);
+
+	this->_stats.frames++;
+	this->_stats.bytes += bytes;
+	this->_stats.cells += cells;
+	this->_stats.last_bytes = bytes;
+	if (bytes > this->_stats.max_bytes) {
+		this->_stats.max_bytes = bytes;
+	}
+	if (!cells) {
+		this->_stats.idle_frames++;
+	}
+}
+
+static void _aasi_term_present(aasi_display_t *base) {
+	aasi_term_t *this = (aasi_term_t*)base;
+	_aasi_term_compose(this);
+	_aasi_term_diff(this);
+}
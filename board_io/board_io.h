@@ -0,0 +1,117 @@
+/**
+* @file board_io.h
+
+* @brief Pin level hardware abstraction used by the button and LED drivers. The ESP-IDF backend
+*        drives the ESP32 peripherals, the Linux backend replays scripted waveforms on a virtual
+*        clock so the drivers can run on a workstation.
+
+* @par
+*
+* COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __BOARD_IO_H__
+#define __BOARD_IO_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdint.h>
+#include <stdbool.h>
+//---------------------------------- MACROS -----------------------------------
+#define BOARD_IO_PIN_NUM (40u)
+//-------------------------------- DATA TYPES ---------------------------------
+typedef enum
+{
+    BOARD_IO_ERR_NONE = 0,
+
+    BOARD_IO_ERR_INIT = -1,
+    BOARD_IO_ERR_INVALID_PIN = -2,
+
+} board_io_err_t;
+
+/* Called on every edge of a digital input, from the ISR on hardware */
+typedef void (*board_io_din_edge_cb_t)(void *p_arg);
+//---------------------- PUBLIC FUNCTION PROTOTYPES ---------------------------
+
+/**
+ * @brief It configures the pin as a digital input without pulls and calls the callback on every
+ * edge, if one is given
+ *
+ * @param pin The GPIO pin number.
+ * @param edge_cb The edge callback, NULL for a polled input. It is not debounced.
+ * @param p_arg The argument passed to the callback.
+ *
+ * @return BOARD_IO_ERR_NONE on success.
+ */
+board_io_err_t board_io_din_init(int pin, board_io_din_edge_cb_t edge_cb, void *p_arg);
+
+/**
+ * @brief It returns the level of a digital input. Safe to call from the edge callback.
+ *
+ * @param pin The GPIO pin number.
+ *
+ * @return true if the level is high.
+ */
+bool board_io_din_read(int pin);
+
+/**
+ * @brief It configures the pin as an analog input with the full (0 - 3.3 V) range
+ *
+ * @param pin The GPIO pin number, it has to be on an ADC1 channel.
+ *
+ * @return BOARD_IO_ERR_NONE on success.
+ */
+board_io_err_t board_io_ain_init(int pin);
+
+/**
+ * @brief It takes one conversion of an analog input
+ *
+ * @param pin The GPIO pin number.
+ *
+ * @return The raw 12 bit reading, 0 on error.
+ */
+uint32_t board_io_ain_read_raw(int pin);
+
+/**
+ * @brief It converts a raw reading of the pin to mV with the calibration of its channel
+ *
+ * @param pin The GPIO pin number.
+ * @param raw The raw reading.
+ *
+ * @return The voltage in mV.
+ */
+uint32_t board_io_ain_raw_to_mV(int pin, uint32_t raw);
+
+/**
+ * @brief It configures the pin as a digital output
+ *
+ * @param pin The GPIO pin number.
+ *
+ * @return BOARD_IO_ERR_NONE on success.
+ */
+board_io_err_t board_io_dout_init(int pin);
+
+/**
+ * @brief It sets the level of a digital output
+ *
+ * @param pin The GPIO pin number.
+ * @param b_level true for high.
+ */
+void board_io_dout_write(int pin, bool b_level);
+
+/**
+ * @brief It returns the monotonic time the drivers stamp events with
+ *
+ * @return Microseconds since boot.
+ */
+int64_t board_io_time_us(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __BOARD_IO_H__
@@ -0,0 +1,97 @@
+/**
+* @file board_io_linux.h
+
+* @brief Scripting interface of the Linux backend of the hardware abstraction layer. Inputs
+*        follow waveforms given as steps on a virtual clock, outputs are recorded as
+*        transitions stamped with the same clock.
+
+* @par
+*
+* COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __BOARD_IO_LINUX_H__
+#define __BOARD_IO_LINUX_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stddef.h>
+#include "board_io.h"
+//---------------------------------- MACROS -----------------------------------
+#define BOARD_IO_LINUX_AIN_FULL_SCALE_mV (3300u)
+//-------------------------------- DATA TYPES ---------------------------------
+typedef struct
+{
+    int64_t  t_us;
+    uint32_t value; /* 0 or 1 for a digital input, mV for an analog input */
+} board_io_linux_step_t;
+
+typedef struct
+{
+    int64_t t_us;
+    int     pin;
+    bool    b_level;
+} board_io_linux_transition_t;
+//---------------------- PUBLIC FUNCTION PROTOTYPES ---------------------------
+
+/**
+ * @brief It sets the clock to 0, forgets all pins, scripts and recordings and seeds the noise
+ *
+ * @param seed The seed of the analog noise, anything but 0.
+ */
+void board_io_linux_reset(uint32_t seed);
+
+/**
+ * @brief It sets the waveform of an input. The steps are not copied and have to be sorted by
+ * time, the input holds the value of the last step at or before the clock and is 0 before the
+ * first step.
+ *
+ * @param pin The GPIO pin number.
+ * @param p_steps The steps.
+ * @param step_num The number of steps.
+ *
+ * @return BOARD_IO_ERR_NONE on success.
+ */
+board_io_err_t board_io_linux_script(int pin, const board_io_linux_step_t *p_steps, size_t step_num);
+
+/**
+ * @brief It adds uniform noise of up to +-noise_mV to every conversion of an analog input
+ *
+ * @param pin The GPIO pin number.
+ * @param noise_mV The noise amplitude.
+ */
+void board_io_linux_set_noise(int pin, uint32_t noise_mV);
+
+/**
+ * @brief It advances the clock to t_us. On the way the clock stops at every edge of a digital
+ * input with an edge callback, in time order, and calls the callback.
+ *
+ * @param t_us The new time, earlier times are ignored.
+ */
+void board_io_linux_run_until(int64_t t_us);
+
+/**
+ * @brief It records the level changes of all digital outputs into the buffer, replacing the
+ * previous recording
+ *
+ * @param p_log The buffer, NULL to stop recording.
+ * @param log_len The length of the buffer, changes past it are only counted.
+ */
+void board_io_linux_record(board_io_linux_transition_t *p_log, size_t log_len);
+
+/**
+ * @brief It returns the number of output transitions since the recording started
+ *
+ * @return The number of transitions, including the ones that did not fit the buffer.
+ */
+size_t board_io_linux_recorded(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __BOARD_IO_LINUX_H__
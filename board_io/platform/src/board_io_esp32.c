@@ -0,0 +1,174 @@
+/**
+* @file board_io_esp32.c
+
+* @brief ESP-IDF backend of the hardware abstraction layer.
+
+* @par
+*
+* COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "board_io.h"
+#include "driver/gpio.h"
+#include "driver/adc.h"
+#include "esp_adc_cal.h"
+#include "esp_timer.h"
+//---------------------------------- MACROS -----------------------------------
+#define ESP_INTR_FLAG_DEFAULT (0)
+#define ADC_DEFAULT_VREF      (1100u)
+#define ADC_ATTEN             (ADC_ATTEN_DB_11)
+#define ADC_WIDTH             (ADC_WIDTH_BIT_12)
+//-------------------------------- DATA TYPES ---------------------------------
+typedef struct
+{
+    int                            pin;
+    adc1_channel_t                 channel;
+    bool                           b_is_init;
+    esp_adc_cal_characteristics_t  adc_chars;
+} board_io_ain_t;
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief It finds the analog input record of the pin
+ *
+ * @param pin The GPIO pin number.
+ *
+ * @return A pointer to the record, NULL if the pin is not on ADC1.
+ */
+static board_io_ain_t *_ain_get(int pin);
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static board_io_ain_t _ain[ADC1_CHANNEL_MAX] = {
+    { .pin = 36, .channel = ADC1_CHANNEL_0 },
+    { .pin = 37, .channel = ADC1_CHANNEL_1 },
+    { .pin = 38, .channel = ADC1_CHANNEL_2 },
+    { .pin = 39, .channel = ADC1_CHANNEL_3 },
+    { .pin = 32, .channel = ADC1_CHANNEL_4 },
+    { .pin = 33, .channel = ADC1_CHANNEL_5 },
+    { .pin = 34, .channel = ADC1_CHANNEL_6 },
+    { .pin = 35, .channel = ADC1_CHANNEL_7 },
+};
+static bool _b_is_isr_service_installed = false;
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+board_io_err_t board_io_din_init(int pin, board_io_din_edge_cb_t edge_cb, void *p_arg)
+{
+    if ((0 > pin) || ((int) BOARD_IO_PIN_NUM <= pin))
+    {
+        return BOARD_IO_ERR_INVALID_PIN;
+    }
+    gpio_config_t io_conf = {
+        .pin_bit_mask = (1ULL << pin),
+        .mode         = GPIO_MODE_INPUT,
+        .pull_up_en   = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type    = ((NULL != edge_cb) ? GPIO_INTR_ANYEDGE : GPIO_INTR_DISABLE),
+    };
+    if (ESP_OK != gpio_config(&io_conf))
+    {
+        return BOARD_IO_ERR_INIT;
+    }
+    if (NULL == edge_cb)
+    {
+        return BOARD_IO_ERR_NONE;
+    }
+
+    if (!_b_is_isr_service_installed)
+    {
+        /* Another driver of the application may have installed the service already */
+        esp_err_t err = gpio_install_isr_service(ESP_INTR_FLAG_DEFAULT);
+        if ((ESP_OK != err) && (ESP_ERR_INVALID_STATE != err))
+        {
+            return BOARD_IO_ERR_INIT;
+        }
+        _b_is_isr_service_installed = true;
+    }
+    return ((ESP_OK == gpio_isr_handler_add(pin, edge_cb, p_arg)) ? BOARD_IO_ERR_NONE : BOARD_IO_ERR_INIT);
+}
+
+bool board_io_din_read(int pin)
+{
+    return (0 != gpio_get_level(pin));
+}
+
+board_io_err_t board_io_ain_init(int pin)
+{
+    board_io_ain_t *p_ain = _ain_get(pin);
+    if (NULL == p_ain)
+    {
+        return BOARD_IO_ERR_INVALID_PIN;
+    }
+    if (p_ain->b_is_init)
+    {
+        return BOARD_IO_ERR_NONE;
+    }
+    if ((ESP_OK != adc1_config_width(ADC_WIDTH))
+        || (ESP_OK != adc1_config_channel_atten(p_ain->channel, ADC_ATTEN)))
+    {
+        return BOARD_IO_ERR_INIT;
+    }
+    esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN, ADC_WIDTH, ADC_DEFAULT_VREF, &p_ain->adc_chars);
+    p_ain->b_is_init = true;
+    return BOARD_IO_ERR_NONE;
+}
+
+uint32_t board_io_ain_read_raw(int pin)
+{
+    board_io_ain_t *p_ain = _ain_get(pin);
+    if ((NULL == p_ain) || !p_ain->b_is_init)
+    {
+        return 0u;
+    }
+    int raw = adc1_get_raw(p_ain->channel);
+    return ((0 > raw) ? 0u : (uint32_t) raw);
+}
+
+uint32_t board_io_ain_raw_to_mV(int pin, uint32_t raw)
+{
+    board_io_ain_t *p_ain = _ain_get(pin);
+    if ((NULL == p_ain) || !p_ain->b_is_init)
+    {
+        return 0u;
+    }
+    return esp_adc_cal_raw_to_voltage(raw, &p_ain->adc_chars);
+}
+
+board_io_err_t board_io_dout_init(int pin)
+{
+    if ((0 > pin) || ((int) BOARD_IO_PIN_NUM <= pin))
+    {
+        return BOARD_IO_ERR_INVALID_PIN;
+    }
+    gpio_config_t io_conf = {
+        .pin_bit_mask = (1ULL << pin),
+        .mode         = GPIO_MODE_OUTPUT,
+        .pull_up_en   = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type    = GPIO_INTR_DISABLE,
+    };
+    return ((ESP_OK == gpio_config(&io_conf)) ? BOARD_IO_ERR_NONE : BOARD_IO_ERR_INIT);
+}
+
+void board_io_dout_write(int pin, bool b_level)
+{
+    gpio_set_level(pin, (b_level ? 1u : 0u));
+}
+
+int64_t board_io_time_us(void)
+{
+    return esp_timer_get_time();
+}
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static board_io_ain_t *_ain_get(int pin)
+{
+    for (size_t loop = 0; loop < ADC1_CHANNEL_MAX; loop++)
+    {
+        if (pin == _ain[loop].pin)
+        {
+            return &_ain[loop];
+        }
+    }
+    return NULL;
+}
+//---------------------------- INTERRUPT HANDLERS -----------------------------
@@ -0,0 +1,267 @@
+/**
+* @file board_io_linux.c
+
+* @brief Linux backend of the hardware abstraction layer. Nothing runs in the background, the
+*        clock only moves in board_io_linux_run_until(), so a simulation is deterministic and runs
+*        as fast as the drivers allow.
+
+* @par
+*
+* COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <string.h>
+#include "board_io_linux.h"
+//---------------------------------- MACROS -----------------------------------
+#define BOARD_IO_LINUX_AIN_MAX_RAW (4095u)
+//-------------------------------- DATA TYPES ---------------------------------
+typedef enum
+{
+    BOARD_IO_LINUX_PIN_UNUSED,
+
+    BOARD_IO_LINUX_PIN_DIN,
+    BOARD_IO_LINUX_PIN_AIN,
+    BOARD_IO_LINUX_PIN_DOUT
+} board_io_linux_pin_mode_t;
+
+typedef struct
+{
+    board_io_linux_pin_mode_t    mode;
+    board_io_din_edge_cb_t       edge_cb;
+    void                   *p_arg;
+    const board_io_linux_step_t *p_steps;
+    size_t                  step_num;
+    size_t                  step;     /* steps before it are in the past */
+    uint32_t                noise_mV;
+    bool                    b_level;  /* last level of a digital pin */
+} board_io_linux_pin_t;
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief It moves the step cursor of the pin up to the clock
+ *
+ * @param p_pin A pointer to the pin.
+ *
+ * @return The scripted value at the clock.
+ */
+static uint32_t _pin_value(board_io_linux_pin_t *p_pin);
+
+/**
+ * @brief It returns a pseudo random number
+ *
+ * @return The next number of the xorshift sequence.
+ */
+static uint32_t _random(void);
+
+/**
+ * @brief It checks the pin number
+ *
+ * @param pin The GPIO pin number.
+ *
+ * @return true if the pin exists.
+ */
+static inline bool _pin_valid(int pin);
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static board_io_linux_pin_t _pins[BOARD_IO_PIN_NUM];
+static int64_t _now_us = 0;
+static uint32_t _seed = 1u;
+static board_io_linux_transition_t *_p_log = NULL;
+static size_t _log_len = 0;
+static size_t _log_num = 0;
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+void board_io_linux_reset(uint32_t seed)
+{
+    memset(_pins, 0, sizeof(_pins));
+    _now_us = 0;
+    _seed = ((0u != seed) ? seed : 1u);
+    _p_log = NULL;
+    _log_len = 0;
+    _log_num = 0;
+}
+
+board_io_err_t board_io_linux_script(int pin, const board_io_linux_step_t *p_steps, size_t step_num)
+{
+    if (!_pin_valid(pin))
+    {
+        return BOARD_IO_ERR_INVALID_PIN;
+    }
+    board_io_linux_pin_t *p_pin = &_pins[pin];
+    p_pin->p_steps = p_steps;
+    p_pin->step_num = ((NULL != p_steps) ? step_num : 0u);
+    p_pin->step = 0;
+    p_pin->b_level = (0u != _pin_value(p_pin));
+    return BOARD_IO_ERR_NONE;
+}
+
+void board_io_linux_set_noise(int pin, uint32_t noise_mV)
+{
+    if (_pin_valid(pin))
+    {
+        _pins[pin].noise_mV = noise_mV;
+    }
+}
+
+void board_io_linux_run_until(int64_t t_us)
+{
+    for (;;)
+    {
+        /* The earliest pending step of an input with an edge callback */
+        board_io_linux_pin_t *p_next = NULL;
+        int64_t next_us = t_us;
+        for (size_t loop = 0; loop < BOARD_IO_PIN_NUM; loop++)
+        {
+            board_io_linux_pin_t *p_pin = &_pins[loop];
+            if ((NULL == p_pin->edge_cb) || (p_pin->step >= p_pin->step_num))
+            {
+                continue;
+            }
+            int64_t step_us = p_pin->p_steps[p_pin->step].t_us;
+            if ((step_us <= next_us) && ((NULL == p_next) || (step_us < next_us)))
+            {
+                p_next = p_pin;
+                next_us = step_us;
+            }
+        }
+        if (NULL == p_next)
+        {
+            break;
+        }
+
+        _now_us = ((next_us > _now_us) ? next_us : _now_us);
+        bool b_level = (0u != p_next->p_steps[p_next->step++].value);
+        if (b_level != p_next->b_level)
+        {
+            p_next->b_level = b_level;
+            p_next->edge_cb(p_next->p_arg);
+        }
+    }
+    _now_us = ((t_us > _now_us) ? t_us : _now_us);
+}
+
+void board_io_linux_record(board_io_linux_transition_t *p_log, size_t log_len)
+{
+    _p_log = p_log;
+    _log_len = ((NULL != p_log) ? log_len : 0u);
+    _log_num = 0;
+}
+
+size_t board_io_linux_recorded(void)
+{
+    return _log_num;
+}
+
+board_io_err_t board_io_din_init(int pin, board_io_din_edge_cb_t edge_cb, void *p_arg)
+{
+    if (!_pin_valid(pin))
+    {
+        return BOARD_IO_ERR_INVALID_PIN;
+    }
+    board_io_linux_pin_t *p_pin = &_pins[pin];
+    p_pin->mode = BOARD_IO_LINUX_PIN_DIN;
+    p_pin->edge_cb = edge_cb;
+    p_pin->p_arg = p_arg;
+    p_pin->b_level = (0u != _pin_value(p_pin));
+    return BOARD_IO_ERR_NONE;
+}
+
+bool board_io_din_read(int pin)
+{
+    if (!_pin_valid(pin))
+    {
+        return false;
+    }
+    board_io_linux_pin_t *p_pin = &_pins[pin];
+    /* An input with a callback reads the level its last edge left */
+    return ((NULL != p_pin->edge_cb) ? p_pin->b_level : (0u != _pin_value(p_pin)));
+}
+
+board_io_err_t board_io_ain_init(int pin)
+{
+    if (!_pin_valid(pin))
+    {
+        return BOARD_IO_ERR_INVALID_PIN;
+    }
+    _pins[pin].mode = BOARD_IO_LINUX_PIN_AIN;
+    return BOARD_IO_ERR_NONE;
+}
+
+uint32_t board_io_ain_read_raw(int pin)
+{
+    if (!_pin_valid(pin) || (BOARD_IO_LINUX_PIN_AIN != _pins[pin].mode))
+    {
+        return 0u;
+    }
+    board_io_linux_pin_t *p_pin = &_pins[pin];
+    int64_t mV = _pin_value(p_pin);
+    if (0u != p_pin->noise_mV)
+    {
+        mV += (int64_t) (_random() % (2u * p_pin->noise_mV + 1u)) - p_pin->noise_mV;
+    }
+    mV = ((0 > mV) ? 0 : ((BOARD_IO_LINUX_AIN_FULL_SCALE_mV < mV) ? BOARD_IO_LINUX_AIN_FULL_SCALE_mV : mV));
+    return (uint32_t) ((mV * BOARD_IO_LINUX_AIN_MAX_RAW + BOARD_IO_LINUX_AIN_FULL_SCALE_mV / 2u)
+                       / BOARD_IO_LINUX_AIN_FULL_SCALE_mV);
+}
+
+uint32_t board_io_ain_raw_to_mV(int pin, uint32_t raw)
+{
+    /* Every virtual channel has the ideal transfer function */
+    (void) pin;
+    return ((raw * BOARD_IO_LINUX_AIN_FULL_SCALE_mV + BOARD_IO_LINUX_AIN_MAX_RAW / 2u)
+            / BOARD_IO_LINUX_AIN_MAX_RAW);
+}
+
+board_io_err_t board_io_dout_init(int pin)
+{
+    if (!_pin_valid(pin))
+    {
+        return BOARD_IO_ERR_INVALID_PIN;
+    }
+    _pins[pin].mode = BOARD_IO_LINUX_PIN_DOUT;
+    _pins[pin].b_level = false;
+    return BOARD_IO_ERR_NONE;
+}
+
+void board_io_dout_write(int pin, bool b_level)
+{
+    if (!_pin_valid(pin) || (BOARD_IO_LINUX_PIN_DOUT != _pins[pin].mode) || (b_level == _pins[pin].b_level))
+    {
+        return;
+    }
+    _pins[pin].b_level = b_level;
+    if (_log_num < _log_len)
+    {
+        _p_log[_log_num] = (board_io_linux_transition_t) { .t_us = _now_us, .pin = pin, .b_level = b_level };
+    }
+    _log_num++;
+}
+
+int64_t board_io_time_us(void)
+{
+    return _now_us;
+}
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static uint32_t _pin_value(board_io_linux_pin_t *p_pin)
+{
+    while ((p_pin->step < p_pin->step_num) && (p_pin->p_steps[p_pin->step].t_us <= _now_us))
+    {
+        p_pin->step++;
+    }
+    return ((0u < p_pin->step) ? p_pin->p_steps[p_pin->step - 1u].value : 0u);
+}
+
+static uint32_t _random(void)
+{
+    _seed ^= _seed << 13;
+    _seed ^= _seed >> 17;
+    _seed ^= _seed << 5;
+    return _seed;
+}
+
+static inline bool _pin_valid(int pin)
+{
+    return ((0 <= pin) && ((int) BOARD_IO_PIN_NUM > pin));
+}
+//---------------------------- INTERRUPT HANDLERS -----------------------------
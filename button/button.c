@@ -11,9 +11,17 @@
 
 //--------------------------------- INCLUDES ----------------------------------
 #include "button.h"
-
+#include "button_fsm.h"
+#include "board_io.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
 //---------------------------------- MACROS -----------------------------------
-
+#define  button_service_THREAD_STACK_SIZE      (3u * 1024u)
+#define  button_service_THREAD_PRIORITY        (tskIDLE_PRIORITY + 6u) /* above the game */
+#define  BUTTON_EDGE_QUEUE_LEN                 (16u)
+#define  BUTTON_EVENT_QUEUE_LEN                (16u)
+#define  BUTTON_ADC_SAMPLE_MS                  (10u) /* one ADC channel per period, in turn */
 //-------------------------------- DATA TYPES ---------------------------------
 typedef enum
 {
@@ -38,8 +46,6 @@ typedef struct
 
         struct
         {
-            adc_channel_t channel;
-            adc_atten_t   atten;
             uint32_t      active_voltage_level_mV;
             button_adc_t  *p_btn;
         } adc;
@@ -47,8 +53,44 @@ typedef struct
 
 } button_config_t;
 
+typedef struct
+{
+    int64_t timestamp_us;
+    uint8_t button;
+    bool    b_pressed;
+} button_edge_t;
 //---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+/**
+ * It waits for edges and deadlines, samples the ADC buttons and runs the state machines.
+ * 
+ * @param p_argument NULL pointer, not used.
+ */
+static void button_service_task(void const *p_argument);
 
+/**
+ * It sends an event to the event queue if the button is subscribed.
+ * 
+ * @param btn_name The name of the button.
+ * @param type The type of the event.
+ * @param timestamp_us The time of the event.
+ */
+static void _button_event_send(button_t btn_name, button_event_type_t type, int64_t timestamp_us);
+
+/**
+ * It reads the current level of the button from the hardware.
+ * 
+ * @param btn_name The name of the button.
+ * 
+ * @return True if the button is pressed.
+ */
+static bool _button_read(button_t btn_name);
+
+/**
+ * It is called from the GPIO ISR on every edge and passes the stamped level to the service.
+ * 
+ * @param p_param A pointer to the label of the button.
+ */
+static void _button_gpio_edge(void *p_param);
 //------------------------- STATIC DATA & CONSTANTS ---------------------------
 
 static button_config_t _button_info[BUTTON_COUNT] = {
@@ -66,73 +108,212 @@ static button_config_t _button_info[BUTTON_COUNT] = {
     { .pin = 00, .type = BUTTON_TYPE_GPIO, .level.gpio.active_on_high_level = false }, /* BUTTON_VOL */
     { .pin = 13, .type = BUTTON_TYPE_GPIO, .level.gpio.active_on_high_level = false }, /* BUTTON_MENU */
 };
+
+static button_fsm_t _button_fsm[BUTTON_COUNT];
+static TaskHandle_t task_button_service_hndl = NULL;
+static QueueHandle_t button_edge_queue = NULL;
+static QueueHandle_t button_event_queue = NULL;
+static volatile uint32_t _subscribed_mask = 0;
+static volatile uint32_t _dropped_events = 0;
 //------------------------------- GLOBAL DATA ---------------------------------
 
 //------------------------------ PUBLIC FUNCTIONS -----------------------------
 
-button_err_t button_init(button_t btn_name, button_pressed_t btn_cbk, bool b_adc_want_rising_edge)
+button_err_t button_init(void)
 {
-    /* Validate button name */
-    if(BUTTON_COUNT <= btn_name)
+    if (NULL != task_button_service_hndl)
     {
-        return BUTTON_ERR_UNKNOWN_BUTTON;
+        return BUTTON_ERR_NONE;
     }
 
-    if(BUTTON_TYPE_GPIO == _button_info[btn_name].type)
+    button_edge_queue = xQueueCreate(BUTTON_EDGE_QUEUE_LEN, sizeof(button_edge_t));
+    button_event_queue = xQueueCreate(BUTTON_EVENT_QUEUE_LEN, sizeof(button_event_t));
+    if ((NULL == button_edge_queue) || (NULL == button_event_queue))
     {
-        button_gpio_t *button
-            = button_gpio_create(_button_info[btn_name].pin, btn_name, 
-                        _button_info[btn_name].level.gpio.active_on_high_level, btn_cbk);
-        if(NULL == button)
-        {
-            return BUTTON_ERR_INIT;
-        }
-        _button_info[btn_name].level.gpio.p_btn = button;
+        return BUTTON_ERR_INIT;
     }
-    else if(BUTTON_TYPE_ADC == _button_info[btn_name].type)
+
+    button_err_t err = BUTTON_ERR_NONE;
+    for (size_t loop = 0; loop < BUTTON_COUNT; loop++)
     {
-        button_adc_t *button = button_adc_create(_button_info[btn_name].pin, btn_name,
-                        _button_info[btn_name].level.adc.active_voltage_level_mV, btn_cbk,
-                        b_adc_want_rising_edge);
-        if(NULL == button)
+        button_config_t *p_info = &_button_info[loop];
+        button_fsm_init(&_button_fsm[loop], loop, _button_event_send);
+
+        if (BUTTON_TYPE_GPIO == p_info->type)
+        {
+            p_info->level.gpio.p_btn = button_gpio_create(p_info->pin, loop,
+                                            p_info->level.gpio.active_on_high_level, _button_gpio_edge);
+            err = ((NULL == p_info->level.gpio.p_btn) ? BUTTON_ERR_INIT : err);
+        }
+        else if (BUTTON_TYPE_ADC == p_info->type)
         {
-            return BUTTON_ERR_INIT;
+            p_info->level.adc.p_btn = button_adc_create(p_info->pin, loop,
+                                            p_info->level.adc.active_voltage_level_mV);
+            err = ((NULL == p_info->level.adc.p_btn) ? BUTTON_ERR_INIT : err);
         }
-        _button_info[btn_name].level.adc.p_btn = button;
     }
-    else
+
+    BaseType_t task_ret_val;
+    task_ret_val = xTaskCreate((TaskFunction_t)button_service_task,
+                               "button_service task",
+                               button_service_THREAD_STACK_SIZE,
+                               NULL,
+                               button_service_THREAD_PRIORITY,
+                               &task_button_service_hndl);
+    if ((NULL == task_button_service_hndl) || (task_ret_val != pdPASS))
     {
+        printf("Error creating button service task\n");
         return BUTTON_ERR_INIT;
     }
 
+    return err;
+}
+
+void button_subscribe(uint32_t mask)
+{
+    _subscribed_mask = mask;
+    if (NULL != button_event_queue)
+    {
+        xQueueReset(button_event_queue);
+    }
+}
+
+button_err_t button_set_repeat(button_t btn_name, uint32_t delay_ms, uint32_t period_ms)
+{
+    /* Validate button name */
+    if (BUTTON_COUNT <= btn_name)
+    {
+        return BUTTON_ERR_UNKNOWN_BUTTON;
+    }
+    _button_fsm[btn_name].repeat_delay_ms = delay_ms;
+    _button_fsm[btn_name].repeat_period_ms = period_ms;
     return BUTTON_ERR_NONE;
 }
 
+bool button_event_get(button_event_t *p_event, uint32_t timeout_ms)
+{
+    if ((NULL == button_event_queue) || (NULL == p_event))
+    {
+        return false;
+    }
+    TickType_t wait = ((portMAX_DELAY == timeout_ms) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms));
+    return (pdTRUE == xQueueReceive(button_event_queue, p_event, wait));
+}
+
 bool button_is_pressed(button_t btn_name)
 {
-    bool ret = false;
     /* Validate button name */
-    if(BUTTON_COUNT <= btn_name)
+    if (BUTTON_COUNT <= btn_name)
     {
         printf("Invalid button name\n");
+        return false;
+    }
+    return button_fsm_is_pressed(&_button_fsm[btn_name]);
+}
+
+uint32_t button_get_dropped_events(void)
+{
+    return _dropped_events;
+}
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static void button_service_task(void const *p_argument)
+{
+    const int64_t tick_us = portTICK_PERIOD_MS * 1000;
+    int64_t next_sample_us = board_io_time_us();
+    button_edge_t edge;
+    for (;;)
+    {
+        int64_t now_us = board_io_time_us();
+        int64_t wake_us = next_sample_us;
+        for (size_t loop = 0; loop < BUTTON_COUNT; loop++)
+        {
+            wake_us = ((_button_fsm[loop].deadline_us < wake_us) ? _button_fsm[loop].deadline_us : wake_us);
+        }
+        /* Round up, waking before the deadline would only spin */
+        TickType_t wait = ((wake_us > now_us) ? (TickType_t) ((wake_us - now_us + tick_us - 1) / tick_us) : 0);
+        if (pdTRUE == xQueueReceive(button_edge_queue, &edge, wait))
+        {
+            button_fsm_level(&_button_fsm[edge.button], edge.b_pressed, edge.timestamp_us);
+        }
+
+        now_us = board_io_time_us();
+        if (now_us >= next_sample_us)
+        {
+            button_adc_sample();
+            for (size_t loop = 0; loop < BUTTON_COUNT; loop++)
+            {
+                if ((BUTTON_TYPE_ADC == _button_info[loop].type) && (NULL != _button_info[loop].level.adc.p_btn))
+                {
+                    button_fsm_level(&_button_fsm[loop], button_adc_is_pressed(_button_info[loop].level.adc.p_btn), now_us);
+                }
+            }
+            next_sample_us += BUTTON_ADC_SAMPLE_MS * 1000;
+            if (next_sample_us <= now_us)
+            {
+                next_sample_us = now_us + BUTTON_ADC_SAMPLE_MS * 1000;
+            }
+        }
+        for (size_t loop = 0; loop < BUTTON_COUNT; loop++)
+        {
+            if (now_us >= _button_fsm[loop].deadline_us)
+            {
+                button_fsm_deadline(&_button_fsm[loop], _button_read(loop), now_us);
+            }
+        }
+    }
+    vTaskDelete(NULL);
+}
+
+static void _button_event_send(button_t btn_name, button_event_type_t type, int64_t timestamp_us)
+{
+    if (0u == (_subscribed_mask & BUTTON_MASK(btn_name)))
+    {
+        return;
+    }
+    button_event_t event = {
+        .timestamp_us = timestamp_us,
+        .button       = btn_name,
+        .type         = type,
+    };
+    if (pdTRUE != xQueueSend(button_event_queue, &event, 0))
+    {
+        _dropped_events++;
     }
+}
 
-    if((BUTTON_TYPE_GPIO == _button_info[btn_name].type)
+static bool _button_read(button_t btn_name)
+{
+    bool ret = false;
+    if ((BUTTON_TYPE_GPIO == _button_info[btn_name].type)
         && (_button_info[btn_name].level.gpio.p_btn))
     {
         ret = button_gpio_is_pressed(_button_info[btn_name].level.gpio.p_btn);
     }
-    else if((BUTTON_TYPE_ADC == _button_info[btn_name].type)
+    else if ((BUTTON_TYPE_ADC == _button_info[btn_name].type)
          && (_button_info[btn_name].level.adc.p_btn))
     {
         ret = button_adc_is_pressed(_button_info[btn_name].level.adc.p_btn);
     }
-    else
-    {
-        printf("Something went wrong with detecting pressed buttons\n");
-    }
     return ret;
 }
-//---------------------------- PRIVATE FUNCTIONS ------------------------------
-
 //---------------------------- INTERRUPT HANDLERS -----------------------------
+static void _button_gpio_edge(void *p_param)
+{
+    uint8_t label = *((uint8_t *) p_param);
+    BaseType_t b_woken = pdFALSE;
+    if (NULL == _button_info[label].level.gpio.p_btn)
+    {
+        /* An edge before button_init() stored the button */
+        return;
+    }
+    button_edge_t edge = {
+        .timestamp_us = board_io_time_us(),
+        .button       = label,
+        .b_pressed    = button_gpio_is_pressed(_button_info[label].level.gpio.p_btn),
+    };
+    xQueueSendFromISR(button_edge_queue, &edge, &b_woken);
+    if (b_woken)
+    {
+        portYIELD_FROM_ISR();
+    }
+}
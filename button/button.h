@@ -18,13 +18,13 @@ extern "C" {
 
 //--------------------------------- INCLUDES ----------------------------------
 #include <stdio.h>
+#include <stdint.h>
 #include <button_gpio.h>
 #include <button_adc.h>
 //---------------------------------- MACROS -----------------------------------
-
+#define BUTTON_MASK(BTN)        (1UL << (BTN))
+#define BUTTON_MASK_ALL         (BUTTON_MASK(BUTTON_COUNT) - 1UL)
 //-------------------------------- DATA TYPES ---------------------------------
-typedef void (*button_pressed_t)(void *);
-
 typedef enum
 {
     BUTTON_UP,
@@ -49,20 +49,63 @@ typedef enum
     BUTTON_ERR_INIT           = -2,
     BUTTON_ERR_UNKNOWN_BUTTON = -3,
 } button_err_t;
+
+typedef enum
+{
+    BUTTON_EVENT_PRESS,
+    BUTTON_EVENT_RELEASE,
+    BUTTON_EVENT_REPEAT,
+} button_event_type_t;
+
+typedef struct
+{
+    int64_t             timestamp_us; /* board_io_time_us() of the edge (or of the repeat) */
+    button_t            button;
+    button_event_type_t type;
+} button_event_t;
 //---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
 
 /**
- * It creates a button object based on the button type and initializes it.
+ * It initializes all buttons and starts the input service task. The service stamps every edge,
+ * debounces it and delivers press, release and repeat events to a single event queue.
+ * Calling it again does nothing.
  * 
- * @param btn_name The name of the button to initialize.
- * @param btn_cbk This is the callback function that will be called when the button is pressed.
- * @param b_adc_want_rising_edge True if you want rising edge detection for ADC buttons, otherwise
- *                                  pressed detection.
+ * @return BUTTON_ERR_NONE if the service is running.
  */
-button_err_t button_init(button_t btn_name, button_pressed_t btn_cbk, bool b_adc_want_rising_edge);
+button_err_t button_init(void);
 
 /**
- * It checks if the button with the name of btn_name is pressed.
+ * It selects the buttons whose events are delivered to the event queue and drops the events
+ * still queued for the previous subscriber. Screens call it when they are switched to.
+ * 
+ * @param mask BUTTON_MASK() of the buttons to deliver.
+ */
+void button_subscribe(uint32_t mask);
+
+/**
+ * It sets the auto-repeat of a button. While the button is held, repeat events are sent
+ * delay_ms after the press and then every period_ms.
+ * 
+ * @param btn_name The name of the button.
+ * @param delay_ms The delay after the press.
+ * @param period_ms The period of the repeats, 0 turns the auto-repeat off.
+ * 
+ * @return BUTTON_ERR_NONE if the auto-repeat is set.
+ */
+button_err_t button_set_repeat(button_t btn_name, uint32_t delay_ms, uint32_t period_ms);
+
+/**
+ * It takes the next event from the event queue.
+ * 
+ * @param p_event The event taken.
+ * @param timeout_ms How long to wait for an event, 0 to return at once.
+ * 
+ * @return True if an event was taken.
+ */
+bool button_event_get(button_event_t *p_event, uint32_t timeout_ms);
+
+/**
+ * It checks if the button with the name of btn_name is pressed, after debouncing.
  * 
  * @param btn_name The name of the button to check if pressed.
  * 
@@ -70,6 +113,13 @@ button_err_t button_init(button_t btn_name, button_pressed_t btn_cbk, bool b_adc
  */
 bool button_is_pressed(button_t btn_name);
 
+/**
+ * It returns how many events were lost to a full event queue.
+ * 
+ * @return The number of events dropped.
+ */
+uint32_t button_get_dropped_events(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,100 @@
+/**
+* @file button_fsm.c
+
+* @brief Debounce and auto-repeat state machine of a single button. Presses and releases are
+*        sent on the leading edge, the bounces after an edge are ignored until it settles.
+*        It has no hardware or RTOS dependencies, the owner feeds it levels and deadlines.
+
+* @par
+*
+* COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "button_fsm.h"
+//---------------------------------- MACROS -----------------------------------
+
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+void button_fsm_init(button_fsm_t *p_fsm, button_t btn_name, button_fsm_event_cb_t event_cb)
+{
+    p_fsm->btn_name = btn_name;
+    p_fsm->event_cb = event_cb;
+    p_fsm->state = BUTTON_STATE_RELEASED;
+    p_fsm->deadline_us = BUTTON_FSM_NO_DEADLINE;
+    p_fsm->pressed_us = 0;
+    p_fsm->repeat_delay_ms = 0;
+    p_fsm->repeat_period_ms = 0;
+}
+
+void button_fsm_level(button_fsm_t *p_fsm, bool b_pressed, int64_t timestamp_us)
+{
+    if ((BUTTON_STATE_RELEASED == p_fsm->state) && b_pressed)
+    {
+        /* Leading edge: the press goes out at once, the bounces after it are ignored */
+        p_fsm->event_cb(p_fsm->btn_name, BUTTON_EVENT_PRESS, timestamp_us);
+        p_fsm->state = BUTTON_STATE_PRESS_SETTLING;
+        p_fsm->pressed_us = timestamp_us;
+        p_fsm->deadline_us = timestamp_us + BUTTON_DEBOUNCE_MS * 1000;
+    }
+    else if ((BUTTON_STATE_PRESSED == p_fsm->state) && !b_pressed)
+    {
+        p_fsm->event_cb(p_fsm->btn_name, BUTTON_EVENT_RELEASE, timestamp_us);
+        p_fsm->state = BUTTON_STATE_RELEASE_SETTLING;
+        p_fsm->deadline_us = timestamp_us + BUTTON_DEBOUNCE_MS * 1000;
+    }
+}
+
+void button_fsm_deadline(button_fsm_t *p_fsm, bool b_pressed, int64_t now_us)
+{
+    switch (p_fsm->state)
+    {
+        case BUTTON_STATE_PRESS_SETTLING:
+            p_fsm->state = BUTTON_STATE_PRESSED;
+            p_fsm->deadline_us = ((0u != p_fsm->repeat_period_ms) ?
+                                    (p_fsm->pressed_us + p_fsm->repeat_delay_ms * 1000) : BUTTON_FSM_NO_DEADLINE);
+            /* A release while settling had no edge of its own */
+            button_fsm_level(p_fsm, b_pressed, now_us);
+        break;
+
+        case BUTTON_STATE_PRESSED:
+            if (0u == p_fsm->repeat_period_ms)
+            {
+                p_fsm->deadline_us = BUTTON_FSM_NO_DEADLINE;
+                break;
+            }
+            p_fsm->event_cb(p_fsm->btn_name, BUTTON_EVENT_REPEAT, now_us);
+            p_fsm->deadline_us += p_fsm->repeat_period_ms * 1000;
+            if (p_fsm->deadline_us <= now_us)
+            {
+                p_fsm->deadline_us = now_us + p_fsm->repeat_period_ms * 1000;
+            }
+        break;
+
+        case BUTTON_STATE_RELEASE_SETTLING:
+            p_fsm->state = BUTTON_STATE_RELEASED;
+            p_fsm->deadline_us = BUTTON_FSM_NO_DEADLINE;
+            button_fsm_level(p_fsm, b_pressed, now_us);
+        break;
+
+        default:
+            p_fsm->deadline_us = BUTTON_FSM_NO_DEADLINE;
+        break;
+    }
+}
+
+bool button_fsm_is_pressed(const button_fsm_t *p_fsm)
+{
+    return ((BUTTON_STATE_PRESS_SETTLING == p_fsm->state) || (BUTTON_STATE_PRESSED == p_fsm->state));
+}
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+
+//---------------------------- INTERRUPT HANDLERS -----------------------------
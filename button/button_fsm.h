@@ -0,0 +1,89 @@
+/**
+* @file button_fsm.h
+
+* @brief See the source file.
+
+* @par
+*
+* COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __BUTTON_FSM_H__
+#define __BUTTON_FSM_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdint.h>
+#include <stdbool.h>
+#include "button.h"
+//---------------------------------- MACROS -----------------------------------
+#define BUTTON_DEBOUNCE_MS     (20u)
+#define BUTTON_FSM_NO_DEADLINE (INT64_MAX)
+//-------------------------------- DATA TYPES ---------------------------------
+typedef enum
+{
+    BUTTON_STATE_RELEASED,
+    BUTTON_STATE_PRESS_SETTLING,   /* press sent, bounces ignored until the deadline */
+    BUTTON_STATE_PRESSED,          /* the deadline is the next repeat, if any */
+    BUTTON_STATE_RELEASE_SETTLING, /* release sent, bounces ignored until the deadline */
+} button_state_t;
+
+typedef void (*button_fsm_event_cb_t)(button_t btn_name, button_event_type_t type, int64_t timestamp_us);
+
+typedef struct
+{
+    button_t              btn_name;
+    button_fsm_event_cb_t event_cb;
+    button_state_t        state;
+    int64_t               deadline_us;
+    int64_t               pressed_us;
+    uint32_t              repeat_delay_ms;
+    uint32_t              repeat_period_ms;
+} button_fsm_t;
+//---------------------- PUBLIC FUNCTION PROTOTYPES ---------------------------
+
+/**
+ * It puts the state machine of a button into the released state, without auto-repeat.
+ *
+ * @param p_fsm The state machine.
+ * @param btn_name The name of the button, passed to the callback.
+ * @param event_cb The callback the press, release and repeat events are sent to.
+ */
+void button_fsm_init(button_fsm_t *p_fsm, button_t btn_name, button_fsm_event_cb_t event_cb);
+
+/**
+ * It feeds a sampled level of the button to its state machine.
+ *
+ * @param p_fsm The state machine.
+ * @param b_pressed The level, true if pressed.
+ * @param timestamp_us The time the level was sampled at.
+ */
+void button_fsm_level(button_fsm_t *p_fsm, bool b_pressed, int64_t timestamp_us);
+
+/**
+ * It ends the settling or sends the repeat once the deadline of the state machine has passed.
+ *
+ * @param p_fsm The state machine.
+ * @param b_pressed The current level of the button, true if pressed.
+ * @param now_us The current time, at or after p_fsm->deadline_us.
+ */
+void button_fsm_deadline(button_fsm_t *p_fsm, bool b_pressed, int64_t now_us);
+
+/**
+ * It checks if the debounced state of the state machine is pressed.
+ *
+ * @param p_fsm The state machine.
+ *
+ * @return True if pressed.
+ */
+bool button_fsm_is_pressed(const button_fsm_t *p_fsm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __BUTTON_FSM_H__
@@ -18,15 +18,13 @@ extern "C" {
 
 //--------------------------------- INCLUDES ----------------------------------
 #include <stdio.h>
+#include <stdint.h>
 #include <stdbool.h>
-#include "driver/adc.h"
 //---------------------------------- MACROS -----------------------------------
 #define BUTTON_HIGH_VOLTAGE_LVL (3155U)
 #define BUTTON_LOW_VOLTAGE_LVL  (1700U)
 //-------------------------------- DATA TYPES ---------------------------------
 
-typedef void (*btn_adc_pressed_t)(void *);
-
 // Struct is hidden on purpose from an user. 
 struct _button_adc_t;
 typedef struct _button_adc_t button_adc_t;
@@ -36,18 +34,16 @@ typedef struct _button_adc_t button_adc_t;
 /**
  * @brief It creates a button object and initializes it
  *
- * @param pin The GPIO pin number that the button is connected to.
- * @param adc_channel The ADC channel to which the pin is connected to.
- * @param adc_atten ADC attenuation parameter. Different parameters determine the range of the ADC. 
- * @param active_voltage_level_mV Threshold (number in mV) used for detecting which button is pressed.
- * @param button_pressed_cb This is the callback function that will be called when the button is
- * pressed.
- * @param b_rising_edge true if you want rising edge detection, otherwise if pressed detection.
+ * @param pin The GPIO pin number that the button is connected to. Buttons on the same pin share
+ * its ADC channel.
+ * @param label The label of the button.
+ * @param active_voltage_level_mV Voltage (number in mV) the pin reads while the button is pressed.
+ *
+ * @note ADC buttons raise no interrupt, the owner has to call button_adc_sample() periodically.
  *
  * @return A pointer to a button_adc_t struct.
  */
-button_adc_t *button_adc_create(int pin, uint8_t label, uint32_t active_voltage_level_mV, 
-                                btn_adc_pressed_t button_pressed_cb, bool b_rising_edge);
+button_adc_t *button_adc_create(int pin, uint8_t label, uint32_t active_voltage_level_mV);
 
 /**
  * @brief This function frees the memory allocated for the button_adc_t structure
@@ -58,7 +54,7 @@ button_adc_t *button_adc_create(int pin, uint8_t label, uint32_t active_voltage_
 void button_adc_destroy(button_adc_t *p_btn);
 
 /**
- * @brief This function returns true if the button is pressed, false otherwise
+ * @brief This function returns true if the button was pressed at the last sample, false otherwise
  * 
  * @param p_btn A pointer to the button_adc_t structure that was created in the previous step.
  * 
@@ -66,6 +62,13 @@ void button_adc_destroy(button_adc_t *p_btn);
  */
 bool button_adc_is_pressed(button_adc_t *p_btn);
 
+/**
+ * @brief It reads the next ADC channel in turn, as the median of a short burst, and classifies
+ * the reading against the voltage levels of all buttons on the channel. The buttons of the
+ * other channels keep the state of their last sample.
+ */
+void button_adc_sample(void);
+
 
 #ifdef __cplusplus
 }
@@ -18,12 +18,13 @@ extern "C" {
 
 //--------------------------------- INCLUDES ----------------------------------
 #include <stdio.h>
+#include <stdint.h>
 #include <stdbool.h>
 //---------------------------------- MACROS -----------------------------------
 
 //-------------------------------- DATA TYPES ---------------------------------
 
-typedef void (*btn_gpio_pressed_t)(void *);
+typedef void (*btn_gpio_edge_t)(void *);
 
 // Struct is hidden on purpose from an user. 
 struct _button_gpio_t;
@@ -37,13 +38,13 @@ typedef struct _button_gpio_t button_gpio_t;
  * @param pin The GPIO pin number that the button is connected to.
  * @param active_on_high_level If true, the button is active when the GPIO is high. If false, the
  * button is active when the GPIO is low.
- * @param button_pressed_cb This is the callback function that will be called when the button is
- * pressed.
+ * @param button_edge_cb This is the callback function that will be called from the ISR on every
+ * edge of the pin, with a pointer to the label. It is not debounced.
  *
  * @return A pointer to a button_gpio_t struct.
  */
 button_gpio_t *button_gpio_create(int pin, uint8_t label, bool active_on_high_level,
-                                    btn_gpio_pressed_t button_pressed_cb);
+                                    btn_gpio_edge_t button_edge_cb);
 
 /**
  * @brief This function frees the memory allocated for the button_gpio_t structure
@@ -1,10 +1,11 @@
 /**
 * @file button_adc.c
 
-* @brief 
+* @brief Buttons connected to ADC channels through voltage dividers. One channel is sampled
+*        per cycle, in turn, and the reading is classified against all buttons sharing the pin.
 
-* @par 
-* 
+* @par
+*
 * COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
 * All rights reserved.
 */
@@ -12,63 +13,48 @@
 //--------------------------------- INCLUDES ----------------------------------
 #include <stdlib.h>
 #include "button_adc.h"
-#include "esp_adc_cal.h"
-#include "driver/gpio.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
+#include "board_io.h"
 //---------------------------------- MACROS -----------------------------------
-#define  PIN_L_AND_R                              (34u)
-#define  PIN_U_AND_D                              (35u)
-#define  ADC_DEFAULT_VREF                         (1100u)
 #define  ADC_MARGIN_OF_ERR                        (100u)
-#define  ADC_BUTTON_NUM                           (4u)
-#define  ADC_BUTTONS_CHECK_THREAD_STACK_SIZE      (3u *1024u)
-#define  ADC_BUTTONS_CHECK_THREAD_PRIORITY        (tskIDLE_PRIORITY + 4u) 
+#define  ADC_CHANNEL_NUM                          (2u)
+#define  ADC_CHANNEL_BUTTON_NUM                   (2u)
+#define  ADC_BURST_SAMPLES                        (3u) /* odd, for the median */
 //-------------------------------- DATA TYPES ---------------------------------
-
-//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
-
-//------------------------- STATIC DATA & CONSTANTS ---------------------------
-struct _button_adc_t
+typedef struct
 {
-    uint8_t                        pin;
-    uint32_t                       active_voltage_level_mV;
-    adc_channel_t                  channel;
-    adc_atten_t                    atten;
-    esp_adc_cal_characteristics_t *p_adc_chars;
-    btn_adc_pressed_t              btn_pressed_cb;
-    TaskHandle_t                   p_task;
-    bool                           b_was_pressed;
-    bool                           b_is_pressed;
-    uint8_t                        label;
-    bool                           b_want_rising_edge;
-
-} ;
-
-static const adc_bits_width_t _adc_width = ADC_WIDTH_BIT_12;
-static button_adc_t* _button_pointers[ADC_BUTTON_NUM];
-static TaskHandle_t task_adc_buttons_check_hndl  = NULL;
-//------------------------------- GLOBAL DATA ---------------------------------
+    uint8_t       pin;
+    button_adc_t *p_btns[ADC_CHANNEL_BUTTON_NUM];
+    uint8_t       btn_num;
+    uint32_t      voltage_mV; /* last filtered reading */
+} button_adc_channel_t;
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
 /**
- * @brief It configures the GPIO pin as an input, sets the interrupt type, installs the ISR service, and
- * adds the ISR handler
+ * @brief It finds the channel of the pin, configuring the pin as an analog input the first time
+ * it is used
  *
- * @param p_btn a pointer to the button_adc_t structure.
+ * @param pin The GPIO pin number.
  *
- * @return an integer as an error code.
+ * @return A pointer to the channel, NULL if the pin is not an ADC button pin.
  */
-static int _button_init(button_adc_t *p_btn);
+static button_adc_channel_t *_channel_get(uint8_t pin);
 
 /**
- * @brief If the button is active on high level, return true if the pin is high, otherwise return false if
- * the pin is low
+ * @brief It reads the channel in a burst and returns the median of the burst in mV
  *
- * @param p_btn a pointer to the button_adc_t structure that was passed to the button_adc_init()
- * function.
+ * @param p_channel A pointer to the channel.
+ *
+ * @return The filtered voltage in mV.
+ */
+static uint32_t _channel_read_mV(button_adc_channel_t *p_channel);
+
+/**
+ * @brief It marks the button whose voltage level is nearest to the reading as pressed, provided
+ * it is within the margin, and all other buttons of the channel as released
  *
- * @return a boolean value.
+ * @param p_channel A pointer to the channel.
+ * @param voltage_mV The filtered reading.
  */
-static bool _is_button_pressed(button_adc_t *p_btn);
+static void _channel_classify(button_adc_channel_t *p_channel, uint32_t voltage_mV);
 
 /**
  * @brief Allocate memory for a button_adc_t structure and return a pointer to it
@@ -86,85 +72,50 @@ static button_adc_t *_button_alloc(void);
 static void _button_free(button_adc_t *p_btn);
 
 /**
- * @brief If the difference of the first and the second number is within allowed margin, return true,
- *        otherwise return false
+ * @brief It returns the absolute difference of two numbers
  *
- * @param first First number to be compared.
- * @param second Second number to be compared.
- * @param margin Difference of numbers cannot be more than the margin.
- * 
- * @return a boolean value.
- */
-static inline bool _are_numbers_within_margin(uint32_t first, uint32_t second, uint32_t margin);
-
-/**
- * @brief This function returns true if a rising edge occured, otherwise false
+ * @param first First number.
+ * @param second Second number.
  *
- * @param p_btn A pointer to the button_adc_t structure that was created by the _button_create()
- * function.
- * 
- * @return a boolean value.
+ * @return The difference.
  */
-static bool _is_rising_edge(button_adc_t *p_btn);
+static inline uint32_t _numbers_diff(uint32_t first, uint32_t second);
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+struct _button_adc_t
+{
+    uint8_t               pin;
+    uint32_t              active_voltage_level_mV;
+    button_adc_channel_t *p_channel;
+    uint8_t               label;
+    bool                  b_is_pressed;
+} ;
 
-/**
- * @brief Task which periodically checks if a button connected to ADC is pressed.
- *
- * @param p_param NULL pointer, not used.
- */
-static void adc_buttons_check_task (void const *p_argument);
+static button_adc_channel_t _channels[ADC_CHANNEL_NUM];
+static uint8_t _channel_num = 0;
+static uint8_t _channel_next = 0;
+//------------------------------- GLOBAL DATA ---------------------------------
 
-/**
- * It calls the button callback function if it's not NULL
- * 
- * @param p_btn the button object
- */
-static inline void _btn_cb_call(button_adc_t *p_btn);
 //------------------------------ PUBLIC FUNCTIONS -----------------------------
 
-button_adc_t *button_adc_create(int pin, uint8_t label, uint32_t active_voltage_level_mV,
-                                btn_adc_pressed_t button_pressed_cb, bool b_rising_edge)
+button_adc_t *button_adc_create(int pin, uint8_t label, uint32_t active_voltage_level_mV)
 {
-    button_adc_t *p_btn = _button_pointers[label];
-    if (NULL == p_btn)
+    button_adc_channel_t *p_channel = _channel_get(pin);
+    if ((NULL == p_channel) || (ADC_CHANNEL_BUTTON_NUM <= p_channel->btn_num))
     {
-        p_btn = _button_alloc();
-        if (NULL == p_btn)
-        {
-            return NULL;
-        }
+        return NULL;
     }
-
-    // Create task adc_buttons_check.
-    if (NULL == task_adc_buttons_check_hndl)
+    button_adc_t *p_btn = _button_alloc();
+    if (NULL == p_btn)
     {
-        BaseType_t task_ret_val;
-        task_ret_val = xTaskCreate((TaskFunction_t)adc_buttons_check_task,
-                                   "adc_buttons_check task",
-                                   ADC_BUTTONS_CHECK_THREAD_STACK_SIZE,
-                                   NULL,
-                                   ADC_BUTTONS_CHECK_THREAD_PRIORITY,
-                                   &task_adc_buttons_check_hndl);
-
-        if ((NULL == task_adc_buttons_check_hndl) || (task_ret_val != pdPASS))
-        {
-            printf("Error creating ADC buttons task\n");
-        }
+        return NULL;
     }
 
     p_btn->pin                     = pin;
     p_btn->label                   = label;
     p_btn->active_voltage_level_mV = active_voltage_level_mV;
-    p_btn->btn_pressed_cb          = button_pressed_cb;
-    p_btn->p_task                  = task_adc_buttons_check_hndl;
-    p_btn->b_want_rising_edge      = b_rising_edge;
-
-    if (0 != _button_init(p_btn))
-    {
-        // Delete button.
-        _button_free(p_btn);
-    }
-    _button_pointers[label] = p_btn;
+    p_btn->p_channel               = p_channel;
+    p_btn->b_is_pressed            = false;
+    p_channel->p_btns[p_channel->btn_num++] = p_btn;
 
     return p_btn;
 }
@@ -178,112 +129,113 @@ void button_adc_destroy(button_adc_t *p_btn)
 
 bool button_adc_is_pressed(button_adc_t *p_btn)
 {
-    return _is_button_pressed(p_btn);
+    return ((NULL != p_btn) ? p_btn->b_is_pressed : false);
+}
+
+void button_adc_sample(void)
+{
+    /* Channels without buttons are skipped, they do not cost a cycle */
+    for (size_t loop = 0; loop < _channel_num; loop++)
+    {
+        button_adc_channel_t *p_channel = &_channels[_channel_next];
+        _channel_next = ((_channel_next + 1u) < _channel_num) ? (_channel_next + 1u) : 0u;
+        if (0u != p_channel->btn_num)
+        {
+            p_channel->voltage_mV = _channel_read_mV(p_channel);
+            _channel_classify(p_channel, p_channel->voltage_mV);
+            return;
+        }
+    }
 }
 //---------------------------- PRIVATE FUNCTIONS ------------------------------
-static int _button_init(button_adc_t *p_btn)
+static button_adc_channel_t *_channel_get(uint8_t pin)
 {
-    switch(p_btn->pin)
+    for (size_t loop = 0; loop < _channel_num; loop++)
     {
-        case PIN_L_AND_R:
-            p_btn->channel = ADC_CHANNEL_6;
-        break;
-
-        case PIN_U_AND_D:
-            p_btn->channel = ADC_CHANNEL_7;
-        break;
+        if (pin == _channels[loop].pin)
+        {
+            return &_channels[loop];
+        }
     }
-    p_btn->atten = ADC_ATTEN_DB_11;
-    //Configure ADC
-    adc1_config_width(_adc_width);
-    adc1_config_channel_atten(p_btn->channel, p_btn->atten);
-
-    //Characterize ADC
-    p_btn->p_adc_chars = calloc(1, sizeof(esp_adc_cal_characteristics_t));
-    if (NULL == p_btn->p_adc_chars)
+    if (ADC_CHANNEL_NUM <= _channel_num)
     {
-        return -1;
+        return NULL;
     }
 
-    esp_adc_cal_characterize(ADC_UNIT_1, p_btn->atten, _adc_width, ADC_DEFAULT_VREF, p_btn->p_adc_chars);
-    return 0;
-}
-
-static bool _is_button_pressed(button_adc_t *p_btn)
-{
-    if (NULL == p_btn)
+    if (BOARD_IO_ERR_NONE != board_io_ain_init(pin))
     {
-        return false;
+        return NULL;
     }
-    uint32_t voltage_mV = 0;
-    esp_adc_cal_get_voltage(p_btn->channel, p_btn->p_adc_chars, &voltage_mV);
-
-    return (_are_numbers_within_margin(voltage_mV, p_btn->active_voltage_level_mV, ADC_MARGIN_OF_ERR));
+    button_adc_channel_t *p_channel = &_channels[_channel_num];
+    p_channel->pin = pin;
+    p_channel->btn_num = 0;
+    _channel_num++;
+    return p_channel;
 }
 
-static button_adc_t *_button_alloc(void)
+static uint32_t _channel_read_mV(button_adc_channel_t *p_channel)
 {
-    return (button_adc_t *)malloc(sizeof(button_adc_t));
+    uint32_t raw[ADC_BURST_SAMPLES];
+    for (size_t loop = 0; loop < ADC_BURST_SAMPLES; loop++)
+    {
+        uint32_t value = board_io_ain_read_raw(p_channel->pin);
+
+        /* Insertion sort, the burst is short */
+        size_t pos = loop;
+        for (; (0u < pos) && (raw[pos - 1u] > value); pos--)
+        {
+            raw[pos] = raw[pos - 1u];
+        }
+        raw[pos] = value;
+    }
+    return board_io_ain_raw_to_mV(p_channel->pin, raw[ADC_BURST_SAMPLES / 2u]);
 }
 
-static void _button_free(button_adc_t *p_btn)
+static void _channel_classify(button_adc_channel_t *p_channel, uint32_t voltage_mV)
 {
-    if (NULL != p_btn)
+    button_adc_t *p_match = NULL;
+    uint32_t best_diff = ADC_MARGIN_OF_ERR;
+    for (size_t loop = 0; loop < p_channel->btn_num; loop++)
     {
-        _button_pointers[p_btn->label] = NULL;
-        free(p_btn);
+        uint32_t diff = _numbers_diff(voltage_mV, p_channel->p_btns[loop]->active_voltage_level_mV);
+        if (diff < best_diff)
+        {
+            best_diff = diff;
+            p_match = p_channel->p_btns[loop];
+        }
+    }
+    for (size_t loop = 0; loop < p_channel->btn_num; loop++)
+    {
+        p_channel->p_btns[loop]->b_is_pressed = (p_match == p_channel->p_btns[loop]);
     }
 }
 
-static inline bool _are_numbers_within_margin(uint32_t first, uint32_t second, uint32_t margin)
+static button_adc_t *_button_alloc(void)
 {
-    uint32_t diff = abs(first - second);
-    return ((diff < margin) ? true : false);
+    return (button_adc_t *)malloc(sizeof(button_adc_t));
 }
 
-static bool _is_rising_edge(button_adc_t *p_btn)
+static void _button_free(button_adc_t *p_btn)
 {
     if (NULL == p_btn)
     {
-        return false;
+        return;
     }
-    p_btn->b_was_pressed = p_btn->b_is_pressed;
-    p_btn->b_is_pressed = _is_button_pressed(p_btn);
-
-    return ((p_btn->b_was_pressed < p_btn->b_is_pressed) ? true : false);
-}
-
-static void adc_buttons_check_task (void const *p_argument)
-{
-    button_adc_t* p_btn = NULL;
-    for (;;)
+    button_adc_channel_t *p_channel = p_btn->p_channel;
+    for (size_t loop = 0; loop < p_channel->btn_num; loop++)
     {
-        for (size_t loop = 0; loop < ADC_BUTTON_NUM; loop++)
+        if (p_btn == p_channel->p_btns[loop])
         {
-            p_btn = _button_pointers[loop];
-            if (NULL == p_btn)
-            {
-                continue;
-            }
-            else if (p_btn->b_want_rising_edge && _is_rising_edge(p_btn))
-            {
-                _btn_cb_call(p_btn);
-            }
-            else if (!(p_btn->b_want_rising_edge) && _is_button_pressed(p_btn))
-            {
-                _btn_cb_call(p_btn);
-            }
+            p_channel->p_btns[loop] = p_channel->p_btns[--p_channel->btn_num];
+            break;
         }
-        vTaskDelay(30 / portTICK_RATE_MS);
     }
-    vTaskDelete(NULL);
+    free(p_btn);
 }
 
-static inline void _btn_cb_call(button_adc_t *p_btn)
+static inline uint32_t _numbers_diff(uint32_t first, uint32_t second)
 {
-    if (NULL != p_btn->btn_pressed_cb)
-    {
-        p_btn->btn_pressed_cb((void *)(&(p_btn->label)));
-    }
+    return ((first > second) ? (first - second) : (second - first));
 }
+
 //---------------------------- INTERRUPT HANDLERS -----------------------------
@@ -12,6 +12,7 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -19,12 +20,14 @@
 #include "freertos/semphr.h"
 #include "esp_log.h"
 #include "gui/screen_switching.h"
+#include "screens/screen_aasi.h"
 
 /* Littlevgl specific */
 #include "lvgl.h"
 #include "lvgl_helpers.h"
 //---------------------------------- MACROS -----------------------------------
 #define LV_TICK_PERIOD_MS 1
+#define GUI_MEM_MONITOR_WAIT_MS (20u)
 
 //-------------------------------- DATA TYPES ---------------------------------
 
@@ -49,8 +52,21 @@ static void guiTask(void *pvParameter);
  */
 static void gui_setup_screen(void);
 
+#if CONFIG_AASI_LATENCY_TRACE
+/**
+ * It flushes the area to the display and tells the game latency tracer once the
+ * last area of a frame has been sent
+ * 
+ * @param p_drv The display driver.
+ * @param p_area The area to flush.
+ * @param p_color_map The pixels of the area.
+ */
+static void gui_flush(lv_disp_drv_t *p_drv, const lv_area_t *p_area, lv_color_t *p_color_map);
+#endif
+
 //------------------------- STATIC DATA & CONSTANTS ---------------------------
 static SemaphoreHandle_t xGuiSemaphore;
+static TaskHandle_t task_gui_hndl = NULL;
 
 lv_obj_t * screen;
 lv_obj_t * label1;
@@ -63,13 +79,13 @@ void gui_init()
  /* If you want to use a task to create the graphic, you NEED to create a Pinned task
      * Otherwise there can be problem such as memory corruption and so on.
      * NOTE: When not using Wi-Fi nor Bluetooth you can pin the guiTask to core 0 */
-    xTaskCreatePinnedToCore(guiTask, "gui", 1024*10, NULL, 0, NULL, 1);
+    xTaskCreatePinnedToCore(guiTask, "gui", 1024*10, NULL, 0, &task_gui_hndl, 1);
 }
 
 void gui_printf_update(void ** label, const char * text, uint16_t x, uint16_t y,
                             lv_color_t obj_color)
 {
-    screen = screen_aasi_screen_get();
+    screen = screen_aasi_game_layer_get();
     /*Enable re-coloring by commands in the text*/
     lv_obj_t * label1 = *label;
     if (!label1) {
@@ -78,9 +94,14 @@ void gui_printf_update(void ** label, const char * text, uint16_t x, uint16_t y,
         lv_style_set_text_color(&style1, LV_STATE_DEFAULT, obj_color);
         lv_style_set_text_font(&style1, LV_STATE_DEFAULT, &lv_font_unscii_8);
         lv_obj_add_style(label1, LV_LABEL_PART_MAIN, &style1);  
+    } else if (0 != strcmp(lv_label_get_text(label1), text)) {
+        /* Objects clipped at the viewport edge are drawn with part of their shape */
+        lv_label_set_text(label1, text);
+    }
+    /* Setting the text or the position invalidates what changed, an unchanged label is not redrawn */
+    if ((lv_obj_get_x(label1) != (lv_coord_t)x) || (lv_obj_get_y(label1) != (lv_coord_t)y)) {
+        lv_obj_set_pos(label1, x, y);
     }
-    lv_obj_set_pos(label1, x, y);
-    lv_obj_invalidate(label1);
     *label = label1;
 }
 
@@ -102,12 +123,43 @@ void * gui_create_label(void)
 {
     return lv_label_create(NULL, NULL);
 }
+
+bool gui_mem_monitor(lv_mem_monitor_t *p_mon)
+{
+    /* The heap walk must not race the GUI task, the lock is only held for the walk */
+    if ((NULL == xGuiSemaphore) ||
+        (pdTRUE != xSemaphoreTake(xGuiSemaphore, GUI_MEM_MONITOR_WAIT_MS / portTICK_PERIOD_MS)))
+    {
+        return false;
+    }
+    lv_mem_monitor(p_mon);
+    xSemaphoreGive(xGuiSemaphore);
+    return true;
+}
+
+TaskHandle_t gui_get_task_handle(void)
+{
+    return task_gui_hndl;
+}
 //---------------------------- PRIVATE FUNCTIONS ------------------------------
 static void gui_setup_screen(void)
 {
     screen_main_menu_switch();
 }
 
+#if CONFIG_AASI_LATENCY_TRACE
+static void gui_flush(lv_disp_drv_t *p_drv, const lv_area_t *p_area, lv_color_t *p_color_map)
+{
+    /* Read before flushing, the driver may mark the area ready right away */
+    bool b_is_last = lv_disp_flush_is_last(p_drv);
+    disp_driver_flush(p_drv, p_area, p_color_map);
+    if (b_is_last)
+    {
+        screen_aasi_frame_flushed();
+    }
+}
+#endif
+
 static void lv_tick_timer(void *arg) {
     (void) arg;
 
@@ -138,7 +190,11 @@ static void guiTask(void *pvParameter) {
 
     lv_disp_drv_t disp_drv;
     lv_disp_drv_init(&disp_drv);
+#if CONFIG_AASI_LATENCY_TRACE
+    disp_drv.flush_cb = gui_flush;
+#else
     disp_drv.flush_cb = disp_driver_flush;
+#endif
 
     disp_drv.buffer = &disp_buf;
     lv_disp_drv_register(&disp_drv);
@@ -16,6 +16,8 @@ extern "C" {
 
 //--------------------------------- INCLUDES ----------------------------------
 #include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 /* Littlevgl specific */
 #include "lvgl.h"
@@ -130,8 +132,8 @@ extern "C" {
 void gui_init(void);
 
 /**
- * This function creates a label object, sets the text, sets the color, sets the font, sets the
- * position, and invalidates the object
+ * This function creates a label object, sets the text, sets the color, sets the font and sets the
+ * position. Only a label whose text or position changed is redrawn.
  * 
  * @param label A pointer to the label object. If it's NULL, a new label will be created.
  * @param text The text to display
@@ -161,6 +163,22 @@ void gui_clear_screen(void);
  */
 void * gui_create_label(void);
 
+/**
+ * It reads the usage of the LVGL heap, between two runs of the GUI task.
+ * 
+ * @param p_mon The usage.
+ * 
+ * @return true if it was read, false if the GUI is not up or stays busy.
+ */
+bool gui_mem_monitor(lv_mem_monitor_t *p_mon);
+
+/**
+ * It returns the GUI task.
+ * 
+ * @return The handle of the task, NULL before gui_init.
+ */
+TaskHandle_t gui_get_task_handle(void);
+
 /* private functions */
 void screen_menu_update_status_bar();
 
@@ -62,6 +62,13 @@ lv_obj_t* screen_aasi_screen_get();
  */
 lv_obj_t* screen_aasi_label_get();
 
+/**
+ * Returns the container that holds all objects drawn by the AASI game.
+ * 
+ * @return A pointer to the game layer object.
+ */
+lv_obj_t* screen_aasi_game_layer_get();
+
 /* private usage */
 /**
  * It reads or writes a uint8_t value to NVS, and returns the value read
@@ -84,32 +91,35 @@ uint8_t nvs_readwrite_u8(const char *p_key, bool b_want_to_read,
 bool is_wifi_connected();
 
 /**
- * It returns a pointer to a string containing the name of the current host system
+ * It copies the high score and the name of the highscorer, always a pair that was
+ * set together. It never waits, from any task.
  * 
- * @return The address of the first character in the hs_name_buf array.
- */
-char *get_hs_name(void);
-
-/**
- * This function returns the value of the high_score variable.
+ * @param p_name The buffer for the name, NULL if only the score is needed.
+ * @param name_size The size of the buffer.
  * 
  * @return The high score.
  */
-unsigned long get_high_score(void);
+unsigned long get_high_score_entry(char *p_name, size_t name_size);
 
 /**
- * This function sets the highscorer name
+ * This function returns the value of the high score.
  * 
- * @param p_name The name of the highscorer.
+ * @return The high score.
  */
-void set_hs_name(char *p_name);
+unsigned long get_high_score(void);
 
 /**
- * This function sets the high score to the value passed in.
+ * It sets the high score and the name of the highscorer together, if the score
+ * beats the current one.
  * 
  * @param hs The high score to set.
+ * @param p_name The name of the highscorer, not terminated.
+ * @param name_len The length of the name.
+ * @param b_or_equal true if an equal score replaces the current one too.
+ * 
+ * @return true if the high score was set.
  */
-void set_high_score(unsigned long hs);
+bool set_high_score_if_better(unsigned long hs, const char *p_name, size_t name_len, bool b_or_equal);
 
 #ifdef __cplusplus
 }
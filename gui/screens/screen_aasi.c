@@ -10,34 +10,48 @@
 //--------------------------------- INCLUDES ----------------------------------
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdatomic.h>
 #include "screen_aasi.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include "esp_timer.h"
 #include "gui/screen_switching.h"
 #include "aasi/game.h"
 #include "aasi/display.h"
+#include "aasi/profiler.h"
+#include "aasi/histogram.h"
+#include "aasi/spectator.h"
+#include "aasi/remote.h"
+#include "aasi/latency.h"
+#include "leaderboard.h"
 //---------------------------------- MACROS -----------------------------------
 #define  aasi_game_init_THREAD_STACK_SIZE      (5u * 1024u)
 #define  aasi_game_init_THREAD_PRIORITY        (tskIDLE_PRIORITY + 5u)
-#define  aasi_key_handle_THREAD_STACK_SIZE     (3u * 1024u)
-#define  aasi_key_handle_THREAD_PRIORITY       (tskIDLE_PRIORITY + 4u)
-#define  button_gpio_check_THREAD_STACK_SIZE   (3u * 1024u)
-#define  button_gpio_check_THREAD_PRIORITY     (tskIDLE_PRIORITY + 4u)
 #define  screen_switch_THREAD_STACK_SIZE       (4u * 1024u)
 #define  screen_switch_THREAD_PRIORITY         (tskIDLE_PRIORITY + 4u)
 #define  AASI_GAME_USED_BUTTONS_NUM            (4u)
-#define  AASI_GAME_KEY_POOL_DELAY_MS           (300u)
-#define  aasi_key_handle_QUEUE_LEN             (100u)
-#define  button_gpio_check_QUEUE_LEN           (5u)
+#define  AASI_GAME_KEY_REPEAT_MS               (300u) /* key repeat of the game in wall time */
 #define  OWNER_NAME                            "Marko"
-#define  MQTT_OWNER_NAME                       ",Marko"
 #define  ANIMATION_MS                          (800u)
+#define  AASI_PACING_INTERVAL_SHIFT            (10u) /* ~1 ms buckets */
+#define  AASI_PACING_LAG_SHIFT                 (8u)  /* 256 us buckets, a tick is 10 ms */
+#define  AASI_PACING_PERIOD_US                 ((int64_t) portTICK_PERIOD_MS * 1000)
+#define  AASI_LATENCY_SHIFT                    (11u) /* ~2 ms buckets */
 //-------------------------------- DATA TYPES ---------------------------------
 typedef struct {
 	aasi_display_t base;
 } lvdisplay_t;
 
+typedef struct {
+    aasi_hist_t interval_us; /* wall time between successive aasi_game_task calls */
+    aasi_hist_t lag_us;      /* start of an iteration behind its slot start_us + n * period */
+    int64_t     start_us;
+    int64_t     last_us;
+    uint32_t    slot;        /* n of the slot the next iteration is due in */
+    uint32_t    missed;      /* slots skipped because an iteration ran a period late */
+} aasi_pacing_t;
+
 //---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
 /**
  * This function returns a pointer to the label object that is used to display the AASI game
@@ -54,20 +68,6 @@ static lv_obj_t* _screen_aasi_screen_get();
 static lv_obj_t* _screen_aasi_label_get();
 static void aasi_game_init_task(void const *p_argument);
 
-/**
- * It receives button presses from the queue and passes them to the game
- * 
- * @param p_argument This is the argument passed to the task when it was created.
- */
-static void aasi_key_handle_task(void const *p_argument);
-
-/**
- * It waits for a button press, then sends the button number to the game task
- * 
- * @param p_argument The parameter passed to the task when the task is created.
- */
-static void button_gpio_check_task(void const *p_argument);
-
 /**
  * It's a task that switches to the main menu screen
  * 
@@ -92,6 +92,13 @@ static bool _lvdisplay_init(lvdisplay_t *this);
  */
 static void _lvdisplay_objdel(aasi_display_t *base, void **priv);
 
+/**
+ * Function that deletes all labels of the game in one clean of the game layer.
+ * 
+ * @param base The base display object.
+ */
+static void _lvdisplay_clear(aasi_display_t *base);
+
 /**
  * This function is called by the AASI library to display a string of 
  *      characters on the screen
@@ -113,35 +120,28 @@ static void _lvdisplay_mvputs(aasi_display_t *base, void **priv,
 static unsigned int _esp_random_provider();
 
 /**
- * It checks if the button pressed is the die button, and if so, it sends the button label to the
- * aasi_key_handle_queue. 
- * 
- * If the die button is not pressed, it checks if the task_button_gpio_check_hndl is NULL. If it is, it
- * creates a new queue and task to handle the button press. 
- * 
- * If the task_button_gpio_check_hndl is not NULL, it sends the button label to the
- * button_gpio_check_queue.
- * 
- * @param p_param This is the parameter that is passed to the callback function. In this case, it is
- * the label of the button that was pressed.
+ * It subscribes to the buttons used in game. Held buttons other than die repeat
+ * at the key repeat rate of the game.
  */
-static void _btn_gpio_callback(void *p_param);
+static void _aasi_buttons_subscribe(void);
 
 /**
- * This function is called when a button is pressed. It sends the button label to the queue
+ * It posts the mapped keys of the queued button presses and repeats to the game 
+ * input mailbox.
  * 
- * @param p_param The parameter passed to the callback function.
- * 
- * @return The button label.
+ * @param p_current The running game.
  */
-static void _btn_adc_callback(void *p_param);
+static void _aasi_buttons_handle(aasi_game_t *p_current);
 
 /**
- * This function is called when the user presses the button but it does nothing
+ * It dispatches the keys the last tick applied to the latency tracer or the
+ * remote controller they were posted by, and marks the traced presses as drawn 
+ * if the tick rendered.
  * 
- * @param p_param This is a pointer to the parameter that was passed to the button when it was created.
+ * @param p_current The running game.
+ * @param tick_us The time the tick started at.
  */
-static void _btn_empty_callback(void *p_param);
+static void _aasi_applied_keys_handle(aasi_game_t *p_current, int64_t tick_us);
 
 /**
  * Sets the background opacity of the object to the value of the animation
@@ -159,20 +159,96 @@ static void opa_anim(void *p_bg, lv_anim_value_t v);
  * @return The high score.
  */
 static unsigned long _aasi_get_high_score(void);
+
+/**
+ * Clears the frame pacing histograms at the start of a game.
+ * 
+ * @param p_pacing The pacing record to reset.
+ */
+static void _aasi_pacing_reset(aasi_pacing_t *p_pacing);
+
+/**
+ * Records one iteration of the game loop into the frame pacing histograms.
+ * 
+ * @param p_pacing The pacing record to update.
+ * 
+ * @return Wall time in microseconds since the previous iteration.
+ */
+static uint32_t _aasi_pacing_update(aasi_pacing_t *p_pacing);
+
+/**
+ * It takes a reference to the running game, the game is not deleted before
+ *      the reference is released. Other tasks use the game only through it.
+ * 
+ * @return The game, NULL if no game runs (there is nothing to release then).
+ */
+static aasi_game_t *_aasi_game_acquire(void);
+
+/**
+ * It releases the reference taken by _aasi_game_acquire().
+ */
+static void _aasi_game_release(void);
+
+/**
+ * It unpublishes the game and waits until no other task holds a reference to
+ *      it, the game task can delete it afterwards.
+ */
+static void _aasi_game_retire(void);
+
+#if CONFIG_AASI_REMOTE
+/**
+ * It posts a key event received on the remote controller topic to the game.
+ * 
+ * @param p_data The event.
+ * @param len The length of the event.
+ */
+static void _remote_on_event(const uint8_t *p_data, int len);
+
+/**
+ * It publishes the acknowledgement of a remote key event.
+ * 
+ * @param p_priv Unused.
+ * @param p_msg The acknowledgement.
+ * @param len The length of the acknowledgement.
+ * 
+ * @return true if the acknowledgement was queued.
+ */
+static bool _remote_ack(void *p_priv, const char *p_msg, size_t len);
+#endif
+
+#if CONFIG_AASI_SPECTATOR
+/**
+ * It queues a spectator packet on the telemetry client.
+ * 
+ * @param p_priv Unused.
+ * @param p_data The packet.
+ * @param len The length of the packet.
+ * 
+ * @return true if the packet was queued.
+ */
+static bool _spectator_publish(void *p_priv, const uint8_t *p_data, size_t len);
+
+/**
+ * It returns how many bytes the telemetry client still has to send.
+ * 
+ * @param p_priv Unused.
+ * 
+ * @return The size of the MQTT outbox.
+ */
+static int _spectator_backlog(void *p_priv);
+#endif
 //------------------------- STATIC DATA & CONSTANTS ---------------------------
 static bool b_is_screen_init = false;
 static bool b_is_aasi_running = false;
 static TaskHandle_t task_aasi_game_init_hndl  = NULL;
-static TaskHandle_t task_aasi_key_handle_hndl  = NULL;
-static TaskHandle_t task_button_gpio_check_hndl  = NULL;
 static TaskHandle_t task_screen_switch_hndl  = NULL;
-static QueueHandle_t aasi_key_handle_queue = NULL;
-static QueueHandle_t button_gpio_check_queue = NULL;
 static lv_obj_t *p_label1;
 static lv_style_t style1;
 static lv_style_t style_status_bar;
 static lv_style_t style_status_bar_info;
 static lv_obj_t *p_screen;
+static lv_obj_t *p_game_layer;
+static void *p_game_arena = NULL;
 static lv_obj_t *p_obj_status_bar;
 static lv_obj_t *p_label_status_bar;
 static lv_obj_t *p_label_status_bar_info;
@@ -185,12 +261,25 @@ static lv_style_t style_modal;
 
 static uint8_t _num_of_aliens = 2;
 static uint8_t _num_of_blocks = 3;
+static uint8_t _world_scale = 1;
 static lv_color_t _game_color = LV_COLOR_WHITE;
 static lv_color_t _object_color = LV_COLOR_BLACK;
+static aasi_pacing_t _pacing;
+static atomic_uint _game_users = 0u;
+#if CONFIG_AASI_SPECTATOR
+static aasi_spec_t _spectator;
+#endif
+#if CONFIG_AASI_REMOTE
+static aasi_remote_t _remote;
+#endif
+#if CONFIG_AASI_LATENCY_TRACE
+static aasi_lat_t _latency;
+#endif
 
 static const aasi_display_ops_t ncdisplay_ops = {
     .mvputs = _lvdisplay_mvputs,
     .objdel = _lvdisplay_objdel,
+    .clear  = _lvdisplay_clear,
 };
 
 static const aasi_button_t _button_map[BUTTON_COUNT] = {
@@ -209,16 +298,15 @@ static const aasi_button_t _button_map[BUTTON_COUNT] = {
     AASI_GAME_KEY_NOT_MAPPED, /* BUTTON_MENU */
 };
 
-#if 0
 static const button_t _used_buttons[AASI_GAME_USED_BUTTONS_NUM] = {
     BUTTON_LEFT,
     BUTTON_RIGHT,
     BUTTON_A,
     BUTTON_B,
 };
-#endif
 //------------------------------- GLOBAL DATA ---------------------------------
-aasi_game_t *p_game = NULL;
+/* Owned by the game task, other tasks go through _aasi_game_acquire() */
+aasi_game_t *_Atomic p_game = NULL;
 //------------------------------ PUBLIC FUNCTIONS -----------------------------
 void screen_aasi_game_switch(void)
 {
@@ -236,10 +324,25 @@ void screen_aasi_game_switch(void)
         lv_obj_align(p_label1, NULL, LV_ALIGN_IN_TOP_LEFT, 0, 0);
         lv_label_set_text(p_label1, "");
 
+        p_game_layer = lv_obj_create(p_screen, NULL);
+        lv_obj_set_style_local_bg_opa(p_game_layer, LV_OBJ_PART_MAIN, LV_STATE_DEFAULT, LV_OPA_TRANSP);
+        lv_obj_set_style_local_border_width(p_game_layer, LV_OBJ_PART_MAIN, LV_STATE_DEFAULT, 0);
+        lv_obj_set_pos(p_game_layer, 0, 0);
+        lv_obj_set_size(p_game_layer, LV_HOR_RES, LV_VER_RES);
+
         lv_style_init(&style_modal);
         lv_style_set_bg_color(&style_modal, LV_STATE_DEFAULT, 
                                 LV_COLOR_MAKE(0x31, 0x0A, 0x91));
 
+#if CONFIG_AASI_REMOTE
+        /* Remote events index the same map as the physical buttons */
+        aasi_remote_init(&_remote, _button_map, BUTTON_COUNT, _remote_ack, NULL);
+        telemetry_subscribe(MQTT_CONTROL_TOPIC, _remote_on_event);
+#endif
+#if CONFIG_AASI_LATENCY_TRACE
+        aasi_lat_init(&_latency, AASI_LATENCY_SHIFT);
+#endif
+
         b_is_screen_init = true;
     }
     lv_obj_t *p_anim_obj = lv_obj_create(p_screen, NULL);
@@ -315,6 +418,11 @@ void aasi_game_set_blocks(uint8_t num_of_blocks)
     _num_of_blocks = num_of_blocks;
 }
 
+void aasi_game_set_world_scale(uint8_t world_scale)
+{
+    _world_scale = (0u == world_scale) ? 1u : world_scale;
+}
+
 void aasi_game_set_game_color(lv_color_t game_color)
 {
     _game_color = game_color;
@@ -334,76 +442,185 @@ lv_obj_t* screen_aasi_label_get()
 {
     return _screen_aasi_label_get();
 }
+
+lv_obj_t* screen_aasi_game_layer_get()
+{
+    return p_game_layer;
+}
+
+const aasi_hist_t *screen_aasi_get_tick_interval_hist(void)
+{
+    return &_pacing.interval_us;
+}
+
+const aasi_hist_t *screen_aasi_get_tick_lag_hist(void)
+{
+    return &_pacing.lag_us;
+}
+
+TaskHandle_t screen_aasi_get_task_handle(void)
+{
+    return task_aasi_game_init_hndl;
+}
+
+const aasi_lat_t *aasi_game_get_latency(void)
+{
+#if CONFIG_AASI_LATENCY_TRACE
+    return &_latency;
+#else
+    return NULL;
+#endif
+}
+
+void screen_aasi_frame_flushed(void)
+{
+#if CONFIG_AASI_LATENCY_TRACE
+    aasi_lat_flushed(&_latency, esp_timer_get_time());
+#endif
+}
+
+#if CONFIG_AASI_DISPLAY_STATIC
+void aasi_display_backend_mvclr(aasi_display_t *base, void **priv, int y, int x, const char *s)
+{
+    /* labels are moved by mvputs, nothing to clear */
+}
+
+void aasi_display_backend_mvputs(aasi_display_t *base, void **priv, int y, int x, const char *s)
+{
+    _lvdisplay_mvputs(base, priv, y, x, s);
+}
+
+void aasi_display_backend_objdel(aasi_display_t *base, void **priv)
+{
+    _lvdisplay_objdel(base, priv);
+}
+
+void aasi_display_backend_clear(aasi_display_t *base)
+{
+    _lvdisplay_clear(base);
+}
+
+void aasi_display_backend_present(aasi_display_t *base)
+{
+    /* LVGL refreshes the screen from its own task */
+}
+#endif
 //---------------------------- PRIVATE FUNCTIONS ------------------------------
 static void aasi_game_init_task(void const *p_argument)
 {
     unsigned long start;
-    NEW_QUEUE(aasi_key_handle, uint8_t);
+    aasi_game_t *p_current;
     for (;;)
     {
         lvdisplay_t display;
         _lvdisplay_init(&display);
 
-        p_game = aasi_game_new(&display.base, _num_of_aliens, _num_of_blocks);
-        if (NULL == p_game)
+        if (NULL == p_game_arena)
+        {
+            /* Allocated once and reused by every game, games never touch the heap */
+            p_game_arena = malloc(aasi_game_arena_size());
+        }
+        p_current = aasi_game_new_in_arena(p_game_arena, aasi_game_arena_size(), &display.base, 
+                                        aasi_display_width(&display.base) * _world_scale,
+                                        aasi_display_height(&display.base),
+                                        _num_of_aliens, _num_of_blocks, _esp_random_provider);
+        if (NULL == p_current)
         {
             printf("Game could not be created\n");
         }
         else
         {
-            // Initialize buttons used in game
-            if ((BUTTON_ERR_NONE != button_init(BUTTON_UP, _btn_empty_callback, true))
-            || (BUTTON_ERR_NONE != button_init(BUTTON_DOWN, _btn_empty_callback, true))
-            || (BUTTON_ERR_NONE != button_init(BUTTON_LEFT, _btn_adc_callback, false)) 
-            || (BUTTON_ERR_NONE != button_init(BUTTON_RIGHT, _btn_adc_callback, false))
-            || (BUTTON_ERR_NONE != button_init(BUTTON_A, _btn_gpio_callback, NULL)) 
-            || (BUTTON_ERR_NONE != button_init(BUTTON_B, _btn_gpio_callback, NULL))
-            || (BUTTON_ERR_NONE != button_init(BUTTON_SELECT, _btn_empty_callback, NULL)))
+            _aasi_buttons_subscribe();
+
+#if CONFIG_AASI_SPECTATOR
+            aasi_spec_config_t spec_cfg;
+            aasi_spec_default_config(&spec_cfg);
+            bool b_spectated = aasi_spec_init(&_spectator, &spec_cfg, aasi_display_width(&display.base), 
+                                              aasi_display_height(&display.base), 
+                                              _spectator_publish, _spectator_backlog, NULL);
+            if (!b_spectated)
             {
-                printf("Some button(s) not initialized\n");
-            }
-            
-            aasi_game_set_random_provider(p_game, _esp_random_provider);
-            if (NULL == task_aasi_key_handle_hndl)
-            {
-                NEW_TASK(aasi_key_handle, NULL);
-            }
-            else
-            {
-                xQueueReset(aasi_key_handle_queue);
-                vTaskResume(task_aasi_key_handle_hndl);
+                printf("Game is played without spectators\n");
             }
+#endif
+            atomic_store(&p_game, p_current);
             start = xTaskGetTickCount();
+            _aasi_pacing_reset(&_pacing);
             b_is_aasi_running = true;
-            while (aasi_game_is_running(p_game))
+            while (aasi_game_is_running(p_current))
             {
-                aasi_game_task(p_game, ((xTaskGetTickCount() - start) * portTICK_PERIOD_MS) / GAME_SPEED_FACTOR);
+                unsigned long game_ms = (xTaskGetTickCount() - start) * portTICK_PERIOD_MS;
+                (void) _aasi_pacing_update(&_pacing);
+                int64_t work_us = esp_timer_get_time();
+                _aasi_buttons_handle(p_current);
+                int64_t tick_us = esp_timer_get_time();
+                aasi_game_task(p_current, game_ms / GAME_SPEED_FACTOR);
+                _aasi_applied_keys_handle(p_current, tick_us);
+#if CONFIG_AASI_SPECTATOR
+                if (b_spectated)
+                {
+                    aasi_spec_frame(&_spectator, p_current, game_ms);
+                }
+#endif
+                /* The governor budgets the work of the frame, not the wait for the next tick */
+                aasi_game_report_frame_time(p_current, (uint32_t) (esp_timer_get_time() - work_us));
                 vTaskDelay(1);
             }
             b_is_aasi_running = false;
-            if (AASI_GAME_WINNER_HERO == aasi_game_get_winner(p_game))
+            aasi_game_dump_profile(p_current);
+            aasi_game_dump_governor(p_current);
+            aasi_hist_print(&_pacing.interval_us, "aasi tick interval [us]");
+            aasi_hist_print(&_pacing.lag_us, "aasi tick lag [us]");
+            printf("aasi tick slots missed: %u\n", (unsigned) _pacing.missed);
+#if CONFIG_AASI_SPECTATOR
+            if (b_spectated)
             {
-                char p_buf[30];
-                unsigned long hi_score = _aasi_get_high_score();
-                itoa(hi_score, p_buf, 10);
-                strcat(p_buf, MQTT_OWNER_NAME);
-
-                if (get_high_score() < hi_score)
-                {
-                    set_high_score(hi_score);
-                    set_hs_name(OWNER_NAME);
-                    telemetry_connection_status_update(p_buf, 1);
-                }
-                else
+                aasi_spec_print(&_spectator, "aasi spectator");
+            }
+#endif
+#if CONFIG_AASI_REMOTE
+            aasi_remote_print(&_remote, "aasi remote");
+#endif
+#if CONFIG_AASI_LATENCY_TRACE
+            aasi_lat_abort(&_latency);
+            aasi_lat_print(&_latency, "aasi input latency");
+#endif
+            aasi_game_winner_t winner = aasi_game_get_winner(p_current);
+            if (AASI_GAME_WINNER_NO_ONE != winner)
+            {
+                telemetry_report_t report = {
+                    .score       = ((AASI_GAME_WINNER_HERO == winner) ? (_aasi_get_high_score()) : (0u)),
+                    .duration_ms = aasi_game_get_duration_ms(p_current) * GAME_SPEED_FACTOR,
+                    .aliens      = aasi_game_get_alien_count(p_current),
+                    .blocks      = aasi_game_get_block_count(p_current),
+                    .winner      = winner,
+                    .p_owner     = OWNER_NAME,
+                    .owner_len   = sizeof(OWNER_NAME) - 1u,
+                };
+                /* Only a new high score is retained, the broker keeps the best one */
+                if (0u != report.score)
                 {
-                    telemetry_connection_status_update(p_buf, 0);
+                    (void)leaderboard_submit(report.score, report.duration_ms, OWNER_NAME,
+                                             sizeof(OWNER_NAME) - 1u);
                 }
+                bool b_high_score = ((0u != report.score) &&
+                                     set_high_score_if_better(report.score, OWNER_NAME, sizeof(OWNER_NAME) - 1u, false));
+                telemetry_send_report(&report, b_high_score);
+            }
+            if (0u != aasi_game_get_dropped_keys(p_current))
+            {
+                printf("aasi input mailbox dropped %u keys\n", aasi_game_get_dropped_keys(p_current));
             }
-            if (NULL != task_aasi_key_handle_hndl)
+            if (0u != button_get_dropped_events())
             {
-                vTaskSuspend(task_aasi_key_handle_hndl);
+                printf("button event queue dropped %u events\n", button_get_dropped_events());
             }
-            aasi_game_delete(p_game);
+            _aasi_game_retire();
+#if CONFIG_AASI_REMOTE
+            /* Nothing posts to the game anymore, what is left in the mailbox is refused */
+            aasi_remote_abort(&_remote);
+#endif
+            aasi_game_delete(p_current);
             if (NULL == task_screen_switch_hndl)
             {
                 NEW_TASK(screen_switch, NULL);
@@ -419,132 +636,172 @@ static void aasi_game_init_task(void const *p_argument)
 
 static unsigned long _aasi_get_high_score(void)
 {
-    if (NULL == p_game) return (30UL * 1000UL);
-    return ((30UL * 1000UL) - (aasi_game_get_duration_ms(p_game) * GAME_SPEED_FACTOR));
+    aasi_game_t *p_current = _aasi_game_acquire();
+    if (NULL == p_current) return (30UL * 1000UL);
+    unsigned long score = ((30UL * 1000UL) - (aasi_game_get_duration_ms(p_current) * GAME_SPEED_FACTOR));
+    _aasi_game_release();
+    return score;
 }
 
-static void aasi_key_handle_task(void const *p_argument)
+static aasi_game_t *_aasi_game_acquire(void)
 {
-    uint8_t qdata = BUTTON_COUNT;
-    bool b_is_fire_pressed = false;
-    bool b_is_die_pressed = false;
-    bool b_is_right_pressed = false;
-    bool b_is_left_pressed = false;
-    for (;;)
+    /* Both are sequentially consistent: either the game task sees the user or the user sees NULL */
+    atomic_fetch_add(&_game_users, 1u);
+    aasi_game_t *p_current = atomic_load(&p_game);
+    if (NULL == p_current)
     {
-        b_is_fire_pressed = false;
-        b_is_die_pressed = false;
-        b_is_right_pressed = false;
-        b_is_left_pressed = false;
-        while ((NULL != aasi_key_handle_queue)
-            && (pdTRUE == xQueueReceive(aasi_key_handle_queue, &qdata, 0))
-            && !(b_is_die_pressed) 
-            && !(b_is_fire_pressed && (b_is_left_pressed || b_is_right_pressed)))
-        {
-            aasi_button_t aasi_btn = _button_map[qdata];
-            switch (aasi_btn)
-            {
-                case AASI_GAME_KEY_FIRE:
-                    if (!b_is_fire_pressed)
-                    {
-                        b_is_fire_pressed = true;
-                        aasi_game_handle_key(p_game, AASI_GAME_KEY_FIRE);
-                    }
-                break;
-
-                case AASI_GAME_KEY_LEFT:
-                    if (!b_is_left_pressed)
-                    {
-                        b_is_left_pressed = true;
-                        aasi_game_handle_key(p_game, AASI_GAME_KEY_LEFT);
-                    }
-                break;
-
-                case AASI_GAME_KEY_RIGHT:
-                    if (!b_is_right_pressed)
-                    {
-                        b_is_right_pressed = true;
-                        aasi_game_handle_key(p_game, AASI_GAME_KEY_RIGHT);
-                    }
-                break;
-
-                case AASI_GAME_KEY_DIE:
-                    if (!b_is_die_pressed)
-                    {
-                        b_is_die_pressed = true;
-                        aasi_game_handle_key(p_game, AASI_GAME_KEY_DIE);
-                    }
-                break;
-
-                default:
-                break;
-            }
-        }
-        xQueueReset(aasi_key_handle_queue);
-        vTaskDelay(AASI_GAME_KEY_POOL_DELAY_MS / portTICK_PERIOD_MS);
+        atomic_fetch_sub(&_game_users, 1u);
     }
-    vTaskDelete(NULL);
+    return p_current;
 }
 
-static void screen_switch_task(void const *p_argument)
+static void _aasi_game_release(void)
 {
-    for (;;)
+    atomic_fetch_sub(&_game_users, 1u);
+}
+
+static void _aasi_game_retire(void)
+{
+    atomic_store(&p_game, NULL);
+    /* A user only holds the game for one call, a tick is plenty */
+    while (0u != atomic_load(&_game_users))
     {
-        screen_main_menu_switch();
-        vTaskSuspend(NULL);
+        vTaskDelay(1);
     }
 }
 
-static void _btn_gpio_callback(void *p_param)
+#if CONFIG_AASI_REMOTE
+static void _remote_on_event(const uint8_t *p_data, int len)
 {
-    uint8_t *p_btn_label = (uint8_t *) p_param;
-    if (AASI_GAME_KEY_DIE == _button_map[(*p_btn_label)])
+    /* A NULL game makes it refuse the event */
+    aasi_game_t *p_current = _aasi_game_acquire();
+    aasi_remote_on_event(&_remote, p_current, p_data, len);
+    if (NULL != p_current)
     {
-        xQueueSendFromISR(aasi_key_handle_queue, p_btn_label, NULL);
+        _aasi_game_release();
     }
-    else if (NULL == task_button_gpio_check_hndl)
+}
+
+static bool _remote_ack(void *p_priv, const char *p_msg, size_t len)
+{
+    return (TELEMETRY_OK == telemetry_publish(MQTT_CONTROL_ACK_TOPIC, p_msg, len, 0, false));
+}
+#endif
+
+#if CONFIG_AASI_SPECTATOR
+static bool _spectator_publish(void *p_priv, const uint8_t *p_data, size_t len)
+{
+    return (TELEMETRY_OK == telemetry_publish(MQTT_SPECTATOR_TOPIC, p_data, len, 0, false));
+}
+
+static int _spectator_backlog(void *p_priv)
+{
+    return telemetry_outbox_size();
+}
+#endif
+
+static void _aasi_pacing_reset(aasi_pacing_t *p_pacing)
+{
+    aasi_hist_init(&p_pacing->interval_us, AASI_PACING_INTERVAL_SHIFT);
+    aasi_hist_init(&p_pacing->lag_us, AASI_PACING_LAG_SHIFT);
+    p_pacing->start_us = esp_timer_get_time();
+    p_pacing->last_us = p_pacing->start_us;
+    p_pacing->slot = 0u;
+    p_pacing->missed = 0u;
+}
+
+static uint32_t _aasi_pacing_update(aasi_pacing_t *p_pacing)
+{
+    int64_t now_us = esp_timer_get_time();
+    uint32_t interval_us = (uint32_t) (now_us - p_pacing->last_us);
+    if (0u != interval_us)
     {
-        NEW_QUEUE(button_gpio_check, uint8_t);
-        xQueueSendFromISR(button_gpio_check_queue, p_btn_label, NULL);
-        NEW_TASK(button_gpio_check, NULL);
+        aasi_hist_add(&p_pacing->interval_us, interval_us);
     }
-    else
+    p_pacing->last_us = now_us;
+
+    /* The tick count only moves in whole periods, the ideal schedule does not */
+    int64_t lag_us = (now_us - p_pacing->start_us) - ((int64_t) p_pacing->slot * AASI_PACING_PERIOD_US);
+    aasi_hist_add(&p_pacing->lag_us, (lag_us > 0) ? (uint32_t) lag_us : 0u);
+    p_pacing->slot++;
+    if (AASI_PACING_PERIOD_US <= lag_us)
     {
-        xQueueSendFromISR(button_gpio_check_queue, p_btn_label, NULL);
+        /* Late by whole slots, move on to the current one so one stall is not counted by every later tick */
+        uint32_t skipped = (uint32_t) (lag_us / AASI_PACING_PERIOD_US);
+        p_pacing->missed += skipped;
+        p_pacing->slot += skipped;
     }
+    return interval_us;
 }
 
-static void _btn_adc_callback(void *p_param)
+static void screen_switch_task(void const *p_argument)
 {
-    if (NULL == p_param || NULL == aasi_key_handle_queue)
+    for (;;)
     {
-        return;
+        screen_main_menu_switch();
+        vTaskSuspend(NULL);
     }
-    uint8_t *p_btn_label = (uint8_t *) p_param;
-    static uint8_t data = BUTTON_COUNT;
-    data = *p_btn_label;
-    xQueueSend(aasi_key_handle_queue, &data, 0);
 }
 
-static void button_gpio_check_task(void const *p_argument)
+static void _aasi_buttons_subscribe(void)
 {
-    uint8_t qdata = BUTTON_COUNT;
-    for (;;)
+    uint32_t mask = 0;
+    for (size_t loop = 0; loop < AASI_GAME_USED_BUTTONS_NUM; loop++)
     {
-        if (pdTRUE == xQueueReceive(button_gpio_check_queue, &qdata, 0)
-            && (NULL != aasi_key_handle_queue))
+        button_t btn = _used_buttons[loop];
+        uint32_t repeat_ms = ((AASI_GAME_KEY_DIE == _button_map[btn]) ? 0u : AASI_GAME_KEY_REPEAT_MS);
+        button_set_repeat(btn, repeat_ms, repeat_ms);
+        mask |= BUTTON_MASK(btn);
+    }
+    button_subscribe(mask);
+}
+
+static void _aasi_buttons_handle(aasi_game_t *p_current)
+{
+    button_event_t event;
+    while (button_event_get(&event, 0))
+    {
+        aasi_button_t aasi_btn = _button_map[event.button];
+        if ((BUTTON_EVENT_RELEASE == event.type) || (AASI_GAME_KEY_NOT_MAPPED == aasi_btn))
+        {
+            continue;
+        }
+#if CONFIG_AASI_LATENCY_TRACE
+        /* Only presses are traced, a repeat has no edge to measure from */
+        uint32_t tag = ((BUTTON_EVENT_PRESS == event.type) ?
+                        aasi_lat_begin(&_latency, event.timestamp_us, esp_timer_get_time()) : 0u);
+        if (!aasi_game_post_tagged_key(p_current, aasi_btn, tag))
         {
-            xQueueSend(aasi_key_handle_queue, &qdata, 0);
-            vTaskDelay(AASI_GAME_KEY_POOL_DELAY_MS / portTICK_PERIOD_MS);
+            aasi_lat_cancel(&_latency, tag);
+        }
+#else
+        aasi_game_post_key(p_current, aasi_btn);
+#endif
+    }
+}
 
-            while (button_is_pressed(qdata))
-            {
-                xQueueSend(aasi_key_handle_queue, &qdata, 0);
-                vTaskDelay(AASI_GAME_KEY_POOL_DELAY_MS / portTICK_PERIOD_MS);
-            }
+static void _aasi_applied_keys_handle(aasi_game_t *p_current, int64_t tick_us)
+{
+    uint32_t tag;
+    unsigned long tick;
+    while (aasi_game_pop_applied_key(p_current, &tag, &tick))
+    {
+#if CONFIG_AASI_LATENCY_TRACE
+        if (aasi_lat_applied(&_latency, tag, tick_us))
+        {
+            continue;
         }
-        vTaskDelay(50 / portTICK_PERIOD_MS);
+#endif
+#if CONFIG_AASI_REMOTE
+        aasi_remote_on_applied(&_remote, tag, tick);
+#endif
+    }
+#if CONFIG_AASI_LATENCY_TRACE
+    if (aasi_game_did_render(p_current))
+    {
+        aasi_lat_drawn(&_latency, esp_timer_get_time());
     }
+#endif
 }
 
 static lv_obj_t* _screen_aasi_screen_get()
@@ -568,6 +825,11 @@ static void _lvdisplay_objdel(aasi_display_t *base, void **priv)
    gui_delete_label(priv);
 }
 
+static void _lvdisplay_clear(aasi_display_t *base)
+{
+   lv_obj_clean(p_game_layer);
+}
+
 static bool _lvdisplay_init(lvdisplay_t *this)
 {
     uint16_t game_height = 240;
@@ -584,11 +846,6 @@ static unsigned int _esp_random_provider()
    unsigned int rnd = esp_random();
    return rnd;
 }
-
-static void _btn_empty_callback(void *p_param)
-{
-    // empty
-}
 //---------------------------- INTERRUPT HANDLERS -----------------------------
 
 
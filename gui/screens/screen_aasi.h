@@ -16,6 +16,8 @@ extern "C" {
 
 //--------------------------------- INCLUDES ----------------------------------
 #include "gui/gui.h"
+#include "aasi/histogram.h"
+#include "aasi/latency.h"
 //---------------------------------- MACROS -----------------------------------
 
 //-------------------------------- DATA TYPES ---------------------------------
@@ -36,6 +38,14 @@ void aasi_game_set_aliens(uint8_t num_of_aliens);
  */
 void aasi_game_set_blocks(uint8_t num_of_blocks);
 
+/**
+ * Sets how many screens wide the AASI game world is. The display 
+ * follows the hero through a wider world.
+ * 
+ * @param world_scale The world width in screen widths, 1 or more.
+ */
+void aasi_game_set_world_scale(uint8_t world_scale);
+
 /**
  * Sets the color of the AASI game
  * 
@@ -50,6 +60,43 @@ void aasi_game_set_game_color(lv_color_t game_color);
  */
 void aasi_game_set_object_color(lv_color_t object_color);
 
+/**
+ * Returns the histogram of wall time between successive game ticks of the
+ *      current (or last) game, in microseconds.
+ * 
+ * @return The tick interval histogram.
+ */
+const aasi_hist_t *screen_aasi_get_tick_interval_hist(void);
+
+/**
+ * Returns the histogram of how late the game ticks of the current (or last)
+ *      game start behind an ideal schedule of one tick per period, in microseconds.
+ * 
+ * @return The tick lag histogram.
+ */
+const aasi_hist_t *screen_aasi_get_tick_lag_hist(void);
+
+/**
+ * Returns the task that runs the AASI game, it stays alive between games.
+ * 
+ * @return The handle of the task, NULL before the first game.
+ */
+TaskHandle_t screen_aasi_get_task_handle(void);
+
+/**
+ * Returns the input to photon latency tracer of the physical buttons. Its 
+ *      histograms cover every game since boot.
+ * 
+ * @return The latency tracer, NULL if CONFIG_AASI_LATENCY_TRACE is off.
+ */
+const aasi_lat_t *aasi_game_get_latency(void);
+
+/**
+ * Tells the latency tracer that the last area of a frame reached the display.
+ *      Called from the display flush callback.
+ */
+void screen_aasi_frame_flushed(void);
+
 
 #ifdef __cplusplus
 }
@@ -16,10 +16,15 @@
 #include "gui/gui.h"
 #include "gui/screen_switching.h"
 #include "screen_aasi.h"
+#include "leaderboard.h"
 //---------------------------------- MACROS -----------------------------------
-#define  keypad_read_QUEUE_LEN   (30u)
+#define  MAIN_MENU_BUTTONS_MASK  (BUTTON_MASK(BUTTON_UP) | BUTTON_MASK(BUTTON_DOWN)          \
+                                | BUTTON_MASK(BUTTON_LEFT) | BUTTON_MASK(BUTTON_RIGHT)     \
+                                | BUTTON_MASK(BUTTON_A) | BUTTON_MASK(BUTTON_B)            \
+                                | BUTTON_MASK(BUTTON_SELECT))
 #define  NUM_OF_COLORS           (5u)
 #define  MSGBOX_SHOW_HS_MS       (2500u)
+#define  MSGBOX_HS_ENTRIES       (5u)
 #define  MSGBOX_SHOW_QR_MS       (5000u)
 //-------------------------------- DATA TYPES ---------------------------------
 
@@ -51,25 +56,16 @@ static void _btn_wifi_disconnect_event_handler(lv_obj_t *p_obj, lv_event_t event
 static void _btn_wifi_ble_prov_event_handler(lv_obj_t *p_obj, lv_event_t event);
 
 /**
- * It reads the keypad and translates the keypad button presses into the 
+ * It takes the next button event and translates the button presses and releases into the 
  *      keypad events that LVGL understands
  * 
  * @param p_indev_drv A pointer to the input device driver.
  * @param p_data This is a pointer to the data structure that will be filled with the keypad data.
  * 
- * @return false not to buffer data.
+ * @return true if an event was taken, so LVGL reads again for the next one.
  */
 static bool _main_menu_keypad_read(lv_indev_drv_t *p_indev_drv, lv_indev_data_t *p_data);
 
-/**
- * This function is called when a button is pressed. It sends the button label 
- *      to the keypad read queue
- * 
- * @param p_param This is the parameter that is passed to the callback function. 
- *      In this case, it is the label of the button that was pressed.
- */
-static void _btn_main_menu_callback(void *p_param);
-
 /**
  * This function is called when the user clicks on the high score button
  * 
@@ -149,7 +145,6 @@ static void _msgbox_event_handler(lv_obj_t *p_obj, lv_event_t event);
  */
 static void switch_statbar_event_cb(lv_obj_t *p_switch, lv_event_t e);
 //------------------------- STATIC DATA & CONSTANTS ---------------------------
-static QueueHandle_t keypad_read_queue = NULL;
 static bool b_is_status_bar_drawn = false;
 static bool b_is_first_time = true;
 static bool b_did_user_req_disconn = false;
@@ -179,6 +174,7 @@ struct {
     lv_obj_t *p_btn_high_score;
     lv_obj_t *p_slider_aliens;
     lv_obj_t *p_slider_blocks;
+    lv_obj_t *p_slider_world;
     lv_obj_t *p_roller_game_color;
     lv_obj_t *p_roller_obj_color;
 } games_objs;
@@ -198,16 +194,12 @@ lv_obj_t *p_screen_main_menu;
 //------------------------------ PUBLIC FUNCTIONS -----------------------------
 void screen_main_menu_switch(void)
 {
-    if ((BUTTON_ERR_NONE != button_init(BUTTON_UP, _btn_main_menu_callback, true))
-        || (BUTTON_ERR_NONE != button_init(BUTTON_DOWN, _btn_main_menu_callback, true))
-        || (BUTTON_ERR_NONE != button_init(BUTTON_LEFT, _btn_main_menu_callback, true))
-        || (BUTTON_ERR_NONE != button_init(BUTTON_RIGHT, _btn_main_menu_callback, true))
-        || (BUTTON_ERR_NONE != button_init(BUTTON_A, _btn_main_menu_callback, NULL))
-        || (BUTTON_ERR_NONE != button_init(BUTTON_B, _btn_main_menu_callback, NULL))
-        || (BUTTON_ERR_NONE != button_init(BUTTON_SELECT, _btn_main_menu_callback, NULL)))
+    /* LVGL repeats held keys on its own */
+    for (button_t btn = BUTTON_UP; btn < BUTTON_COUNT; btn++)
     {
-        printf("Some button(s) not initialized\n");
+        button_set_repeat(btn, 0, 0);
     }
+    button_subscribe(MAIN_MENU_BUTTONS_MASK);
 
     if (b_is_first_time)
     {
@@ -246,8 +238,6 @@ void screen_main_menu_switch(void)
 
         tv_event_cb(NULL, LV_EVENT_REFRESH);
 
-        NEW_QUEUE(keypad_read, uint8_t);
-
         led_pattern_run(LED_STAT, LED_PATTERN_FASTBLINK, 2100);
         b_is_first_time = false;
     }
@@ -288,9 +278,20 @@ static void _btn_high_score_event_handler(lv_obj_t *p_obj, lv_event_t event)
 {
     if (LV_EVENT_CLICKED == event)
     {
+        leaderboard_entry_t entries[MSGBOX_HS_ENTRIES];
+        uint8_t entry_num = leaderboard_read(entries, MSGBOX_HS_ENTRIES);
+        char hs_name[32];
+        unsigned long hs = get_high_score_entry(hs_name, sizeof(hs_name));
+        char text[64 + (MSGBOX_HS_ENTRIES * (LEADERBOARD_NAME_MAX + 16u))];
+        size_t len = snprintf(text, sizeof(text), "Highscorer: %s\nScore: %lu\n", hs_name, hs);
+        /* snprintf returns the length it wanted, a full buffer ends the list */
+        for (uint8_t i = 0u; (i < entry_num) && (len < sizeof(text)); i++)
+        {
+            len += snprintf(text + len, sizeof(text) - len, "\n%u. %s %lu", i + 1u, entries[i].name,
+                            (unsigned long)entries[i].score);
+        }
         lv_obj_t *mbox1 = lv_msgbox_create(lv_scr_act(), NULL);
-        lv_msgbox_set_text_fmt(mbox1, "Highscorer: %s\nScore: %lu", get_hs_name(),
-                                                get_high_score());
+        lv_msgbox_set_text(mbox1, text);
         lv_obj_set_width(mbox1, 300);
         lv_obj_align(mbox1, NULL, LV_ALIGN_CENTER, 0, 0); /*Align to the corner*/
         lv_msgbox_start_auto_close(mbox1, MSGBOX_SHOW_HS_MS);
@@ -450,6 +451,25 @@ static void games_create(lv_obj_t *p_parent)
     lv_obj_set_style_local_transition_prop_5(games_objs.p_slider_blocks, LV_SLIDER_PART_KNOB, LV_STATE_DEFAULT, LV_STYLE_VALUE_OFS_Y);
     lv_obj_set_style_local_transition_prop_6(games_objs.p_slider_blocks, LV_SLIDER_PART_KNOB, LV_STATE_DEFAULT, LV_STYLE_VALUE_OPA);
 
+    lv_obj_t *p_label_world = lv_label_create(p_h, NULL);
+    lv_label_set_text(p_label_world, "World width (screens):");
+
+    games_objs.p_slider_world = lv_slider_create(p_h, NULL);
+    lv_slider_set_value(games_objs.p_slider_world, 1, LV_ANIM_OFF);
+    lv_obj_set_event_cb(games_objs.p_slider_world, slider_event_cb);
+    lv_obj_set_width_margin(games_objs.p_slider_world, fit_w);
+    lv_slider_set_range(games_objs.p_slider_world, 1, 4);
+
+    /*Use the knobs style value the display the current value in focused state*/
+    lv_obj_set_style_local_margin_top(games_objs.p_slider_world, LV_SLIDER_PART_BG, LV_STATE_DEFAULT, LV_DPX(25));
+    lv_obj_set_style_local_value_font(games_objs.p_slider_world, LV_SLIDER_PART_KNOB, LV_STATE_DEFAULT, lv_theme_get_font_small());
+    lv_obj_set_style_local_value_ofs_y(games_objs.p_slider_world, LV_SLIDER_PART_KNOB, LV_STATE_FOCUSED, -LV_DPX(25));
+    lv_obj_set_style_local_value_opa(games_objs.p_slider_world, LV_SLIDER_PART_KNOB, LV_STATE_DEFAULT, LV_OPA_TRANSP);
+    lv_obj_set_style_local_value_opa(games_objs.p_slider_world, LV_SLIDER_PART_KNOB, LV_STATE_FOCUSED, LV_OPA_COVER);
+    lv_obj_set_style_local_transition_time(games_objs.p_slider_world, LV_SLIDER_PART_KNOB, LV_STATE_DEFAULT, 300);
+    lv_obj_set_style_local_transition_prop_5(games_objs.p_slider_world, LV_SLIDER_PART_KNOB, LV_STATE_DEFAULT, LV_STYLE_VALUE_OFS_Y);
+    lv_obj_set_style_local_transition_prop_6(games_objs.p_slider_world, LV_SLIDER_PART_KNOB, LV_STATE_DEFAULT, LV_STYLE_VALUE_OPA);
+
     lv_obj_t *p_label_game_color = lv_label_create(p_h, NULL);
     lv_label_set_text(p_label_game_color, "Game color:                       ");
 
@@ -615,6 +635,14 @@ static void slider_event_cb(lv_obj_t *p_slider, lv_event_t e)
             lv_obj_set_style_local_value_str(games_objs.p_slider_blocks, LV_SLIDER_PART_KNOB, LV_STATE_DEFAULT, buf);
             aasi_game_set_blocks(value);
         }
+        else if (games_objs.p_slider_world == p_slider)
+        {
+            static char buf[4];
+            uint8_t value = lv_slider_get_value(p_slider);
+            lv_snprintf(buf, sizeof(buf), "%d", value);
+            lv_obj_set_style_local_value_str(games_objs.p_slider_world, LV_SLIDER_PART_KNOB, LV_STATE_DEFAULT, buf);
+            aasi_game_set_world_scale(value);
+        }
     }
 }
 
@@ -672,18 +700,24 @@ static void tv_event_cb(lv_obj_t *p_ta, lv_event_t e)
 static bool _main_menu_keypad_read(lv_indev_drv_t *p_indev_drv, lv_indev_data_t *p_data)
 {
     static uint32_t last_key = 0;
+    static lv_indev_state_t last_state = LV_INDEV_STATE_REL;
 
-    /*Get whether the a key is pressed and save the pressed key*/
-    uint8_t key_pressed = BUTTON_COUNT;
-    if ((NULL == keypad_read_queue)
-        || (pdTRUE != xQueueReceive(keypad_read_queue, &key_pressed, 0)))
+    /*Get whether the a key is pressed or released and save the key*/
+    button_event_t event;
+    if (!button_event_get(&event, 0))
     {
+        p_data->state = last_state;
+        p_data->key = last_key;
         return false;
     }
-    uint32_t act_key = (uint32_t) key_pressed;
-    if (BUTTON_COUNT > act_key)
+    uint32_t act_key = (uint32_t) event.button;
+    if (BUTTON_EVENT_RELEASE == event.type)
     {
-        p_data->state = LV_INDEV_STATE_PR;
+        last_state = LV_INDEV_STATE_REL;
+    }
+    else if (BUTTON_EVENT_PRESS == event.type)
+    {
+        last_state = LV_INDEV_STATE_PR;
 
         /*Translate the keys to LVGL control characters according to your key definitions*/
         switch (act_key)
@@ -720,26 +754,11 @@ static bool _main_menu_keypad_read(lv_indev_drv_t *p_indev_drv, lv_indev_data_t
 
         last_key = act_key;
     }
-    else
-    {
-        p_data->state = LV_INDEV_STATE_REL;
-    }
 
+    p_data->state = last_state;
     p_data->key = last_key;
 
-    /*Return `false` because we are not buffering and no more data to read*/
-    return false;
-}
-
-static void _btn_main_menu_callback(void *p_param)
-{
-    if (NULL == p_param || NULL == keypad_read_queue)
-    {
-        return;
-    }
-    uint8_t *p_btn_label = (uint8_t *) p_param;
-    static uint8_t data = BUTTON_COUNT;
-    data = *p_btn_label;
-    xQueueSendFromISR(keypad_read_queue, &data, NULL);
+    /*Return `true` as more events may be queued*/
+    return true;
 }
 //---------------------------- INTERRUPT HANDLERS -----------------------------
@@ -0,0 +1,243 @@
+/**
+* @file leaderboard.c
+
+* @brief Best scores of the device, kept across reboots.
+
+* @par The table is a sorted array of LEADERBOARD_SIZE entries. Every ranked score
+*      is appended to a log of LEADERBOARD_LOG_LEN slots, each write goes to the
+*      next slot. Every LEADERBOARD_LOG_LEN / 2 entries the whole table is written
+*      as a snapshot, which makes the entries logged before it obsolete, so the
+*      log never wraps over an entry the snapshot does not hold yet. While
+*      snapshots fail the log fills up, then entries are kept in RAM only until
+*      a snapshot succeeds. Loading reads the snapshot and the log slots once.
+*      A snapshot of another entry layout is dropped by its length.
+*
+*      Readers copy the table out of two published copies under a sequence lock
+*      and never block, the writers are serialized by a mutex.
+*
+* COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include "leaderboard.h"
+#include "leaderboard_store.h"
+#include "seqlock.h"
+//---------------------------------- MACROS -----------------------------------
+#define LEADERBOARD_SNAPSHOT_SLOT (LEADERBOARD_LOG_LEN)
+#define LEADERBOARD_COMPACT_EVERY (LEADERBOARD_LOG_LEN / 2u)
+//-------------------------------- DATA TYPES ---------------------------------
+typedef struct
+{
+    uint8_t             count;
+    leaderboard_entry_t entries[LEADERBOARD_SIZE];
+} leaderboard_table_t;
+
+typedef struct
+{
+    uint32_t            seq;
+    leaderboard_entry_t entry;
+} leaderboard_record_t;
+
+typedef struct
+{
+    uint32_t            seq;   /* of the last record it holds */
+    leaderboard_table_t table;
+} leaderboard_snapshot_t;
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief It finds the rank of a score, equal scores rank after the older ones.
+ *
+ * @param p_table The table.
+ * @param p_entry The entry.
+ *
+ * @return The rank, -1 if the entry does not rank or is already in the table.
+ */
+static int _rank(const leaderboard_table_t *p_table, const leaderboard_entry_t *p_entry);
+
+/**
+ * @brief It inserts an entry at its rank, the last entry drops out of a full table.
+ *
+ * @param p_table The table.
+ * @param p_entry The entry.
+ *
+ * @return The rank, -1 if the entry was not inserted.
+ */
+static int _insert(leaderboard_table_t *p_table, const leaderboard_entry_t *p_entry);
+
+/**
+ * @brief It publishes the working table to the readers.
+ */
+static void _publish(void);
+
+/**
+ * @brief It writes the working table as the snapshot of every record logged so far.
+ *
+ * @return true if the snapshot was written.
+ */
+static bool _compact(void);
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static pthread_mutex_t _write_lock = PTHREAD_MUTEX_INITIALIZER;
+static leaderboard_table_t _table;           /* working copy of the writers */
+static leaderboard_table_t _published[2];
+static seqlock_t _seqlock;
+static uint32_t _next_seq = 1u;
+static uint32_t _since_snapshot;
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+void leaderboard_init(void)
+{
+    static leaderboard_snapshot_t snapshot;
+    leaderboard_record_t records[LEADERBOARD_LOG_LEN];
+    uint8_t record_num = 0u;
+
+    pthread_mutex_lock(&_write_lock);
+    memset(&snapshot, 0, sizeof(snapshot));
+    size_t len = leaderboard_store_read(LEADERBOARD_SNAPSHOT_SLOT, &snapshot, sizeof(snapshot));
+    if ((offsetof(leaderboard_snapshot_t, table.entries) > len) ||
+        (LEADERBOARD_SIZE < snapshot.table.count) ||
+        (len != (offsetof(leaderboard_snapshot_t, table.entries) +
+                 (snapshot.table.count * sizeof(leaderboard_entry_t)))))
+    {
+        memset(&snapshot, 0, sizeof(snapshot));
+    }
+    _table = snapshot.table;
+    _next_seq = snapshot.seq + 1u;
+
+    /* Records newer than the snapshot are replayed in the order they were logged */
+    for (uint8_t slot = 0u; slot < LEADERBOARD_LOG_LEN; slot++)
+    {
+        leaderboard_record_t record;
+        if ((sizeof(record) == leaderboard_store_read(slot, &record, sizeof(record))) &&
+            (record.seq > snapshot.seq))
+        {
+            uint8_t i = record_num++;
+            for (; (0u < i) && (records[i - 1u].seq > record.seq); i--)
+            {
+                records[i] = records[i - 1u];
+            }
+            records[i] = record;
+        }
+    }
+    for (uint8_t i = 0u; i < record_num; i++)
+    {
+        records[i].entry.name[LEADERBOARD_NAME_MAX - 1u] = '\0';
+        (void)_insert(&_table, &records[i].entry);
+        _next_seq = records[i].seq + 1u;
+    }
+    _since_snapshot = record_num;
+    _publish();
+    pthread_mutex_unlock(&_write_lock);
+    printf("leaderboard: %u entries, %u logged after the snapshot\n", _table.count, record_num);
+}
+
+int leaderboard_submit(uint32_t score, uint32_t duration_ms, const char *p_name, size_t name_len)
+{
+    leaderboard_record_t record = { 0 };
+
+    record.entry.score = score;
+    record.entry.duration_ms = duration_ms;
+    name_len = ((LEADERBOARD_NAME_MAX - 1u) < name_len) ? (LEADERBOARD_NAME_MAX - 1u) : (name_len);
+    memcpy(record.entry.name, p_name, name_len);
+
+    pthread_mutex_lock(&_write_lock);
+    if (0 > _rank(&_table, &record.entry))
+    {
+        pthread_mutex_unlock(&_write_lock);
+        return -1;
+    }
+    /* The next slot holds an entry no snapshot has yet, it is not overwritten */
+    if ((LEADERBOARD_LOG_LEN > _since_snapshot) || _compact())
+    {
+        record.seq = _next_seq++;
+        if (!leaderboard_store_write(record.seq % LEADERBOARD_LOG_LEN, &record, sizeof(record)))
+        {
+            printf("leaderboard: entry not stored\n");
+        }
+        _since_snapshot++;
+    }
+    else
+    {
+        printf("leaderboard: log full, entry kept until the next snapshot\n");
+    }
+    int rank = _insert(&_table, &record.entry);
+    _publish();
+
+    if (LEADERBOARD_COMPACT_EVERY <= _since_snapshot)
+    {
+        (void)_compact();
+    }
+    pthread_mutex_unlock(&_write_lock);
+    return rank;
+}
+
+uint8_t leaderboard_read(leaderboard_entry_t *p_entries, uint8_t max)
+{
+    uint8_t count;
+    uint32_t seq;
+    do
+    {
+        seq = seqlock_read_begin(&_seqlock);
+        const leaderboard_table_t *p_table = &_published[seqlock_read_copy(seq)];
+        count = ((p_table->count < max) ? (p_table->count) : (max));
+        memcpy(p_entries, p_table->entries, count * sizeof(leaderboard_entry_t));
+    } while (seqlock_read_retry(&_seqlock, seq));
+    return count;
+}
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static int _rank(const leaderboard_table_t *p_table, const leaderboard_entry_t *p_entry)
+{
+    int rank = p_table->count;
+    for (int i = p_table->count - 1; (0 <= i) && (p_table->entries[i].score <= p_entry->score); i--)
+    {
+        if ((p_table->entries[i].score == p_entry->score) &&
+            ((0u == p_table->entries[i].duration_ms) || (0u == p_entry->duration_ms) ||
+             (p_table->entries[i].duration_ms == p_entry->duration_ms)) &&
+            (0 == strcmp(p_table->entries[i].name, p_entry->name)))
+        {
+            return -1;
+        }
+        rank = ((p_table->entries[i].score < p_entry->score) ? (i) : (rank));
+    }
+    return ((LEADERBOARD_SIZE > rank) ? (rank) : (-1));
+}
+
+static int _insert(leaderboard_table_t *p_table, const leaderboard_entry_t *p_entry)
+{
+    int rank = _rank(p_table, p_entry);
+    if (0 > rank)
+    {
+        return -1;
+    }
+    int last = ((LEADERBOARD_SIZE > p_table->count) ? (p_table->count++) : (LEADERBOARD_SIZE - 1));
+    memmove(&p_table->entries[rank + 1], &p_table->entries[rank], (last - rank) * sizeof(leaderboard_entry_t));
+    p_table->entries[rank] = *p_entry;
+    return rank;
+}
+
+static void _publish(void)
+{
+    _published[seqlock_write_flip(&_seqlock)] = _table;
+    _published[seqlock_write_flip(&_seqlock)] = _table;
+}
+
+static bool _compact(void)
+{
+    static leaderboard_snapshot_t snapshot;
+    snapshot.seq = _next_seq - 1u;
+    snapshot.table = _table;
+    /* Only the used entries are written */
+    if (!leaderboard_store_write(LEADERBOARD_SNAPSHOT_SLOT, &snapshot,
+                                 offsetof(leaderboard_snapshot_t, table.entries) +
+                                 (_table.count * sizeof(leaderboard_entry_t))))
+    {
+        return false;
+    }
+    _since_snapshot = 0u;
+    return true;
+}
+//---------------------------- INTERRUPT HANDLERS -----------------------------
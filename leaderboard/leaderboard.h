@@ -0,0 +1,73 @@
+/**
+* @file leaderboard.h
+
+* @brief See the source file.
+
+* @par
+*
+* COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __LEADERBOARD_H__
+#define __LEADERBOARD_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+//---------------------------------- MACROS -----------------------------------
+#ifndef LEADERBOARD_SIZE
+#define LEADERBOARD_SIZE     (10u)
+#endif
+#define LEADERBOARD_NAME_MAX (16u) /* with the terminator */
+#define LEADERBOARD_LOG_LEN  (16u) /* log slots, the table is compacted every half */
+//-------------------------------- DATA TYPES ---------------------------------
+typedef struct
+{
+    uint32_t score;
+    uint32_t duration_ms; /* 0 if the report did not carry it */
+    char     name[LEADERBOARD_NAME_MAX];
+} leaderboard_entry_t;
+//---------------------- PUBLIC FUNCTION PROTOTYPES ---------------------------
+/**
+ * It loads the leaderboard from NVS: the last compacted table and at most
+ * LEADERBOARD_LOG_LEN logged entries after it. Call it once NVS is initialized.
+ */
+void leaderboard_init(void);
+
+/**
+ * It enters a score if it ranks among the best LEADERBOARD_SIZE, equal scores 
+ * keep the older entry first. A game is told apart by its score, duration and
+ * name, a game already on the board is not entered again, an unknown duration
+ * matches any. A ranked score is appended to the log, the table is only
+ * rewritten on compaction.
+ *
+ * @param score The score.
+ * @param duration_ms The duration of the game, 0 if unknown.
+ * @param p_name The name, not terminated.
+ * @param name_len The length of the name, it is cut to LEADERBOARD_NAME_MAX - 1.
+ *
+ * @return The rank of the entry from 0, -1 if it does not rank or is already there.
+ */
+int leaderboard_submit(uint32_t score, uint32_t duration_ms, const char *p_name, size_t name_len);
+
+/**
+ * It copies the leaderboard, best first. It never blocks, from any task.
+ *
+ * @param p_entries The buffer for the entries.
+ * @param max The number of entries the buffer takes.
+ *
+ * @return The number of entries copied.
+ */
+uint8_t leaderboard_read(leaderboard_entry_t *p_entries, uint8_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LEADERBOARD_H__
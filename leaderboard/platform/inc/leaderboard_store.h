@@ -0,0 +1,54 @@
+/**
+* @file leaderboard_store.h
+
+* @brief See the source file.
+
+* @par
+*
+* COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __LEADERBOARD_STORE_H__
+#define __LEADERBOARD_STORE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+//---------------------------------- MACROS -----------------------------------
+
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PUBLIC FUNCTION PROTOTYPES ---------------------------
+/**
+ * It writes a slot of the leaderboard store, replacing its content.
+ *
+ * @param slot The slot.
+ * @param p_data The content.
+ * @param len The length of the content.
+ *
+ * @return true if the slot was written.
+ */
+bool leaderboard_store_write(uint8_t slot, const void *p_data, size_t len);
+
+/**
+ * It reads a slot of the leaderboard store.
+ *
+ * @param slot The slot.
+ * @param p_data The buffer for the content.
+ * @param len The size of the buffer.
+ *
+ * @return The length of the content, 0 if the slot is empty or does not fit.
+ */
+size_t leaderboard_store_read(uint8_t slot, void *p_data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LEADERBOARD_STORE_H__
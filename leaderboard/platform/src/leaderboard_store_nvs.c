@@ -0,0 +1,62 @@
+/**
+* @file leaderboard_store_nvs.c
+
+* @brief Leaderboard store in NVS, a blob per slot.
+
+* @par
+*
+* COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdio.h>
+#include "leaderboard_store.h"
+#include "nvs.h"
+//---------------------------------- MACROS -----------------------------------
+#define LEADERBOARD_NAMESPACE "leaderboard"
+#define LEADERBOARD_KEY_LEN   (8u)
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+bool leaderboard_store_write(uint8_t slot, const void *p_data, size_t len)
+{
+    nvs_handle_t handle;
+    char key[LEADERBOARD_KEY_LEN];
+    esp_err_t err = nvs_open(LEADERBOARD_NAMESPACE, NVS_READWRITE, &handle);
+    if (ESP_OK == err)
+    {
+        snprintf(key, sizeof(key), "lb%u", slot);
+        err = nvs_set_blob(handle, key, p_data, len);
+        if (ESP_OK == err)
+        {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    return (ESP_OK == err);
+}
+
+size_t leaderboard_store_read(uint8_t slot, void *p_data, size_t len)
+{
+    nvs_handle_t handle;
+    char key[LEADERBOARD_KEY_LEN];
+    /* The namespace only exists once something was written to it */
+    esp_err_t err = nvs_open(LEADERBOARD_NAMESPACE, NVS_READONLY, &handle);
+    if (ESP_OK == err)
+    {
+        snprintf(key, sizeof(key), "lb%u", slot);
+        err = nvs_get_blob(handle, key, p_data, &len);
+        nvs_close(handle);
+    }
+    return ((ESP_OK == err) ? (len) : (0u));
+}
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+
+//---------------------------- INTERRUPT HANDLERS -----------------------------
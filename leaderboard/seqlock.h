@@ -0,0 +1,99 @@
+/**
+* @file seqlock.h
+
+* @brief Sequence lock over two copies of a record, for one writer at a time and
+*        any number of readers that never block.
+
+* @par Every flip moves the readers to the other copy and frees the one they were
+*      reading, a writer flips, updates the free copy, flips again and updates
+*      the other one. A reader retries only if a flip happened while it copied, so
+*      a writer preempted halfway never stalls it.
+*
+*      uint32_t seq;
+*      do {
+*          seq = seqlock_read_begin(&lock);
+*          copy = records[seqlock_read_copy(seq)];
+*      } while (seqlock_read_retry(&lock, seq));
+*
+* COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __SEQLOCK_H__
+#define __SEQLOCK_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+//---------------------------------- MACROS -----------------------------------
+
+//-------------------------------- DATA TYPES ---------------------------------
+typedef struct
+{
+    atomic_uint seq;
+} seqlock_t;
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * It moves the readers to the other copy. Writers are serialized by the caller.
+ *
+ * @param p_lock The lock.
+ *
+ * @return The copy the readers left, it can be updated now.
+ */
+static inline uint8_t seqlock_write_flip(seqlock_t *p_lock)
+{
+    atomic_thread_fence(memory_order_release);
+    uint32_t seq = atomic_load_explicit(&p_lock->seq, memory_order_relaxed) + 1u;
+    atomic_store_explicit(&p_lock->seq, seq, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    return ((seq + 1u) & 1u);
+}
+
+/**
+ * It starts a read.
+ *
+ * @param p_lock The lock.
+ *
+ * @return The sequence to pass to seqlock_read_copy() and seqlock_read_retry().
+ */
+static inline uint32_t seqlock_read_begin(seqlock_t *p_lock)
+{
+    return atomic_load_explicit(&p_lock->seq, memory_order_acquire);
+}
+
+/**
+ * It returns the copy to read.
+ *
+ * @param seq The sequence the read started at.
+ *
+ * @return The copy.
+ */
+static inline uint8_t seqlock_read_copy(uint32_t seq)
+{
+    return (seq & 1u);
+}
+
+/**
+ * It ends a read.
+ *
+ * @param p_lock The lock.
+ * @param seq The sequence the read started at.
+ *
+ * @return true if a writer flipped meanwhile and the read has to be repeated.
+ */
+static inline bool seqlock_read_retry(seqlock_t *p_lock, uint32_t seq)
+{
+    atomic_thread_fence(memory_order_acquire);
+    return (seq != atomic_load_explicit(&p_lock->seq, memory_order_relaxed));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SEQLOCK_H__
@@ -1,7 +1,8 @@
 /**
 * @file led.c
 
-* @brief
+* @brief LED patterns. Every pattern is a step table, one one-shot timer wakes up at the
+*        nearest step deadline of all LEDs and advances them.
 
 * @par
 *
@@ -11,93 +12,92 @@
 
 //--------------------------------- INCLUDES ----------------------------------
 #include "led.h"
+#include "led_seq.h"
 #include <led_gpio.h>
-#include "driver/gpio.h"
+#include "board_io.h"
 #include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
 #include "freertos/timers.h"
 //---------------------------------- MACROS -----------------------------------
-
+#define LED_TIMER_CMD_WAIT_MS (10u)
 //-------------------------------- DATA TYPES ---------------------------------
-typedef void (*pattern_function_t)(void *p_led_config);
-
 typedef struct
 {
-    int                pin;
-    led_gpio_t*        p_led;
-    pattern_function_t pattern_fun_arr[LED_PATTERN_COUNT];
-    led_pattern_t      led_pattern;
-    uint32_t           timeout_ms;
-    TimerHandle_t      timer_hndl;
-    bool               b_is_pattern_inf;
+    int       pin;
+    led_seq_t seq;
 } led_config_t;
 
 //---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
 /**
- * @brief It runs the given led pattern and stops the previous pattern (if there was one),
- *        it also creates a new task in which the led pattern runs.
+ * @brief It swaps the sequence of the LED and reschedules the timer.
  *
- * @param led name of led GPIO to run the pattern on.
- * @param led_pattern pattern to run on given led GPIO.
- * @param timeout_ms 0 for infinite loop of the pattern, otherwise specifies how
- *                   long in miliseconds the pattern will run.
- */
-static inline void _run_pattern(led_name_t led, led_pattern_t led_pattern,
-                                uint32_t timeout_ms);
-
-/**
- * @brief Function for implementing the behaviour when pattern specified is none.
+ * @param led name of led GPIO to run the sequence on.
+ * @param p_sequence the step table to run.
+ * @param timeout_ms 0 to run until the sequence ends, otherwise specifies how
+ *                   long in miliseconds the sequence will run.
  *
- * @param p_led_config a pointer to the led_config_t structure.
+ * @return LED_ERR_NONE if the sequence runs.
  */
-static void _led_pattern_none(void *p_led_config);
+static led_err_t _run_sequence(led_name_t led, const led_sequence_t *p_sequence,
+                               uint32_t timeout_ms);
 
 /**
- * @brief Function for implementing the behaviour when pattern specified is keep on.
+ * @brief It advances the sequences of all LEDs.
  *
- * @param p_led_config a pointer to the led_config_t structure.
- */
-static void _led_pattern_keep_on(void *p_led_config);
-
-/**
- * @brief Function for implementing the behaviour when pattern specified is slow blinking.
+ * @param now_ms the current time.
  *
- * @param p_led_config a pointer to the led_config_t structure.
+ * @return The nearest deadline of all LEDs, LED_SEQ_NO_DEADLINE if there is none.
  */
-static void _led_pattern_slow_blink(void *p_led_config);
+static int64_t _advance_all(int64_t now_ms);
 
 /**
- * @brief Function for implementing the behaviour when pattern specified is fast blinking.
+ * @brief It sets the timer to expire at the deadline, or stops it.
  *
- * @param p_led_config a pointer to the led_config_t structure.
+ * @param next_ms the deadline, LED_SEQ_NO_DEADLINE to stop the timer.
+ * @param now_ms the current time.
+ * @param wait how long to wait for the timer command queue.
  */
-static void _led_pattern_fast_blink(void *p_led_config);
+static void _timer_schedule(int64_t next_ms, int64_t now_ms, TickType_t wait);
 
 /**
- * @brief Function for implementing the behaviour when pattern specified is provisioning.
+ * @brief Callback of the sequencer timer, it advances all LEDs and rearms itself.
  *
- * @param p_led_config a pointer to the led_config_t structure.
+ * @param timer a pointer to the handle which called the function.
  */
-static void _led_pattern_provisioning(void *p_led_config);
+static void _led_timer_callback(TimerHandle_t timer);
 
 /**
- * @brief Callback function for timer which takes care of the timing part in a pattern.
+ * @brief It returns the time the sequences run on.
  *
- * @param timer a pointer to the handle which called the function.
+ * @return Milliseconds since boot.
  */
-static void _led_timer_callback(TimerHandle_t timer);
-
-static void _timer_create(const char * const timer_name, const TickType_t timer_period,
-                   const UBaseType_t auto_reload, void * const timer_param,
-                   TimerCallbackFunction_t timer_callback_fun);
+static inline int64_t _now_ms(void);
 //------------------------- STATIC DATA & CONSTANTS ---------------------------
+static const led_step_t _steps_off[] = { { false, 0 } };
+static const led_step_t _steps_on[]  = { { true, 0 } };
+static const led_step_t _steps_slow_blink[] = {
+    { true, LED_SLOW_BLINKING_MS }, { false, LED_SLOW_BLINKING_MS },
+};
+static const led_step_t _steps_fast_blink[] = {
+    { true, LED_FAST_BLINKING_MS }, { false, LED_FAST_BLINKING_MS },
+};
+static const led_step_t _steps_provisioning[] = {
+    { true, LED_PROVISIONING_MS }, { false, LED_PROVISIONING_MS },
+};
+
+#define LED_STEPS(ARR) (ARR), (sizeof(ARR) / sizeof((ARR)[0]))
+static const led_sequence_t _patterns[LED_PATTERN_COUNT] = {
+    [LED_PATTERN_NONE]         = { LED_STEPS(_steps_off), 0 },
+    [LED_PATTERN_KEEP_ON]      = { LED_STEPS(_steps_on), 0 },
+    [LED_PATTERN_SLOWBLINK]    = { LED_STEPS(_steps_slow_blink), 0 },
+    [LED_PATTERN_FASTBLINK]    = { LED_STEPS(_steps_fast_blink), 0 },
+    [LED_PATTERN_PROVISIONING] = { LED_STEPS(_steps_provisioning), 0 },
+};
+
 static led_config_t _led_info[LED_COUNT] = {
-    {.pin = 2, .pattern_fun_arr[LED_PATTERN_NONE] = _led_pattern_none,
-    .pattern_fun_arr[LED_PATTERN_KEEP_ON] = _led_pattern_keep_on,
-    .pattern_fun_arr[LED_PATTERN_SLOWBLINK] = _led_pattern_slow_blink,
-    .pattern_fun_arr[LED_PATTERN_FASTBLINK] = _led_pattern_fast_blink,
-    .pattern_fun_arr[LED_PATTERN_PROVISIONING] = _led_pattern_provisioning,}, /* STATUS LED */
+    {.pin = 2}, /* STATUS LED */
 };
+static TimerHandle_t _led_timer = NULL;
+static portMUX_TYPE _led_lock = portMUX_INITIALIZER_UNLOCKED;
 //------------------------------- GLOBAL DATA ---------------------------------
 
 //------------------------------ PUBLIC FUNCTIONS -----------------------------
@@ -108,16 +108,21 @@ led_err_t led_init(led_name_t led)
     {
         return LED_ERR_INVALID_LED;
     }
+    if (NULL == _led_timer)
+    {
+        /* One-shot, every expiry sets the period to the next deadline */
+        _led_timer = xTimerCreate("led_seq", 1, pdFALSE, NULL, _led_timer_callback);
+        if (NULL == _led_timer)
+        {
+            return LED_ERR_INIT;
+        }
+    }
     led_gpio_t *p_led = led_gpio_create(_led_info[led].pin);
     if (NULL == p_led)
     {
         return LED_ERR_INIT;
     }
-    _led_info[led].p_led = p_led;
-    _led_info[led].timeout_ms = 0;
-    _led_info[led].led_pattern = LED_PATTERN_NONE;
-    _led_info[led].timer_hndl = NULL;
-    _led_info[led].b_is_pattern_inf = true;
+    led_seq_init(&_led_info[led].seq, p_led);
 
     return LED_ERR_NONE; 
 }
@@ -134,9 +139,20 @@ led_err_t led_pattern_run(led_name_t led,
     {
         return LED_ERR_INVALID_PATTERN;
     }
-    _run_pattern(led, led_pattern, timeout_ms);
+    return _run_sequence(led, &_patterns[led_pattern], timeout_ms);
+}
 
-    return LED_ERR_NONE;
+led_err_t led_sequence_run(led_name_t led, const led_sequence_t *p_sequence, uint32_t timeout_ms)
+{
+    if (LED_COUNT <= led)
+    {
+        return LED_ERR_INVALID_LED;
+    }
+    if ((NULL == p_sequence) || (NULL == p_sequence->p_steps) || (0u == p_sequence->step_num))
+    {
+        return LED_ERR_INVALID_PATTERN;
+    }
+    return _run_sequence(led, p_sequence, timeout_ms);
 }
 
 led_err_t led_pattern_reset(led_name_t led) 
@@ -145,100 +161,63 @@ led_err_t led_pattern_reset(led_name_t led)
     {
         return LED_ERR_INVALID_LED;
     }
-    _run_pattern(led, LED_PATTERN_NONE, 0);
-    return LED_ERR_NONE; 
+    return _run_sequence(led, &_patterns[LED_PATTERN_NONE], 0);
 }
 //---------------------------- PRIVATE FUNCTIONS ------------------------------
-static inline void _run_pattern(led_name_t led, led_pattern_t led_pattern,
-                                uint32_t timeout_ms)
+static led_err_t _run_sequence(led_name_t led, const led_sequence_t *p_sequence,
+                               uint32_t timeout_ms)
 {
-    if (NULL != _led_info[led].timer_hndl)
-    {
-        xTimerDelete(_led_info[led].timer_hndl, 0);
-    }
-    _led_info[led].timer_hndl = NULL;
-    _led_info[led].timeout_ms = timeout_ms;
-    if (0 >= timeout_ms)
-    {
-        _led_info[led].b_is_pattern_inf = true;
-    }
-    else
+    if (NULL == _led_info[led].seq.p_led)
     {
-        _led_info[led].b_is_pattern_inf = false;
+        return LED_ERR_INIT;
     }
-    _led_info[led].led_pattern = led_pattern;
-    xTaskCreate(_led_info[led].pattern_fun_arr[led_pattern], "led_task",
-                2 * 1024, (void *) &_led_info[led], 5, NULL);
+    int64_t now_ms = _now_ms();
+    portENTER_CRITICAL(&_led_lock);
+    led_seq_start(&_led_info[led].seq, p_sequence, timeout_ms, now_ms);
+    portEXIT_CRITICAL(&_led_lock);
 
+    _timer_schedule(_advance_all(now_ms), now_ms, pdMS_TO_TICKS(LED_TIMER_CMD_WAIT_MS));
+    return LED_ERR_NONE;
 }
 
-static void _led_pattern_none(void *p_led_config)
-{
-    led_gpio_off(((led_config_t *) p_led_config)->p_led);
-    vTaskDelete(NULL);
-}
-static void _led_pattern_keep_on(void *p_led_config)
-{
-    led_gpio_on(((led_config_t *) p_led_config)->p_led);
-    vTaskDelete(NULL);
-}
-static void _led_pattern_slow_blink(void *p_led_config)
-{
-    _timer_create("slow_blink", LED_SLOW_BLINKING_MS / portTICK_PERIOD_MS,
-                    pdTRUE, p_led_config, _led_timer_callback);
-    vTaskDelete(NULL);
-}
-static void _led_pattern_fast_blink(void *p_led_config)
+static int64_t _advance_all(int64_t now_ms)
 {
-    _timer_create("fast_blink", LED_FAST_BLINKING_MS / portTICK_PERIOD_MS,
-                    pdTRUE, p_led_config, _led_timer_callback);
-    vTaskDelete(NULL);
+    int64_t next_ms = LED_SEQ_NO_DEADLINE;
+    portENTER_CRITICAL(&_led_lock);
+    for (size_t loop = 0; loop < LED_COUNT; loop++)
+    {
+        if (NULL == _led_info[loop].seq.p_led)
+        {
+            continue;
+        }
+        int64_t deadline_ms = led_seq_advance(&_led_info[loop].seq, now_ms);
+        next_ms = ((deadline_ms < next_ms) ? deadline_ms : next_ms);
+    }
+    portEXIT_CRITICAL(&_led_lock);
+    return next_ms;
 }
 
-static void _led_pattern_provisioning(void *p_led_config)
+static void _timer_schedule(int64_t next_ms, int64_t now_ms, TickType_t wait)
 {
-    _timer_create("provisioning", LED_PROVISIONING_MS / portTICK_PERIOD_MS,
-                    pdTRUE, p_led_config, _led_timer_callback);
-    vTaskDelete(NULL);
+    if (LED_SEQ_NO_DEADLINE == next_ms)
+    {
+        xTimerStop(_led_timer, wait);
+        return;
+    }
+    /* Round up, expiring before the deadline would only rearm the timer */
+    TickType_t ticks = (TickType_t) ((next_ms - now_ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS);
+    xTimerChangePeriod(_led_timer, ((0u == ticks) ? 1u : ticks), wait);
 }
 
 static void _led_timer_callback(TimerHandle_t timer)
 {
-    led_config_t *p_led_config = (led_config_t *) pvTimerGetTimerID(timer);
-    bool b_is_infinite = p_led_config->b_is_pattern_inf;
-    if (b_is_infinite)
-    {
-        led_gpio_toggle(p_led_config->p_led);
-    }
-    else
-    {
-        uint32_t timeout_ms = p_led_config->timeout_ms;
-        timeout_ms = timeout_ms - (int) (xTimerGetPeriod(timer) * portTICK_PERIOD_MS);
-        p_led_config->timeout_ms = timeout_ms;
-        if (0 >= timeout_ms)
-        {
-            xTimerDelete(timer, 0);
-            p_led_config->timer_hndl = NULL;
-            led_gpio_off(p_led_config->p_led);
-        }
-        else
-        {
-            led_gpio_toggle(p_led_config->p_led);
-        }
-    }
+    int64_t now_ms = _now_ms();
+    /* The timer task must not block on its own command queue */
+    _timer_schedule(_advance_all(now_ms), now_ms, 0);
 }
 
-static void _timer_create(const char * const timer_name, const TickType_t timer_period,
-                   const UBaseType_t auto_reload, void * const timer_param,
-                   TimerCallbackFunction_t timer_callback_fun)
+static inline int64_t _now_ms(void)
 {
-    TimerHandle_t timer = xTimerCreate(timer_name, timer_period,
-                                    auto_reload, timer_param, timer_callback_fun);
-    if (NULL != timer)
-    {
-        ((led_config_t *) timer_param)->timer_hndl = timer;
-        led_gpio_on(((led_config_t *) timer_param)->p_led);
-        xTimerStart(timer, 0);
-    }
+    return (board_io_time_us() / 1000);
 }
 //---------------------------- INTERRUPT HANDLERS -----------------------------
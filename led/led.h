@@ -18,6 +18,8 @@ extern "C" {
 
 //--------------------------------- INCLUDES ----------------------------------
 #include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
 //---------------------------------- MACROS -----------------------------------
 #define NO_TIMEOUT (UINT_MAX)
 #define LED_SLOW_BLINKING_MS (1000U)
@@ -53,6 +55,19 @@ typedef enum
     LED_ERR_INVALID_LED = -3,
 
 } led_err_t;
+
+typedef struct
+{
+    bool     b_on;
+    uint32_t duration_ms; /* 0 holds the step until the next pattern */
+} led_step_t;
+
+typedef struct
+{
+    const led_step_t *p_steps;
+    uint8_t           step_num;
+    uint16_t          repeat;  /* passes over the steps, 0 loops forever */
+} led_sequence_t;
 //---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
 
 /**
@@ -73,6 +88,16 @@ led_err_t led_init(led_name_t led);
  */
 led_err_t led_pattern_run(led_name_t led, led_pattern_t led_pattern, uint32_t timeout_ms);
 
+/**
+ * @brief Run a custom pattern given as a step table. The LED is off once it ends.
+ *        Don't call this function from ISR.
+ * @param led - led_name_t led name.
+ * @param p_sequence - the step table, it has to outlive the pattern.
+ * @param timeout_ms - timeout in milliseconds (if 0 run until the sequence ends)
+ * @return err_status_t - STATUS_OK if ok.
+ */
+led_err_t led_sequence_run(led_name_t led, const led_sequence_t *p_sequence, uint32_t timeout_ms);
+
 /**
  * @brief Reset led pattern.
  * @param led - leled_name_td_t led name.
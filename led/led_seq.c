@@ -0,0 +1,108 @@
+/**
+* @file led_seq.c
+
+* @brief Step table sequencer of a single LED. It keeps no time of its own, the owner calls
+*        led_seq_advance() at the deadlines it returns.
+
+* @par
+*
+* COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stddef.h>
+#include "led_seq.h"
+//---------------------------------- MACROS -----------------------------------
+
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+/**
+ * @brief It sets the LED to the level of the current step and schedules the end of the step.
+ *
+ * @param p_seq The sequencer state of the LED.
+ * @param start_ms The time the step starts at.
+ */
+static void _step_apply(led_seq_t *p_seq, int64_t start_ms);
+
+/**
+ * @brief It turns the LED off and leaves the sequencer idle.
+ *
+ * @param p_seq The sequencer state of the LED.
+ */
+static void _stop(led_seq_t *p_seq);
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+void led_seq_init(led_seq_t *p_seq, led_gpio_t *p_led)
+{
+    p_seq->p_led = p_led;
+    p_seq->p_seq = NULL;
+    p_seq->deadline_ms = LED_SEQ_NO_DEADLINE;
+    p_seq->end_ms = LED_SEQ_NO_DEADLINE;
+}
+
+void led_seq_start(led_seq_t *p_seq, const led_sequence_t *p_sequence, uint32_t timeout_ms, int64_t now_ms)
+{
+    if ((NULL == p_sequence) || (0u == p_sequence->step_num))
+    {
+        _stop(p_seq);
+        return;
+    }
+    p_seq->p_seq = p_sequence;
+    p_seq->step = 0;
+    p_seq->loops = 0;
+    p_seq->end_ms = ((0u != timeout_ms) ? (now_ms + timeout_ms) : LED_SEQ_NO_DEADLINE);
+    _step_apply(p_seq, now_ms);
+}
+
+int64_t led_seq_advance(led_seq_t *p_seq, int64_t now_ms)
+{
+    if (now_ms >= p_seq->end_ms)
+    {
+        _stop(p_seq);
+    }
+    /* Steps are chained on their deadlines, a late call does not stretch the pattern */
+    while ((NULL != p_seq->p_seq) && (now_ms >= p_seq->deadline_ms))
+    {
+        const led_sequence_t *p_sequence = p_seq->p_seq;
+        if (++p_seq->step >= p_sequence->step_num)
+        {
+            p_seq->step = 0;
+            p_seq->loops++;
+            if ((0u != p_sequence->repeat) && (p_seq->loops >= p_sequence->repeat))
+            {
+                _stop(p_seq);
+                break;
+            }
+        }
+        _step_apply(p_seq, p_seq->deadline_ms);
+    }
+    return ((p_seq->deadline_ms < p_seq->end_ms) ? p_seq->deadline_ms : p_seq->end_ms);
+}
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static void _step_apply(led_seq_t *p_seq, int64_t start_ms)
+{
+    const led_step_t *p_step = &p_seq->p_seq->p_steps[p_seq->step];
+    if (p_step->b_on)
+    {
+        led_gpio_on(p_seq->p_led);
+    }
+    else
+    {
+        led_gpio_off(p_seq->p_led);
+    }
+    p_seq->deadline_ms = ((0u != p_step->duration_ms) ? (start_ms + p_step->duration_ms) : LED_SEQ_NO_DEADLINE);
+}
+
+static void _stop(led_seq_t *p_seq)
+{
+    led_gpio_off(p_seq->p_led);
+    p_seq->p_seq = NULL;
+    p_seq->deadline_ms = LED_SEQ_NO_DEADLINE;
+    p_seq->end_ms = LED_SEQ_NO_DEADLINE;
+}
+//---------------------------- INTERRUPT HANDLERS -----------------------------
@@ -0,0 +1,72 @@
+/**
+* @file led_seq.h
+
+* @brief See the source file.
+
+* @par
+*
+* COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __LED_SEQ_H__
+#define __LED_SEQ_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdint.h>
+#include <stdbool.h>
+#include "led.h"
+#include "led_gpio.h"
+//---------------------------------- MACROS -----------------------------------
+#define LED_SEQ_NO_DEADLINE (INT64_MAX)
+//-------------------------------- DATA TYPES ---------------------------------
+typedef struct
+{
+    led_gpio_t           *p_led;
+    const led_sequence_t *p_seq;       /* NULL once the sequence has ended */
+    uint8_t               step;
+    uint16_t              loops;       /* completed passes over the steps */
+    int64_t               deadline_ms; /* end of the current step */
+    int64_t               end_ms;      /* timeout of the sequence */
+} led_seq_t;
+//---------------------- PUBLIC FUNCTION PROTOTYPES ---------------------------
+
+/**
+ * It binds the sequencer state to a LED and leaves it idle.
+ *
+ * @param p_seq The sequencer state of the LED.
+ * @param p_led The LED it drives.
+ */
+void led_seq_init(led_seq_t *p_seq, led_gpio_t *p_led);
+
+/**
+ * It replaces the running sequence of the LED and applies its first step. It takes constant
+ * time and allocates nothing.
+ *
+ * @param p_seq The sequencer state of the LED.
+ * @param p_sequence The sequence to run, it is not copied.
+ * @param timeout_ms 0 to run the sequence to its end, otherwise it is cut after timeout_ms.
+ * @param now_ms The current time.
+ */
+void led_seq_start(led_seq_t *p_seq, const led_sequence_t *p_sequence, uint32_t timeout_ms, int64_t now_ms);
+
+/**
+ * It applies every step whose time has come. The LED is turned off when the sequence ends
+ * or times out.
+ *
+ * @param p_seq The sequencer state of the LED.
+ * @param now_ms The current time.
+ *
+ * @return The time the LED needs to be advanced again, LED_SEQ_NO_DEADLINE if never.
+ */
+int64_t led_seq_advance(led_seq_t *p_seq, int64_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LED_SEQ_H__
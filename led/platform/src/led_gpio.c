@@ -10,9 +10,9 @@
 */
 
 //--------------------------------- INCLUDES ----------------------------------
-#include <stdio.h>
+#include <stdlib.h>
 #include <stdbool.h>
-#include "driver/gpio.h"
+#include "board_io.h"
 #include "led_gpio.h"
 
 //---------------------------------- MACROS -----------------------------------
@@ -25,8 +25,8 @@ struct _led_gpio_t
 };
 //---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
 /**
- * @brief It initializes led as an output pin, returns ESP_OK if successfull,
- *        otherwise returns ESP_ERR_INVALID_ARG.
+ * @brief It initializes led as an output pin and turns it off, returns 0 if 
+ *        successfull.
  *
  * @param p_led a pointer to the led_gpio_t structure.
  *
@@ -86,6 +86,7 @@ led_gpio_t *led_gpio_create(int pin)
     if (0 != _led_init(p_led))
     {
         _led_free(p_led);
+        return NULL;
     }
 
     return p_led;
@@ -113,20 +114,11 @@ void led_gpio_toggle(led_gpio_t *p_led)
 //---------------------------- PRIVATE FUNCTIONS ------------------------------
 static int _led_init(led_gpio_t *p_led)
 {
-    // zero-initialize the config structure.
-    gpio_config_t io_conf = {};
-    // disable interrupt
-    io_conf.intr_type = GPIO_INTR_DISABLE;
-    // set as output mode
-    io_conf.mode = GPIO_MODE_OUTPUT;
-    // bit mask of the pins that you want to set,e.g.GPIO18/19
-    io_conf.pin_bit_mask = (1ULL << (p_led->pin));
-    // disable pull-down mode
-    io_conf.pull_down_en = 0;
-    // disable pull-up mode
-    io_conf.pull_up_en = 0;
-    // configure GPIO with the given settings
-    gpio_config(&io_conf);
+    if (BOARD_IO_ERR_NONE != board_io_dout_init(p_led->pin))
+    {
+        return -1;
+    }
+    board_io_dout_write(p_led->pin, false);
     return 0;
 }
 
@@ -147,7 +139,7 @@ static inline void _led_turn_on(led_gpio_t *p_led)
 {
     if (NULL != p_led)
     {
-        gpio_set_level(p_led->pin, 1);
+        board_io_dout_write(p_led->pin, true);
         p_led->b_is_led_on = true;
     }
 }
@@ -156,7 +148,7 @@ static inline void _led_turn_off(led_gpio_t *p_led)
 {
     if (NULL != p_led)
     {
-        gpio_set_level(p_led->pin, 0);
+        board_io_dout_write(p_led->pin, false);
         p_led->b_is_led_on = false;
     }
 }
@@ -22,13 +22,22 @@
 #include "app_mqtt_client.h"
 #include "esp_netif_types.h"
 #include "nvs_flash.h"
+#include "leaderboard.h"
+#include "seqlock.h"
+#include "device_metrics.h"
 #include "gui/gui.h"
 #include "gui/screen_switching.h"
 #include "esp_log.h"
 
 //---------------------------------- MACROS -----------------------------------
+#define HS_NAME_LEN (30u)
 
 //-------------------------------- DATA TYPES ---------------------------------
+typedef struct
+{
+    unsigned long score;
+    char          name[HS_NAME_LEN];
+} high_score_t;
 
 //---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
 /**
@@ -49,13 +58,6 @@ static esp_err_t _nvs_init(void);
  */
 static void _led_screen_off_blinking(void);
 
-/**
- * When the menu button is pressed, reset the LED pattern and allow the program
- *      to continue
- * 
- * @param arg The argument passed to the callback function.
- */
-static void _button_menu_callback(void *arg);
 
 /**
 * @brief Timer status_bar_refresh Callback function.
@@ -71,12 +73,13 @@ static void _check_and_mqtt_init(void);
 
 
 /**
- * It takes a string, parses it, and if the parsed score is higher than the current high score, it
+ * It decodes a game report, and if its score is higher than the current high score, it
  * updates the high score and the high score name
  * 
- * @param p_msg The message received from the server.
+ * @param p_data The report received from the server, binary or a legacy string.
+ * @param len The length of the report.
  */
-static void _telemetry_new_score(char *p_msg);
+static void _telemetry_new_score(const uint8_t *p_data, int len);
 
 /**
  * This function is called when the WiFi status changes
@@ -95,8 +98,10 @@ static volatile bool b_is_started = false;
 static bool b_is_reconnecting     = false;
 static bool b_needs_prov          = false;
 static bool b_is_mqtt_init        = false;
-static unsigned long high_score   = 0;
-static char hs_name_buf[30] = "";
+/* Two copies under a sequence lock, readers on any task never wait for a writer */
+static high_score_t hs_records[2];
+static seqlock_t hs_seqlock;
+static portMUX_TYPE hs_write_lock = portMUX_INITIALIZER_UNLOCKED;
 //------------------------------- GLOBAL DATA ---------------------------------
 
 //------------------------------ PUBLIC FUNCTIONS -----------------------------
@@ -106,11 +111,22 @@ void app_main() {
     {
         printf("NVS failed to init\n");
     }
+    leaderboard_init();
+    leaderboard_entry_t best;
+    if (0u != leaderboard_read(&best, 1u))
+    {
+        (void)set_high_score_if_better(best.score, best.name, strlen(best.name), true);
+    }
     _led_screen_off_blinking();
     _wait_for_start();
     gui_init();
     wifi_register_on_status_changed(&_wifi_status_changed_cb);
-    telemetry_register_on_new_message(&_telemetry_new_score);
+    /* Devices with older firmware only publish the legacy strings */
+    telemetry_subscribe(MQTT_SCORE_TOPIC, &_telemetry_new_score);
+    telemetry_subscribe(MQTT_HOMEWORK_TOPIC, &_telemetry_new_score);
+#if CONFIG_DEVICE_METRICS
+    device_metrics_start();
+#endif
     vTaskDelay(2100 / portTICK_PERIOD_MS);
     wifi_err_t wifi_err = wifi_init();
     if (WIFI_OK != wifi_err)
@@ -205,24 +221,44 @@ bool does_wifi_need_prov()
     return b_needs_prov;
 }
 
-char *get_hs_name(void)
+unsigned long get_high_score_entry(char *p_name, size_t name_size)
 {
-    return hs_name_buf;
-}
+    high_score_t record;
+    uint32_t seq;
+    do
+    {
+        seq = seqlock_read_begin(&hs_seqlock);
+        record = hs_records[seqlock_read_copy(seq)];
+    } while (seqlock_read_retry(&hs_seqlock, seq));
 
-unsigned long get_high_score(void)
-{
-    return high_score;
+    if (NULL != p_name)
+    {
+        snprintf(p_name, name_size, "%s", record.name);
+    }
+    return record.score;
 }
 
-void set_hs_name(char *p_name)
+unsigned long get_high_score(void)
 {
-    strcpy(hs_name_buf, p_name);
+    return get_high_score_entry(NULL, 0u);
 }
 
-void set_high_score(unsigned long hs)
+bool set_high_score_if_better(unsigned long hs, const char *p_name, size_t name_len, bool b_or_equal)
 {
-    high_score = hs;
+    high_score_t record = { .score = hs };
+    memcpy(record.name, p_name, ((HS_NAME_LEN - 1u) < name_len) ? (HS_NAME_LEN - 1u) : (name_len));
+
+    /* The compare and both copies are one step for the writers, readers never enter it */
+    portENTER_CRITICAL(&hs_write_lock);
+    unsigned long current = hs_records[seqlock_read_copy(seqlock_read_begin(&hs_seqlock))].score;
+    bool b_better = ((hs > current) || (b_or_equal && (hs == current)));
+    if (b_better)
+    {
+        hs_records[seqlock_write_flip(&hs_seqlock)] = record;
+        hs_records[seqlock_write_flip(&hs_seqlock)] = record;
+    }
+    portEXIT_CRITICAL(&hs_write_lock);
+    return b_better;
 }
 //---------------------------- PRIVATE FUNCTIONS ------------------------------
 static void _led_screen_off_blinking(void)
@@ -233,20 +269,20 @@ static void _led_screen_off_blinking(void)
 
 static void _wait_for_start(void)
 {
-    button_init(BUTTON_MENU, _button_menu_callback, NULL);
-    while (!b_is_started)
+    if (BUTTON_ERR_NONE != button_init())
     {
-        vTaskDelay(30 / portTICK_PERIOD_MS);
+        printf("Some button(s) not initialized\n");
     }
-}
-
-static void _button_menu_callback(void *arg)
-{
-    if (!b_is_started)
+    button_subscribe(BUTTON_MASK(BUTTON_MENU));
+    while (!b_is_started)
     {
-        led_pattern_reset(LED_STAT);
+        button_event_t event;
+        if (button_event_get(&event, portMAX_DELAY) && (BUTTON_EVENT_PRESS == event.type))
+        {
+            led_pattern_reset(LED_STAT);
+            b_is_started = true;
+        }
     }
-    b_is_started = true;
 }
 
 static void _wifi_status_changed_cb(wifi_connection_status_t status, void *p_param)
@@ -326,16 +362,16 @@ static esp_err_t _nvs_init(void)
     return ret;
 }
 
-static void _telemetry_new_score(char *p_msg)
+static void _telemetry_new_score(const uint8_t *p_data, int len)
 {
-    char *p_score = strtok(p_msg, ",");
-    char *p_name = strtok(NULL, " ");
-    unsigned long hs_tmp = strtoul(p_score, NULL, 10);
-    if (hs_tmp >= high_score)
+    telemetry_report_t report;
+    /* Lost games report a score of 0, retained reports come again on every connect */
+    if (!telemetry_report_decode(p_data, len, &report) || (0u == report.score))
     {
-        high_score = hs_tmp;
-        strcpy(hs_name_buf, p_name);
+        return;
     }
+    (void)leaderboard_submit(report.score, report.duration_ms, report.p_owner, report.owner_len);
+    (void)set_high_score_if_better(report.score, report.p_owner, report.owner_len, true);
 }
 
 static void _check_and_mqtt_init(void)
@@ -0,0 +1,135 @@
+/**
+* @file device_metrics.c
+
+* @brief Health of the device published over MQTT.
+
+* @par A low priority task samples the heap, the LVGL heap, the stack
+*       high-water marks of the busy tasks, the frame pacing of the game loop
+*       and the RSSI, and publishes the samples delta encoded. Nothing is
+*       added to the game loop, the pacing histograms it keeps anyway are read
+*       without a lock and may be one tick behind. Samples are skipped while
+*       the MQTT outbox holds more than CONFIG_DEVICE_METRICS_BACKLOG bytes, so
+*       they never queue up offline or crowd out the game traffic.
+*
+* COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "device_metrics.h"
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_system.h"
+#include "esp_mac.h"
+#include "esp_timer.h"
+#include "lvgl.h"
+#include "wifi_driver.h"
+#include "app_mqtt_client.h"
+#include "aasi/histogram.h"
+#include "gui/gui.h"
+#include "screens/screen_aasi.h"
+//---------------------------------- MACROS -----------------------------------
+#define  device_metrics_THREAD_STACK_SIZE      (3u * 1024u)
+#define  device_metrics_THREAD_PRIORITY        (tskIDLE_PRIORITY + 1u)
+/* Created by the MQTT client, a name is only looked up within configMAX_TASK_NAME_LEN */
+#define  DEVICE_METRICS_MQTT_TASK              "mqtt_task"
+#define  DEVICE_METRICS_TOPIC_LEN              (sizeof(MQTT_METRICS_TOPIC) + 13u)
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+/**
+ * It samples and publishes the health of the device periodically.
+ *
+ * @param p_argument Unused.
+ */
+static void device_metrics_task(void const *p_argument);
+
+/**
+ * It returns the stack high-water mark of a task.
+ *
+ * @param task The task.
+ *
+ * @return The least free stack in bytes, 0 if there is no such task.
+ */
+static int32_t _device_metrics_stack_free(TaskHandle_t task);
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static TaskHandle_t task_device_metrics_hndl = NULL;
+static char metrics_topic[DEVICE_METRICS_TOPIC_LEN];
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+void device_metrics_start(void)
+{
+    /* One stream per device, a fleet is watched with MQTT_METRICS_TOPIC "/+" */
+    uint8_t mac[6] = { 0 };
+    (void)esp_efuse_mac_get_default(mac);
+    snprintf(metrics_topic, sizeof(metrics_topic), "%s/%02x%02x%02x%02x%02x%02x", MQTT_METRICS_TOPIC,
+             mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    NEW_TASK(device_metrics, NULL);
+}
+
+void device_metrics_sample(telemetry_metrics_t *p_sample)
+{
+    int32_t *p_value = p_sample->value;
+
+    memset(p_sample, 0, sizeof(*p_sample));
+    p_value[TELEMETRY_METRIC_UPTIME_S] = esp_timer_get_time() / 1000000;
+    p_value[TELEMETRY_METRIC_HEAP_FREE] = esp_get_free_heap_size();
+    p_value[TELEMETRY_METRIC_HEAP_MIN_FREE] = esp_get_minimum_free_heap_size();
+
+    lv_mem_monitor_t mon;
+    if (gui_mem_monitor(&mon))
+    {
+        p_value[TELEMETRY_METRIC_LV_MEM_USED] = mon.total_size - mon.free_size;
+        p_value[TELEMETRY_METRIC_LV_MEM_FRAG_PCT] = mon.frag_pct;
+    }
+
+    p_value[TELEMETRY_METRIC_STACK_FREE_GUI] = _device_metrics_stack_free(gui_get_task_handle());
+    p_value[TELEMETRY_METRIC_STACK_FREE_GAME] = _device_metrics_stack_free(screen_aasi_get_task_handle());
+    p_value[TELEMETRY_METRIC_STACK_FREE_MQTT] = _device_metrics_stack_free(xTaskGetHandle(DEVICE_METRICS_MQTT_TASK));
+    p_value[TELEMETRY_METRIC_STACK_FREE_METRICS] = uxTaskGetStackHighWaterMark(NULL);
+
+    const aasi_hist_t *p_interval = screen_aasi_get_tick_interval_hist();
+    p_value[TELEMETRY_METRIC_GAME_TICKS] = p_interval->count;
+    p_value[TELEMETRY_METRIC_TICK_MEAN_US] = aasi_hist_mean(p_interval);
+    p_value[TELEMETRY_METRIC_TICK_P99_US] = aasi_hist_percentile(p_interval, 99u);
+    p_value[TELEMETRY_METRIC_TICK_MAX_US] = p_interval->max;
+    p_value[TELEMETRY_METRIC_TICK_LAG_P99_US] = aasi_hist_percentile(screen_aasi_get_tick_lag_hist(), 99u);
+
+    p_value[TELEMETRY_METRIC_RSSI_DBM] = wifi_get_rssi();
+}
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static void device_metrics_task(void const *p_argument)
+{
+    static telemetry_metrics_encoder_t encoder;
+    telemetry_metrics_encoder_init(&encoder, CONFIG_DEVICE_METRICS_KEYFRAME_EVERY);
+    TickType_t last_wake = xTaskGetTickCount();
+
+    for (;;)
+    {
+        vTaskDelayUntil(&last_wake, CONFIG_DEVICE_METRICS_INTERVAL_MS / portTICK_PERIOD_MS);
+        if (CONFIG_DEVICE_METRICS_BACKLOG < telemetry_outbox_size())
+        {
+            /* The receivers miss this sample, the next one has to stand alone */
+            telemetry_metrics_encoder_resync(&encoder);
+            continue;
+        }
+
+        telemetry_metrics_t sample;
+        uint8_t payload[TELEMETRY_METRICS_SIZE_MAX];
+        device_metrics_sample(&sample);
+        size_t len = telemetry_metrics_encode(&encoder, &sample, payload, sizeof(payload));
+        if (TELEMETRY_OK != telemetry_publish(metrics_topic, payload, len, 0, false))
+        {
+            telemetry_metrics_encoder_resync(&encoder);
+        }
+    }
+}
+
+static int32_t _device_metrics_stack_free(TaskHandle_t task)
+{
+    return ((NULL != task) ? (uxTaskGetStackHighWaterMark(task)) : (0));
+}
+//---------------------------- INTERRUPT HANDLERS -----------------------------
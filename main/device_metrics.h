@@ -0,0 +1,44 @@
+/**
+* @file device_metrics.h
+
+* @brief See the source file.
+
+* @par
+*
+* COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __DEVICE_METRICS_H__
+#define __DEVICE_METRICS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "telemetry_metrics.h"
+//---------------------------------- MACROS -----------------------------------
+
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * It starts the task that samples the health of the device and publishes it
+ *       on MQTT_METRICS_TOPIC "/" and its MAC address in hex, every
+ *       CONFIG_DEVICE_METRICS_INTERVAL_MS.
+ */
+void device_metrics_start(void);
+
+/**
+ * It takes a sample of the health of the device.
+ *
+ * @param p_sample The sample.
+ */
+void device_metrics_sample(telemetry_metrics_t *p_sample);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __DEVICE_METRICS_H__
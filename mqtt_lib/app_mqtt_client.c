@@ -12,30 +12,113 @@
 //--------------------------------- INCLUDES ----------------------------------
 #include "app_mqtt_client.h"
 #include "mqtt_client_esp.h"
+#include "telemetry_outbox.h"
+#include "topic_router.h"
+#include <string.h>
 //---------------------------------- MACROS -----------------------------------
+#define TELEMETRY_LEGACY_MSG_SIZE (64u)
 
 //-------------------------------- DATA TYPES ---------------------------------
-
 //---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+/**
+ * It passes a received message to the callbacks subscribed to its topic.
+ * 
+ * @param p_topic The topic of the message, not terminated.
+ * @param topic_len The length of the topic.
+ * @param p_data The payload.
+ * @param len The length of the payload.
+ */
+static void _telemetry_on_data(const char *p_topic, int topic_len, 
+                               const uint8_t *p_data, int len);
+
+/**
+ * It renews all subscriptions, a clean session starts without any, and 
+ *       publishes the results queued while offline.
+ */
+static void _telemetry_on_connected(void);
+
+/**
+ * It passes a result to the legacy callback as a terminated string.
+ * 
+ * @param p_data The payload.
+ * @param len The length of the payload.
+ */
+static void _telemetry_on_legacy_msg(const uint8_t *p_data, int len);
 
 //------------------------- STATIC DATA & CONSTANTS ---------------------------
+static topic_router_t router;
+static telemetry_on_new_message_cb_t legacy_msg_cbk;
 
 //------------------------------- GLOBAL DATA ---------------------------------
 
 //------------------------------ PUBLIC FUNCTIONS -----------------------------
 telemetry_err_t telemetry_init(void)
 {
+    driver_telemetry_register_on_connected(_telemetry_on_connected);
+    driver_telemetry_register_on_data(_telemetry_on_data);
+    driver_telemetry_register_on_published(telemetry_outbox_on_published);
     return driver_telemetry_init();
 }
 
 telemetry_err_t telemetry_connection_status_update(const char *p_msg, bool retain)
 {
-    return driver_telemetry_conn_status_update(p_msg, retain);
+    return telemetry_outbox_send(p_msg, strlen(p_msg), retain);
+}
+
+telemetry_err_t telemetry_send_report(const telemetry_report_t *p_report, bool retain)
+{
+    uint8_t buf[TELEMETRY_REPORT_SIZE_MAX];
+    size_t len = telemetry_report_encode(p_report, buf, sizeof(buf));
+    return ((0u != len) ? (telemetry_outbox_send(buf, len, retain)) : (TELEMETRY_SEND_FAILED));
 }
   
 void telemetry_register_on_new_message(telemetry_on_new_message_cb_t cbk)
 {
-    driver_telemetry_register_on_new_msg(cbk);
+    legacy_msg_cbk = cbk;
+    if (NULL != cbk)
+    {
+        (void)telemetry_subscribe(MQTT_HOMEWORK_TOPIC, _telemetry_on_legacy_msg);
+    }
+}
+
+telemetry_err_t telemetry_publish(const char *p_topic, const void *p_data, int len, 
+                                  int qos, bool retain)
+{
+    return driver_telemetry_publish(p_topic, p_data, len, qos, retain);
+}
+
+int telemetry_outbox_size(void)
+{
+    return driver_telemetry_outbox_size();
+}
+
+int telemetry_pending_results(void)
+{
+    return telemetry_outbox_pending();
+}
+
+telemetry_err_t telemetry_subscribe(const char *p_topic, telemetry_on_data_cb_t cbk)
+{
+    /* A route is only kept for a filter the broker was asked for or that the next connect renews */
+    bool b_connected = driver_telemetry_is_connected();
+    if (b_connected && (TELEMETRY_OK != driver_telemetry_subscribe(p_topic)))
+    {
+        return TELEMETRY_SUB_FAILED;
+    }
+    /* Tasks subscribing at once must not take the same free route */
+    driver_telemetry_lock();
+    bool b_added = topic_router_add(&router, p_topic, cbk);
+    driver_telemetry_unlock();
+    if (!b_added)
+    {
+        return TELEMETRY_SUB_FAILED;
+    }
+    /* Connected meanwhile, the renewal may have run before the route was there */
+    if ((!b_connected) && driver_telemetry_is_connected())
+    {
+        (void)driver_telemetry_subscribe(p_topic);
+    }
+    return TELEMETRY_OK;
 }
 
 telemetry_err_t telemetry_disconnect(void)
@@ -43,5 +126,42 @@ telemetry_err_t telemetry_disconnect(void)
     return driver_telemetry_disconnect();
 }
 //---------------------------- PRIVATE FUNCTIONS ------------------------------
+static void _telemetry_on_data(const char *p_topic, int topic_len, 
+                               const uint8_t *p_data, int len)
+{
+    (void)topic_router_dispatch(&router, p_topic, topic_len, p_data, len);
+}
 
+static void _telemetry_on_connected(void)
+{
+    /* A filter with several callbacks has a route for each, it is subscribed once */
+    uint8_t route_num = topic_router_count(&router);
+    for (uint8_t i = 0; i < route_num; i++)
+    {
+        bool b_first = true;
+        for (uint8_t j = 0; (j < i) && b_first; j++)
+        {
+            b_first = (0 != strcmp(router.routes[j].p_filter, router.routes[i].p_filter));
+        }
+        if (b_first)
+        {
+            driver_telemetry_subscribe(router.routes[i].p_filter);
+        }
+    }
+    telemetry_outbox_flush();
+}
+
+static void _telemetry_on_legacy_msg(const uint8_t *p_data, int len)
+{
+    telemetry_on_new_message_cb_t cbk = legacy_msg_cbk;
+    if (NULL != cbk)
+    {
+        /* The legacy callback takes a terminated string it may modify */
+        char msg[TELEMETRY_LEGACY_MSG_SIZE];
+        int msg_len = ((len < (int)sizeof(msg)) ? (len) : ((int)sizeof(msg) - 1));
+        memcpy(msg, p_data, msg_len);
+        msg[msg_len] = '\0';
+        cbk(msg);
+    }
+}
 //---------------------------- INTERRUPT HANDLERS -----------------------------
@@ -18,6 +18,7 @@ extern "C" {
 
 //--------------------------------- INCLUDES ----------------------------------
 #include "app_mqtt_defines.h"
+#include "telemetry_report.h"
 #include <stdbool.h>
 //---------------------------------- MACROS -----------------------------------
 
@@ -28,13 +29,38 @@ extern "C" {
 // Init telemtry (init MQTT clients and subscribe).
 telemetry_err_t telemetry_init(void);
 
-// Send a MQTT message
+// Send a result on the score topic. While offline results are queued, and kept
+// in NVS once more than TELEMETRY_OUTBOX_RAM_LEN are waiting, then published 
+// on the next connect. A retained result replaces the queued retained one.
 telemetry_err_t telemetry_connection_status_update(const char *p_msg, bool retain);
 
-// Register a callback that will give updated status.
-// If set se NULL it should unregister the callback.  
+// Send a game report on MQTT_SCORE_TOPIC, encoded and queued like the results above.
+// A won game also goes to MQTT_HOMEWORK_TOPIC as a legacy "score,owner" string.
+// Receivers decode either with telemetry_report_decode().
+telemetry_err_t telemetry_send_report(const telemetry_report_t *p_report, bool retain);
+
+// Register a callback that will give updated status, every message on the score
+// topic as a terminated string. If set se NULL it should unregister the callback.  
 void telemetry_register_on_new_message(telemetry_on_new_message_cb_t cbk);
 
+// Queue a binary message on any topic, never waits for the network.
+telemetry_err_t telemetry_publish(const char *p_topic, const void *p_data, int len, 
+                                  int qos, bool retain);
+
+// Bytes of messages still waiting to be sent, for callers that rate limit themselves.
+int telemetry_outbox_size(void);
+
+// Results queued by telemetry_connection_status_update() until the next connect.
+int telemetry_pending_results(void);
+
+// Subscribe to a topic filter, the callback gets every message received on a
+// matching topic. + and # wildcards fill whole levels, # only the last one. A
+// topic can have several callbacks. Up to MQTT_SUBSCRIPTIONS_MAX callbacks can be
+// subscribed, subscriptions made while disconnected are sent on the next
+// connect, and renewed on every one. One the connected client could not send
+// is not kept.
+telemetry_err_t telemetry_subscribe(const char *p_topic, telemetry_on_data_cb_t cbk);
+
 // Disconnects from MQTT client.
 telemetry_err_t telemetry_disconnect(void);
 
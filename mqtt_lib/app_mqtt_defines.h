@@ -14,13 +14,34 @@ extern "C" {
 #endif
 
 //--------------------------------- INCLUDES ----------------------------------
-
+#include <stdint.h>
 //---------------------------------- MACROS -----------------------------------
+#ifndef MQTT_BROKER_SOCKET
 #define MQTT_BROKER_SOCKET  "mqtt://3q6j.l.time4vps.cloud"
-#define MQTT_HOMEWORK_TOPIC "/blesa/game/asii/highest_score"
+#endif
+#define MQTT_HOMEWORK_TOPIC "/blesa/game/asii/highest_score" /* legacy "score,owner" strings */
+#define MQTT_SCORE_TOPIC MQTT_HOMEWORK_TOPIC "/v1"             /* binary game reports */
+#define MQTT_SPECTATOR_TOPIC "/blesa/game/asii/spectate"
+#define MQTT_CONTROL_TOPIC "/blesa/game/asii/control"
+#define MQTT_CONTROL_ACK_TOPIC "/blesa/game/asii/control/ack"
+#define MQTT_METRICS_TOPIC "/blesa/game/asii/metrics" /* followed by "/" and the device */
+
+#define MQTT_SUBSCRIPTIONS_MAX (8u)
 //-------------------------------- DATA TYPES ---------------------------------
 typedef void (*telemetry_on_new_message_cb_t)(char *p_msg);
 
+/* Payloads are binary and not terminated */
+typedef void (*telemetry_on_data_cb_t)(const uint8_t *p_data, int len);
+
+/* Used by the drivers, the topic is not terminated either */
+typedef void (*telemetry_on_topic_data_cb_t)(const char *p_topic, int topic_len, 
+                                             const uint8_t *p_data, int len);
+
+typedef void (*telemetry_on_connected_cb_t)(void);
+
+/* The broker acknowledged the QoS 1 message with the given id */
+typedef void (*telemetry_on_published_cb_t)(int msg_id);
+
 typedef enum
 {
    TELEMETRY_OK = 0,
@@ -28,6 +49,7 @@ typedef enum
     // Errors:
    TELEMETRY_INIT_FAILED = -10,
    TELEMETRY_SEND_FAILED = -20,
+   TELEMETRY_SUB_FAILED = -30,
   
    TELEMETRY_COUNT
 } telemetry_err_t;
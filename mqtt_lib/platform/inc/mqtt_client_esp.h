@@ -19,13 +19,15 @@ extern "C" {
 //--------------------------------- INCLUDES ----------------------------------
 #include "app_mqtt_defines.h"
 #include <stdbool.h>
+#include <stddef.h>
 //---------------------------------- MACROS -----------------------------------
 
 //-------------------------------- DATA TYPES ---------------------------------
 
 //---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
 /**
- * It initializes the MQTT client and subscribes to the topic
+ * It initializes the MQTT client, subscriptions are made by the on 
+ *       connected callback
  * 
  * @return the result of the initialization of the telemetry driver.
  */
@@ -42,12 +44,123 @@ telemetry_err_t driver_telemetry_init(void);
 telemetry_err_t driver_telemetry_conn_status_update(const char *p_msg, bool retain);
 
 /**
- * This function registers a callback function to be called 
- *        when a new message is received.
+ * It queues a binary message for the MQTT client task to publish, without 
+ *       waiting for the network.
  * 
- * @param cbk The callback function to be called when a new message is received.
+ * @param p_topic The topic to publish to.
+ * @param p_data The payload.
+ * @param len The length of the payload.
+ * @param qos The QoS level of the message.
+ * @param retain true if the broker should keep the message for new subscribers.
+ * 
+ * @return The return value is the result of the function call.
+ */
+telemetry_err_t driver_telemetry_publish(const char *p_topic, const void *p_data, int len, 
+                                         int qos, bool retain);
+
+/**
+ * It queues a message with QoS 1, the on published callback gets its id once
+ *        the broker acknowledged it.
+ * 
+ * @param p_topic The topic.
+ * @param p_data The payload.
+ * @param len The length of the payload.
+ * @param retain true if the broker should keep the message for new subscribers.
+ * 
+ * @return The id of the message, negative if it could not be queued.
+ */
+int driver_telemetry_publish_acked(const char *p_topic, const void *p_data, int len, bool retain);
+
+/**
+ * It returns how many bytes of messages are still waiting in the outbox.
+ * 
+ * @return The size of the outbox, 0 if the client is not running.
+ */
+int driver_telemetry_outbox_size(void);
+
+/**
+ * It tells whether the client is connected to the broker, subscriptions fail
+ *        while it is not.
+ * 
+ * @return true if it is connected.
+ */
+bool driver_telemetry_is_connected(void);
+
+/**
+ * It subscribes to a topic, messages arrive at the on data callback.
+ * 
+ * @param p_topic The topic to subscribe to.
+ * 
+ * @return The return value is the result of the function call.
+ */
+telemetry_err_t driver_telemetry_subscribe(const char *p_topic);
+
+/**
+ * This function registers a callback function that gets every received message 
+ *        together with its topic.
+ * 
+ * @param cbk The callback function.
+ */
+void driver_telemetry_register_on_data(telemetry_on_topic_data_cb_t cbk);
+
+/**
+ * This function registers a callback function to be called every time 
+ *        the client (re)connects to the broker.
+ * 
+ * @param cbk The callback function.
+ */
+void driver_telemetry_register_on_connected(telemetry_on_connected_cb_t cbk);
+
+/**
+ * This function registers a callback function to be called every time the 
+ *        broker acknowledges a message queued by driver_telemetry_publish_acked().
+ * 
+ * @param cbk The callback function.
+ */
+void driver_telemetry_register_on_published(telemetry_on_published_cb_t cbk);
+
+/**
+ * It takes the lock of the telemetry state shared between tasks, the outbox 
+ *       with its persistent store and the routes of the subscriptions. It can 
+ *       be taken before the driver is initialized, and is never held while 
+ *       the client waits on it.
+ */
+void driver_telemetry_lock(void);
+
+/**
+ * It releases the lock taken by driver_telemetry_lock().
+ */
+void driver_telemetry_unlock(void);
+
+/**
+ * It writes a slot of the persistent store the telemetry outbox spills to, 
+ *       replacing its content.
+ * 
+ * @param slot The slot, any small number.
+ * @param p_data The content.
+ * @param len The length of the content.
+ * 
+ * @return true if the slot was written.
+ */
+bool driver_telemetry_store_write(uint8_t slot, const void *p_data, size_t len);
+
+/**
+ * It reads a slot of the persistent store.
+ * 
+ * @param slot The slot.
+ * @param p_data The buffer for the content.
+ * @param len The size of the buffer.
+ * 
+ * @return The length of the content, 0 if the slot is empty or does not fit.
+ */
+size_t driver_telemetry_store_read(uint8_t slot, void *p_data, size_t len);
+
+/**
+ * It empties a slot of the persistent store.
+ * 
+ * @param slot The slot.
  */
-void driver_telemetry_register_on_new_msg(telemetry_on_new_message_cb_t cbk);
+void driver_telemetry_store_erase(uint8_t slot);
 
 /**
  * It disconnects from the MQTT client
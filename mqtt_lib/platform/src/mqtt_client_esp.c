@@ -15,12 +15,31 @@
 #include "esp_err.h"
 #include "esp_log.h"
 #include "esp_event.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include "mqtt_client.h"
+#include "nvs.h"
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 //---------------------------------- MACROS -----------------------------------
+#define MQTT_STORE_NAMESPACE "telemetry"
+#define MQTT_STORE_KEY_LEN   (8u)
+#ifndef MQTT_RX_REASSEMBLY_SIZE
+#define MQTT_RX_REASSEMBLY_SIZE (4u * 1024u) /* largest fragmented message taken */
+#endif
+#define MQTT_RX_TOPIC_MAX    (128u)
 
 //-------------------------------- DATA TYPES ---------------------------------
-
+typedef struct
+{
+    char     topic[MQTT_RX_TOPIC_MAX]; /* only the first fragment carries it */
+    int      topic_len;
+    int      total_len;
+    int      received;
+    bool     b_active;
+    uint8_t *p_data;                   /* allocated once, kept for every message */
+} mqtt_rx_assembly_t;
 //---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
 /**
  * It initializes the MQTT client and registers a callback function to handle MQTT events
@@ -45,7 +64,7 @@ static esp_err_t _driver_telemetry_conn_status_update(const char *p_msg, bool re
  * 
  * @return The return value is the result of the subscribe operation.
  */
-static esp_err_t _driver_telemetry_sub(char *p_topic);
+static esp_err_t _driver_telemetry_sub(const char *p_topic);
 
 /**
  * It's a callback function that is called when an event is received from the MQTT client
@@ -59,23 +78,44 @@ static esp_err_t _driver_telemetry_sub(char *p_topic);
 static void _mqtt_event_handler(void *handler_args, esp_event_base_t base, 
                                 int32_t event_id, void *event_data);
 
+/**
+ * It passes a whole message on in place, and reassembles a fragmented one 
+ *       before passing it on.
+ * 
+ * @param event The data event, one fragment of a message.
+ */
+static void _driver_on_data(esp_mqtt_event_handle_t event);
+
+/**
+ * It passes a whole message to the registered callbacks.
+ * 
+ * @param p_topic The topic, not terminated.
+ * @param topic_len The length of the topic.
+ * @param p_data The payload.
+ * @param len The length of the payload.
+ */
+static void _driver_dispatch(const char *p_topic, int topic_len, const uint8_t *p_data, int len);
+
 
 //------------------------- STATIC DATA & CONSTANTS ---------------------------
-static telemetry_on_new_message_cb_t tele_new_msg_cbk;
+static telemetry_on_topic_data_cb_t tele_data_cbk;
+static telemetry_on_connected_cb_t tele_connected_cbk;
+static telemetry_on_published_cb_t tele_published_cbk;
+static StaticSemaphore_t tele_lock_buf;
+static SemaphoreHandle_t tele_lock;
+static portMUX_TYPE tele_lock_mux = portMUX_INITIALIZER_UNLOCKED;
 static const char *TAG = "MQTT_client_esp";
 static esp_mqtt_client_handle_t mqtt_cl;
-static char buff[30];
+static volatile bool b_connected;
+static mqtt_rx_assembly_t rx_assembly;
+static uint32_t rx_dropped;
 //------------------------------- GLOBAL DATA ---------------------------------
 
 //------------------------------ PUBLIC FUNCTIONS -----------------------------
 telemetry_err_t driver_telemetry_init(void)
 {
+    /* Subscriptions are made by the on connected callback */
     esp_err_t err = _driver_telemetry_init();
-    vTaskDelay(1);
-    if (ESP_OK == err)
-    {
-        err = _driver_telemetry_sub(MQTT_HOMEWORK_TOPIC);
-    }
     return ((ESP_OK == err) ? (TELEMETRY_OK) : (TELEMETRY_INIT_FAILED));
 }
 
@@ -85,9 +125,125 @@ telemetry_err_t driver_telemetry_conn_status_update(const char *p_msg, bool reta
     return ((ESP_OK == err) ? (TELEMETRY_OK) : (TELEMETRY_SEND_FAILED));
 }
 
-void driver_telemetry_register_on_new_msg(telemetry_on_new_message_cb_t cbk)
+telemetry_err_t driver_telemetry_publish(const char *p_topic, const void *p_data, int len, 
+                                         int qos, bool retain)
+{
+    if (NULL == mqtt_cl)
+    {
+        return TELEMETRY_SEND_FAILED;
+    }
+    /* Stored in the outbox and sent by the MQTT task, the caller never waits for the network */
+    int msg_id = esp_mqtt_client_enqueue(mqtt_cl, p_topic, p_data, len, qos, retain, true);
+    return ((0 <= msg_id) ? (TELEMETRY_OK) : (TELEMETRY_SEND_FAILED));
+}
+
+int driver_telemetry_publish_acked(const char *p_topic, const void *p_data, int len, bool retain)
+{
+    if (NULL == mqtt_cl)
+    {
+        return -1;
+    }
+    /* Kept in the outbox of the client until MQTT_EVENT_PUBLISHED */
+    return esp_mqtt_client_enqueue(mqtt_cl, p_topic, p_data, len, 1, retain, true);
+}
+
+int driver_telemetry_outbox_size(void)
+{
+    return ((NULL != mqtt_cl) ? (esp_mqtt_client_get_outbox_size(mqtt_cl)) : (0));
+}
+
+bool driver_telemetry_is_connected(void)
+{
+    return b_connected;
+}
+
+telemetry_err_t driver_telemetry_subscribe(const char *p_topic)
+{
+    esp_err_t err = _driver_telemetry_sub(p_topic);
+    return ((ESP_OK == err) ? (TELEMETRY_OK) : (TELEMETRY_SUB_FAILED));
+}
+
+void driver_telemetry_register_on_data(telemetry_on_topic_data_cb_t cbk)
+{
+    tele_data_cbk = cbk;
+}
+
+void driver_telemetry_register_on_connected(telemetry_on_connected_cb_t cbk)
+{
+    tele_connected_cbk = cbk;
+}
+
+void driver_telemetry_register_on_published(telemetry_on_published_cb_t cbk)
+{
+    tele_published_cbk = cbk;
+}
+
+void driver_telemetry_lock(void)
+{
+    /* Results can be queued before the driver is initialized */
+    if (NULL == tele_lock)
+    {
+        portENTER_CRITICAL(&tele_lock_mux);
+        if (NULL == tele_lock)
+        {
+            tele_lock = xSemaphoreCreateMutexStatic(&tele_lock_buf);
+        }
+        portEXIT_CRITICAL(&tele_lock_mux);
+    }
+    (void)xSemaphoreTake(tele_lock, portMAX_DELAY);
+}
+
+void driver_telemetry_unlock(void)
+{
+    (void)xSemaphoreGive(tele_lock);
+}
+
+bool driver_telemetry_store_write(uint8_t slot, const void *p_data, size_t len)
 {
-    tele_new_msg_cbk = cbk;
+    nvs_handle_t handle;
+    char key[MQTT_STORE_KEY_LEN];
+    esp_err_t err = nvs_open(MQTT_STORE_NAMESPACE, NVS_READWRITE, &handle);
+    if (ESP_OK == err)
+    {
+        snprintf(key, sizeof(key), "obx%u", slot);
+        err = nvs_set_blob(handle, key, p_data, len);
+        if (ESP_OK == err)
+        {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    return (ESP_OK == err);
+}
+
+size_t driver_telemetry_store_read(uint8_t slot, void *p_data, size_t len)
+{
+    nvs_handle_t handle;
+    char key[MQTT_STORE_KEY_LEN];
+    /* The namespace only exists once something was written to it */
+    esp_err_t err = nvs_open(MQTT_STORE_NAMESPACE, NVS_READONLY, &handle);
+    if (ESP_OK == err)
+    {
+        snprintf(key, sizeof(key), "obx%u", slot);
+        err = nvs_get_blob(handle, key, p_data, &len);
+        nvs_close(handle);
+    }
+    return ((ESP_OK == err) ? (len) : (0u));
+}
+
+void driver_telemetry_store_erase(uint8_t slot)
+{
+    nvs_handle_t handle;
+    char key[MQTT_STORE_KEY_LEN];
+    if (ESP_OK == nvs_open(MQTT_STORE_NAMESPACE, NVS_READWRITE, &handle))
+    {
+        snprintf(key, sizeof(key), "obx%u", slot);
+        if (ESP_OK == nvs_erase_key(handle, key))
+        {
+            (void)nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
 }
 
 telemetry_err_t driver_telemetry_disconnect(void)
@@ -127,7 +283,7 @@ static esp_err_t _driver_telemetry_conn_status_update(const char *p_msg, bool re
     return ((0 <= sent_msg_id) ? (ESP_OK) : (ESP_FAIL));
 }
 
-static esp_err_t _driver_telemetry_sub(char *p_topic)
+static esp_err_t _driver_telemetry_sub(const char *p_topic)
 {
     if (NULL == mqtt_cl)
     {
@@ -145,17 +301,26 @@ static void _mqtt_event_handler(void *handler_args, esp_event_base_t base, int32
     switch ((esp_mqtt_event_id_t)event_id) {
         case MQTT_EVENT_CONNECTED:
             mqtt_cl = client;
+            b_connected = true;
+            if (NULL != tele_connected_cbk)
+            {
+                tele_connected_cbk();
+            }
         break;
 
         case MQTT_EVENT_DISCONNECTED:
+            b_connected = false;
             mqtt_cl = NULL;
         break;
 
         case MQTT_EVENT_DATA:
-            if (NULL != tele_new_msg_cbk)
+            _driver_on_data(event);
+        break;
+
+        case MQTT_EVENT_PUBLISHED:
+            if (NULL != tele_published_cbk)
             {
-                strncpy(buff, event->data, event->data_len);
-                tele_new_msg_cbk(buff);
+                tele_published_cbk(event->msg_id);
             }
         break;
 
@@ -164,4 +329,69 @@ static void _mqtt_event_handler(void *handler_args, esp_event_base_t base, int32
         break;
     }
 }
+
+static void _driver_on_data(esp_mqtt_event_handle_t event)
+{
+    mqtt_rx_assembly_t *p_rx = &rx_assembly;
+
+    if ((0 == event->current_data_offset) && (event->data_len == event->total_data_len))
+    {
+        /* Whole, parsed in place in the receive buffer of the client */
+        _driver_dispatch(event->topic, event->topic_len, (const uint8_t *)event->data, event->data_len);
+        return;
+    }
+
+    if (0 == event->current_data_offset)
+    {
+        if (p_rx->b_active)
+        {
+            rx_dropped++;
+        }
+        if (NULL == p_rx->p_data)
+        {
+            p_rx->p_data = malloc(MQTT_RX_REASSEMBLY_SIZE);
+        }
+        p_rx->b_active = ((NULL != p_rx->p_data) && (MQTT_RX_REASSEMBLY_SIZE >= event->total_data_len) &&
+                          (MQTT_RX_TOPIC_MAX >= event->topic_len));
+        if (!p_rx->b_active)
+        {
+            rx_dropped++;
+            ESP_LOGW(TAG, "Dropped a %d byte message, %u so far", event->total_data_len, rx_dropped);
+            return;
+        }
+        memcpy(p_rx->topic, event->topic, event->topic_len);
+        p_rx->topic_len = event->topic_len;
+        p_rx->total_len = event->total_data_len;
+        p_rx->received = 0;
+    }
+
+    if (!p_rx->b_active)
+    {
+        /* The rest of a message that did not fit */
+        return;
+    }
+    if ((event->current_data_offset != p_rx->received) ||
+        ((p_rx->total_len - p_rx->received) < event->data_len))
+    {
+        p_rx->b_active = false;
+        rx_dropped++;
+        ESP_LOGW(TAG, "Dropped a message with a fragment out of order");
+        return;
+    }
+    memcpy(p_rx->p_data + p_rx->received, event->data, event->data_len);
+    p_rx->received += event->data_len;
+    if (p_rx->received == p_rx->total_len)
+    {
+        p_rx->b_active = false;
+        _driver_dispatch(p_rx->topic, p_rx->topic_len, p_rx->p_data, p_rx->total_len);
+    }
+}
+
+static void _driver_dispatch(const char *p_topic, int topic_len, const uint8_t *p_data, int len)
+{
+    if (NULL != tele_data_cbk)
+    {
+        tele_data_cbk(p_topic, topic_len, p_data, len);
+    }
+}
 //---------------------------- INTERRUPT HANDLERS -----------------------------
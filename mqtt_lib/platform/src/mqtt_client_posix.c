@@ -0,0 +1,581 @@
+/**
+* @file mqtt_client_posix.c
+
+* @brief Mqtt client POSIX driver
+
+* @par Host build of the driver interface in mqtt_client_esp.h. A minimal MQTT 3.1.1
+*       client on a TCP socket, so the telemetry API and everything using it can run
+*       on a PC against a local broker. Messages are queued in an outbox and written
+*       by a driver thread, like the outbox of the ESP-IDF client.
+*
+*       The broker is MQTT_BROKER_SOCKET, or the MQTT_BROKER environment variable
+*       ("mqtt://host:port"). MQTT_UPLINK_BPS limits the bytes per second the driver
+*       thread writes, which simulates a slow uplink that lets the outbox back up.
+*       The persistent store of the telemetry outbox is a file per slot in the
+*       MQTT_OUTBOX_DIR directory, without it nothing persists.
+*
+* COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "mqtt_client_esp.h"
+#include "app_mqtt_defines.h"
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+//---------------------------------- MACROS -----------------------------------
+#define MQTT_DEFAULT_PORT       (1883)
+#define MQTT_KEEPALIVE_S        (60u)
+#define MQTT_OUTBOX_SIZE        (64u * 1024u)
+#define MQTT_RX_SIZE            (16u * 1024u)
+#define MQTT_STORE_PATH_LEN     (256u)
+
+#define MQTT_PKT_CONNECT        (0x10u)
+#define MQTT_PKT_CONNACK        (0x20u)
+#define MQTT_PKT_PUBLISH        (0x30u)
+#define MQTT_PKT_PUBACK         (0x40u)
+#define MQTT_PKT_SUBSCRIBE      (0x82u)
+#define MQTT_PKT_PINGREQ        (0xC0u)
+#define MQTT_PKT_DISCONNECT     (0xE0u)
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+/**
+ * It connects the socket to the broker and exchanges CONNECT and CONNACK.
+ *
+ * @return true if the broker accepted the connection.
+ */
+static bool _mqtt_connect(void);
+
+/**
+ * It appends a packet with the given fixed header to the outbox.
+ *
+ * @param type The first byte of the fixed header.
+ * @param p_var The variable header and payload, in parts.
+ * @param var_len The lengths of the parts.
+ * @param parts The number of parts.
+ *
+ * @return true if the packet fit into the outbox.
+ */
+static bool _mqtt_queue(uint8_t type, const void *p_var[], const int var_len[], int parts);
+
+/**
+ * It writes the outbox to the socket and dispatches received packets
+ *       until the driver is disconnected.
+ *
+ * @param p_arg Unused.
+ *
+ * @return Always NULL.
+ */
+static void *_mqtt_thread(void *p_arg);
+
+/**
+ * It handles one received packet.
+ *
+ * @param type The first byte of the fixed header.
+ * @param p_data The rest of the packet.
+ * @param len The length of the rest of the packet.
+ */
+static void _mqtt_on_packet(uint8_t type, const uint8_t *p_data, int len);
+
+/**
+ * It returns the monotonic time.
+ *
+ * @return Milliseconds since an arbitrary point.
+ */
+static unsigned long _mqtt_millis(void);
+
+/**
+ * It returns the file of a slot of the persistent store.
+ *
+ * @param slot The slot.
+ * @param p_path The buffer for the path, MQTT_STORE_PATH_LEN long.
+ *
+ * @return true if there is a store.
+ */
+static bool _mqtt_store_path(uint8_t slot, char *p_path);
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static telemetry_on_topic_data_cb_t tele_data_cbk;
+static telemetry_on_connected_cb_t tele_connected_cbk;
+static telemetry_on_published_cb_t tele_published_cbk;
+static pthread_mutex_t tele_lock = PTHREAD_MUTEX_INITIALIZER;
+static int mqtt_sock = -1;
+static int wake_pipe[2] = {-1, -1};
+static pthread_t mqtt_thread;
+static pthread_mutex_t outbox_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint8_t outbox[MQTT_OUTBOX_SIZE];
+static int outbox_len;
+static uint16_t packet_id;
+static unsigned long uplink_bps;
+static volatile bool b_running;
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+telemetry_err_t driver_telemetry_init(void)
+{
+    const char *p_bps = getenv("MQTT_UPLINK_BPS");
+    uplink_bps = (NULL != p_bps) ? (strtoul(p_bps, NULL, 10)) : (0);
+
+    if (!_mqtt_connect() || (0 != pipe(wake_pipe)))
+    {
+        return TELEMETRY_INIT_FAILED;
+    }
+    /* Wake ups only need to be pending, a full pipe must not block a publisher */
+    fcntl(wake_pipe[1], F_SETFL, O_NONBLOCK);
+    b_running = true;
+    if (0 != pthread_create(&mqtt_thread, NULL, _mqtt_thread, NULL))
+    {
+        b_running = false;
+        return TELEMETRY_INIT_FAILED;
+    }
+    if (NULL != tele_connected_cbk)
+    {
+        tele_connected_cbk();
+    }
+    return TELEMETRY_OK;
+}
+
+telemetry_err_t driver_telemetry_conn_status_update(const char *p_msg, bool retain)
+{
+    return driver_telemetry_publish(MQTT_HOMEWORK_TOPIC, p_msg, strlen(p_msg), 0, retain);
+}
+
+telemetry_err_t driver_telemetry_publish(const char *p_topic, const void *p_data, int len,
+                                         int qos, bool retain)
+{
+    if (!b_running)
+    {
+        return TELEMETRY_SEND_FAILED;
+    }
+    uint8_t topic_hdr[2] = { strlen(p_topic) >> 8, strlen(p_topic) & 0xFF };
+    uint8_t id[2] = { 0 };
+    const void *p_parts[] = { topic_hdr, p_topic, id, p_data };
+    int part_len[] = { 2, strlen(p_topic), (0 < qos) ? (2) : (0), len };
+
+    pthread_mutex_lock(&outbox_lock);
+    if (0 < qos)
+    {
+        packet_id = (0 == packet_id + 1) ? (1) : (packet_id + 1);
+        id[0] = packet_id >> 8;
+        id[1] = packet_id & 0xFF;
+    }
+    bool b_ok = _mqtt_queue(MQTT_PKT_PUBLISH | ((0 < qos) ? (0x02) : (0)) | (retain ? (0x01) : (0)),
+                            p_parts, part_len, 4);
+    pthread_mutex_unlock(&outbox_lock);
+    return (b_ok ? (TELEMETRY_OK) : (TELEMETRY_SEND_FAILED));
+}
+
+int driver_telemetry_publish_acked(const char *p_topic, const void *p_data, int len, bool retain)
+{
+    if (!b_running)
+    {
+        return -1;
+    }
+    uint8_t topic_hdr[2] = { strlen(p_topic) >> 8, strlen(p_topic) & 0xFF };
+    uint8_t id[2];
+    const void *p_parts[] = { topic_hdr, p_topic, id, p_data };
+    int part_len[] = { 2, strlen(p_topic), 2, len };
+
+    pthread_mutex_lock(&outbox_lock);
+    packet_id = (0 == packet_id + 1) ? (1) : (packet_id + 1);
+    int msg_id = packet_id;
+    id[0] = packet_id >> 8;
+    id[1] = packet_id & 0xFF;
+    bool b_ok = _mqtt_queue(MQTT_PKT_PUBLISH | 0x02 | (retain ? (0x01) : (0)), p_parts, part_len, 4);
+    pthread_mutex_unlock(&outbox_lock);
+    return (b_ok ? (msg_id) : (-1));
+}
+
+int driver_telemetry_outbox_size(void)
+{
+    pthread_mutex_lock(&outbox_lock);
+    int len = outbox_len;
+    pthread_mutex_unlock(&outbox_lock);
+    return len;
+}
+
+bool driver_telemetry_is_connected(void)
+{
+    return b_running;
+}
+
+telemetry_err_t driver_telemetry_subscribe(const char *p_topic)
+{
+    if (!b_running)
+    {
+        return TELEMETRY_SUB_FAILED;
+    }
+    uint8_t topic_hdr[2] = { strlen(p_topic) >> 8, strlen(p_topic) & 0xFF };
+    uint8_t id[2];
+    uint8_t qos = 0;
+    const void *p_parts[] = { id, topic_hdr, p_topic, &qos };
+    int part_len[] = { 2, 2, strlen(p_topic), 1 };
+
+    pthread_mutex_lock(&outbox_lock);
+    packet_id = (0 == packet_id + 1) ? (1) : (packet_id + 1);
+    id[0] = packet_id >> 8;
+    id[1] = packet_id & 0xFF;
+    bool b_ok = _mqtt_queue(MQTT_PKT_SUBSCRIBE, p_parts, part_len, 4);
+    pthread_mutex_unlock(&outbox_lock);
+    return (b_ok ? (TELEMETRY_OK) : (TELEMETRY_SUB_FAILED));
+}
+
+void driver_telemetry_register_on_data(telemetry_on_topic_data_cb_t cbk)
+{
+    tele_data_cbk = cbk;
+}
+
+void driver_telemetry_register_on_connected(telemetry_on_connected_cb_t cbk)
+{
+    tele_connected_cbk = cbk;
+}
+
+void driver_telemetry_register_on_published(telemetry_on_published_cb_t cbk)
+{
+    tele_published_cbk = cbk;
+}
+
+void driver_telemetry_lock(void)
+{
+    pthread_mutex_lock(&tele_lock);
+}
+
+void driver_telemetry_unlock(void)
+{
+    pthread_mutex_unlock(&tele_lock);
+}
+
+bool driver_telemetry_store_write(uint8_t slot, const void *p_data, size_t len)
+{
+    char path[MQTT_STORE_PATH_LEN];
+    char tmp[MQTT_STORE_PATH_LEN + 4];
+    if (!_mqtt_store_path(slot, path))
+    {
+        return false;
+    }
+    /* Renamed over the slot, so it holds either the old or the new content */
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE *p_file = fopen(tmp, "wb");
+    if (NULL == p_file)
+    {
+        return false;
+    }
+    bool b_ok = (len == fwrite(p_data, 1, len, p_file));
+    b_ok = (0 == fclose(p_file)) && b_ok;
+    return b_ok && (0 == rename(tmp, path));
+}
+
+size_t driver_telemetry_store_read(uint8_t slot, void *p_data, size_t len)
+{
+    char path[MQTT_STORE_PATH_LEN];
+    FILE *p_file = (_mqtt_store_path(slot, path) ? (fopen(path, "rb")) : (NULL));
+    if (NULL == p_file)
+    {
+        return 0u;
+    }
+    size_t got = fread(p_data, 1, len, p_file);
+    /* Like an NVS blob, content larger than the buffer is not read at all */
+    bool b_fits = (EOF == fgetc(p_file));
+    fclose(p_file);
+    return (b_fits ? (got) : (0u));
+}
+
+void driver_telemetry_store_erase(uint8_t slot)
+{
+    char path[MQTT_STORE_PATH_LEN];
+    if (_mqtt_store_path(slot, path))
+    {
+        (void)remove(path);
+    }
+}
+
+telemetry_err_t driver_telemetry_disconnect(void)
+{
+    /* The thread may already have stopped on a lost connection, it is joined anyway */
+    if (0 > mqtt_sock)
+    {
+        return TELEMETRY_SEND_FAILED;
+    }
+    pthread_mutex_lock(&outbox_lock);
+    _mqtt_queue(MQTT_PKT_DISCONNECT, NULL, NULL, 0);
+    pthread_mutex_unlock(&outbox_lock);
+
+    /* The thread leaves once the outbox, ending with DISCONNECT, is written */
+    b_running = false;
+    (void)write(wake_pipe[1], "", 1);
+    pthread_join(mqtt_thread, NULL);
+    close(mqtt_sock);
+    close(wake_pipe[0]);
+    close(wake_pipe[1]);
+    mqtt_sock = -1;
+    return TELEMETRY_OK;
+}
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static bool _mqtt_connect(void)
+{
+    const char *p_uri = getenv("MQTT_BROKER");
+    char host[128];
+    char port[8];
+    int port_num = MQTT_DEFAULT_PORT;
+
+    if (NULL == p_uri)
+    {
+        p_uri = MQTT_BROKER_SOCKET;
+    }
+    if (0 == strncmp(p_uri, "mqtt://", 7))
+    {
+        p_uri += 7;
+    }
+    snprintf(host, sizeof(host), "%s", p_uri);
+    char *p_colon = strchr(host, ':');
+    if (NULL != p_colon)
+    {
+        *p_colon = '\0';
+        port_num = atoi(p_colon + 1);
+    }
+    snprintf(port, sizeof(port), "%d", port_num);
+
+    struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM };
+    struct addrinfo *p_res = NULL;
+    if (0 != getaddrinfo(host, port, &hints, &p_res))
+    {
+        return false;
+    }
+    for (struct addrinfo *p_ai = p_res; (NULL != p_ai) && (0 > mqtt_sock); p_ai = p_ai->ai_next)
+    {
+        mqtt_sock = socket(p_ai->ai_family, p_ai->ai_socktype, p_ai->ai_protocol);
+        if ((0 <= mqtt_sock) && (0 != connect(mqtt_sock, p_ai->ai_addr, p_ai->ai_addrlen)))
+        {
+            close(mqtt_sock);
+            mqtt_sock = -1;
+        }
+    }
+    freeaddrinfo(p_res);
+    if (0 > mqtt_sock)
+    {
+        return false;
+    }
+
+    char client_id[32];
+    snprintf(client_id, sizeof(client_id), "aasi-%d", (int)getpid());
+    const uint8_t var_hdr[] = { 0, 4, 'M', 'Q', 'T', 'T', 4, 0x02, 0, MQTT_KEEPALIVE_S };
+    uint8_t id_hdr[2] = { 0, strlen(client_id) };
+    const void *p_parts[] = { var_hdr, id_hdr, client_id };
+    int part_len[] = { sizeof(var_hdr), 2, strlen(client_id) };
+    _mqtt_queue(MQTT_PKT_CONNECT, p_parts, part_len, 3);
+    bool b_ok = (outbox_len == write(mqtt_sock, outbox, outbox_len));
+    outbox_len = 0;
+
+    uint8_t connack[4];
+    b_ok = b_ok && (sizeof(connack) == recv(mqtt_sock, connack, sizeof(connack), MSG_WAITALL));
+    b_ok = b_ok && (MQTT_PKT_CONNACK == connack[0]) && (0 == connack[3]);
+    if (!b_ok)
+    {
+        close(mqtt_sock);
+        mqtt_sock = -1;
+    }
+    return b_ok;
+}
+
+static bool _mqtt_queue(uint8_t type, const void *p_var[], const int var_len[], int parts)
+{
+    int len = 0;
+    for (int i = 0; i < parts; i++)
+    {
+        len += var_len[i];
+    }
+    if ((outbox_len + 5 + len) > (int)MQTT_OUTBOX_SIZE)
+    {
+        return false;
+    }
+
+    outbox[outbox_len++] = type;
+    int remaining = len;
+    do
+    {
+        outbox[outbox_len++] = (remaining & 0x7F) | ((0x7F < remaining) ? (0x80) : (0));
+        remaining >>= 7;
+    } while (0 < remaining);
+    for (int i = 0; i < parts; i++)
+    {
+        memcpy(outbox + outbox_len, p_var[i], var_len[i]);
+        outbox_len += var_len[i];
+    }
+    if (-1 != wake_pipe[1])
+    {
+        (void)write(wake_pipe[1], "", 1);
+    }
+    return true;
+}
+
+static void *_mqtt_thread(void *p_arg)
+{
+    static uint8_t rx[MQTT_RX_SIZE];
+    int rx_len = 0;
+    unsigned long last_tx = _mqtt_millis();
+    unsigned long window_start = last_tx;
+    unsigned long window_bytes = 0;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&outbox_lock);
+        int pending = outbox_len;
+        pthread_mutex_unlock(&outbox_lock);
+        if ((!b_running) && (0 == pending))
+        {
+            break;
+        }
+
+        unsigned long now = _mqtt_millis();
+        if (1000 <= (now - window_start))
+        {
+            window_start = now;
+            window_bytes = 0;
+        }
+        int budget = pending;
+        if ((0 != uplink_bps) && (budget > (long)(uplink_bps - window_bytes)))
+        {
+            budget = uplink_bps - window_bytes;
+        }
+
+        struct pollfd fds[2] = {
+            { .fd = mqtt_sock, .events = POLLIN | ((0 < budget) ? (POLLOUT) : (0)) },
+            { .fd = wake_pipe[0], .events = POLLIN },
+        };
+        if (0 > poll(fds, 2, 50))
+        {
+            continue;
+        }
+        if (fds[1].revents & POLLIN)
+        {
+            char drain[64];
+            (void)read(wake_pipe[0], drain, sizeof(drain));
+        }
+
+        if ((0 < budget) && (fds[0].revents & POLLOUT))
+        {
+            pthread_mutex_lock(&outbox_lock);
+            ssize_t sent = send(mqtt_sock, outbox, budget, MSG_NOSIGNAL);
+            if (0 < sent)
+            {
+                memmove(outbox, outbox + sent, outbox_len - sent);
+                outbox_len -= sent;
+                window_bytes += sent;
+                last_tx = now;
+            }
+            pthread_mutex_unlock(&outbox_lock);
+            if (0 > sent)
+            {
+                break;
+            }
+        }
+        else if ((MQTT_KEEPALIVE_S * 1000 / 2) < (now - last_tx))
+        {
+            pthread_mutex_lock(&outbox_lock);
+            _mqtt_queue(MQTT_PKT_PINGREQ, NULL, NULL, 0);
+            pthread_mutex_unlock(&outbox_lock);
+            last_tx = now;
+        }
+
+        if (fds[0].revents & (POLLIN | POLLHUP))
+        {
+            ssize_t got = recv(mqtt_sock, rx + rx_len, sizeof(rx) - rx_len, 0);
+            if (0 >= got)
+            {
+                break;
+            }
+            rx_len += got;
+
+            /* Dispatch every complete packet in the buffer */
+            int pos = 0;
+            for (;;)
+            {
+                int remaining = 0;
+                int hdr = 1;
+                int shift = 0;
+                while ((pos + hdr < rx_len) && (rx[pos + hdr] & 0x80) && (hdr < 4))
+                {
+                    remaining |= (rx[pos + hdr] & 0x7F) << shift;
+                    shift += 7;
+                    hdr++;
+                }
+                if (pos + hdr >= rx_len)
+                {
+                    break;
+                }
+                remaining |= (rx[pos + hdr] & 0x7F) << shift;
+                hdr++;
+                if (pos + hdr + remaining > rx_len)
+                {
+                    break;
+                }
+                _mqtt_on_packet(rx[pos], rx + pos + hdr, remaining);
+                pos += hdr + remaining;
+            }
+            memmove(rx, rx + pos, rx_len - pos);
+            rx_len -= pos;
+            if (sizeof(rx) == rx_len)
+            {
+                /* A packet larger than the receive buffer, the stream cannot be followed */
+                break;
+            }
+        }
+    }
+    b_running = false;
+    return NULL;
+}
+
+static void _mqtt_on_packet(uint8_t type, const uint8_t *p_data, int len)
+{
+    if ((MQTT_PKT_PUBACK == (type & 0xF0)) && (2 <= len))
+    {
+        if (NULL != tele_published_cbk)
+        {
+            tele_published_cbk((p_data[0] << 8) | p_data[1]);
+        }
+        return;
+    }
+    if (MQTT_PKT_PUBLISH != (type & 0xF0) || (2 > len))
+    {
+        return;
+    }
+    int topic_len = (p_data[0] << 8) | p_data[1];
+    int payload = 2 + topic_len + ((0 != (type & 0x06)) ? (2) : (0));
+    if (payload > len)
+    {
+        return;
+    }
+    const char *p_topic = (const char *)p_data + 2;
+
+    if (NULL != tele_data_cbk)
+    {
+        tele_data_cbk(p_topic, topic_len, p_data + payload, len - payload);
+    }
+}
+
+static unsigned long _mqtt_millis(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000UL + ts.tv_nsec / 1000000UL;
+}
+
+static bool _mqtt_store_path(uint8_t slot, char *p_path)
+{
+    const char *p_dir = getenv("MQTT_OUTBOX_DIR");
+    if (NULL == p_dir)
+    {
+        return false;
+    }
+    snprintf(p_path, MQTT_STORE_PATH_LEN, "%s/obx%u", p_dir, slot);
+    return true;
+}
+//---------------------------- INTERRUPT HANDLERS -----------------------------
@@ -0,0 +1,162 @@
+/**
+* @file telemetry_metrics.c
+
+* @brief Payload of the metrics topic.
+
+* @par A sample is a version byte, a flags byte, the sequence number of the
+*       sample and a mask of the metrics it carries as unsigned LEB128 varints,
+*       then one zigzag varint per metric in the mask. A keyframe carries every
+*       metric that is not 0, the samples in between carry the change of the
+*       metrics that changed since the sample before, so a device at rest sends
+*       a few bytes. A receiver that joins late or misses a sample waits for the
+*       next keyframe, one that sees the sequence go back takes it as a
+*       restart of the sender and waits for a keyframe as well.
+*
+* COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "telemetry_metrics.h"
+#include "telemetry_varint.h"
+#include <string.h>
+//---------------------------------- MACROS -----------------------------------
+#define METRICS_FLAG_KEYFRAME  (0x01u)
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+void telemetry_metrics_encoder_init(telemetry_metrics_encoder_t *p_enc, uint16_t keyframe_every)
+{
+    memset(p_enc, 0, sizeof(*p_enc));
+    p_enc->keyframe_every = ((0u == keyframe_every) ? (1u) : (keyframe_every));
+    p_enc->b_need_keyframe = true;
+}
+
+void telemetry_metrics_encoder_resync(telemetry_metrics_encoder_t *p_enc)
+{
+    p_enc->b_need_keyframe = true;
+}
+
+size_t telemetry_metrics_encode(telemetry_metrics_encoder_t *p_enc, const telemetry_metrics_t *p_sample,
+                                uint8_t *p_buf, size_t size)
+{
+    uint8_t tmp[TELEMETRY_METRICS_SIZE_MAX];
+    uint32_t values[TELEMETRY_METRIC_COUNT];
+    uint32_t mask = 0u;
+    bool b_keyframe = (p_enc->b_need_keyframe || (p_enc->since_keyframe >= p_enc->keyframe_every));
+
+    for (uint8_t i = 0u; i < TELEMETRY_METRIC_COUNT; i++)
+    {
+        /* Wraps like the decoder adds it back, any change of an int32_t fits */
+        int32_t delta = (int32_t)((uint32_t)p_sample->value[i] -
+                                  (b_keyframe ? (0u) : ((uint32_t)p_enc->last.value[i])));
+        values[i] = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+        mask |= ((0u != values[i]) ? (1u << i) : (0u));
+    }
+
+    uint8_t *p_pos = tmp;
+    *p_pos++ = TELEMETRY_METRICS_VERSION;
+    *p_pos++ = (b_keyframe ? (METRICS_FLAG_KEYFRAME) : (0u));
+    p_pos = telemetry_varint_put(p_pos, p_enc->seq);
+    p_pos = telemetry_varint_put(p_pos, mask);
+    for (uint8_t i = 0u; i < TELEMETRY_METRIC_COUNT; i++)
+    {
+        if (0u != (mask & (1u << i)))
+        {
+            p_pos = telemetry_varint_put(p_pos, values[i]);
+        }
+    }
+
+    size_t len = p_pos - tmp;
+    if (size < len)
+    {
+        return 0u;
+    }
+    memcpy(p_buf, tmp, len);
+    p_enc->last = *p_sample;
+    p_enc->seq++;
+    p_enc->since_keyframe = (b_keyframe ? (1u) : (p_enc->since_keyframe + 1u));
+    p_enc->b_need_keyframe = false;
+    return len;
+}
+
+void telemetry_metrics_decoder_init(telemetry_metrics_decoder_t *p_dec)
+{
+    memset(p_dec, 0, sizeof(*p_dec));
+}
+
+bool telemetry_metrics_decode(telemetry_metrics_decoder_t *p_dec, const uint8_t *p_data, int len,
+                              telemetry_metrics_t *p_sample)
+{
+    if ((NULL == p_data) || (2 > len) || (0u == p_data[0]))
+    {
+        return false;
+    }
+
+    telemetry_varint_reader_t reader = { .p_pos = p_data + 2, .p_end = p_data + len, .b_ok = true };
+    bool b_keyframe = (0u != (p_data[1] & METRICS_FLAG_KEYFRAME));
+    uint32_t seq = telemetry_varint_get(&reader, UINT32_MAX);
+    uint32_t mask = telemetry_varint_get(&reader, UINT32_MAX);
+    telemetry_metrics_t sample = { 0 };
+    if (!b_keyframe)
+    {
+        sample = p_dec->last;
+    }
+
+    for (uint8_t i = 0u; (i < 32u) && reader.b_ok; i++)
+    {
+        if (0u == (mask & (1u << i)))
+        {
+            continue;
+        }
+        uint32_t zigzag = telemetry_varint_get(&reader, UINT32_MAX);
+        if (TELEMETRY_METRIC_COUNT > i)
+        {
+            int32_t delta = (int32_t)((zigzag >> 1) ^ (0u - (zigzag & 1u)));
+            sample.value[i] = (int32_t)((uint32_t)sample.value[i] + (uint32_t)delta);
+        }
+    }
+    if (!reader.b_ok)
+    {
+        return false;
+    }
+
+    if (p_dec->b_started)
+    {
+        int32_t step = (int32_t)(seq - p_dec->seq);
+        if (0 == step)
+        {
+            /* A redelivery of the last sample */
+            return false;
+        }
+        if (1 < step)
+        {
+            p_dec->lost += (uint32_t)step - 1u;
+            p_dec->b_synced = false;
+        }
+        else if (0 > step)
+        {
+            /* The sender restarted, its deltas no longer apply to the last sample */
+            p_dec->b_synced = false;
+        }
+    }
+    p_dec->b_started = true;
+    p_dec->seq = seq;
+    if ((!b_keyframe) && (!p_dec->b_synced))
+    {
+        return false;
+    }
+    p_dec->b_synced = true;
+    p_dec->last = sample;
+    *p_sample = sample;
+    return true;
+}
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+
+//---------------------------- INTERRUPT HANDLERS -----------------------------
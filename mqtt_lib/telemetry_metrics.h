@@ -0,0 +1,128 @@
+/**
+* @file telemetry_metrics.h
+
+* @brief See the source file.
+
+* @par
+*
+* COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __TELEMETRY_METRICS_H__
+#define __TELEMETRY_METRICS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+//---------------------------------- MACROS -----------------------------------
+#define TELEMETRY_METRICS_VERSION  (1u)
+/* Version, flags, sequence, mask of the metrics sent and a varint of up to 5 bytes per metric */
+#define TELEMETRY_METRICS_SIZE_MAX (1u + 1u + 5u + 5u + (5u * TELEMETRY_METRIC_COUNT))
+//-------------------------------- DATA TYPES ---------------------------------
+/* Newer versions only append metrics up to 32, the order is the order on the wire */
+typedef enum
+{
+    TELEMETRY_METRIC_UPTIME_S = 0,
+    TELEMETRY_METRIC_HEAP_FREE,         /* bytes */
+    TELEMETRY_METRIC_HEAP_MIN_FREE,     /* bytes, since boot */
+    TELEMETRY_METRIC_LV_MEM_USED,       /* bytes */
+    TELEMETRY_METRIC_LV_MEM_FRAG_PCT,
+    TELEMETRY_METRIC_STACK_FREE_GUI,    /* bytes, high-water mark */
+    TELEMETRY_METRIC_STACK_FREE_GAME,
+    TELEMETRY_METRIC_STACK_FREE_MQTT,
+    TELEMETRY_METRIC_STACK_FREE_METRICS,
+    TELEMETRY_METRIC_GAME_TICKS,        /* of the current or last game */
+    TELEMETRY_METRIC_TICK_MEAN_US,
+    TELEMETRY_METRIC_TICK_P99_US,
+    TELEMETRY_METRIC_TICK_MAX_US,
+    TELEMETRY_METRIC_TICK_LAG_P99_US,
+    TELEMETRY_METRIC_RSSI_DBM,          /* 0 if not connected */
+
+    TELEMETRY_METRIC_COUNT
+} telemetry_metric_t;
+
+typedef struct
+{
+    int32_t value[TELEMETRY_METRIC_COUNT];
+} telemetry_metrics_t;
+
+/* A sample is sent in full every keyframe_every samples and as changes in between */
+typedef struct
+{
+    telemetry_metrics_t last;
+    uint32_t            seq;
+    uint16_t            keyframe_every;
+    uint16_t            since_keyframe;
+    bool                b_need_keyframe;
+} telemetry_metrics_encoder_t;
+
+typedef struct
+{
+    telemetry_metrics_t last;
+    uint32_t            seq;
+    bool                b_started;
+    bool                b_synced;
+    uint32_t            lost;   /* samples skipped by the sequence, not counting restarts */
+} telemetry_metrics_decoder_t;
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * It initializes an encoder, its first sample is a keyframe.
+ *
+ * @param p_enc The encoder.
+ * @param keyframe_every Samples between two keyframes, 1 sends every sample in full.
+ */
+void telemetry_metrics_encoder_init(telemetry_metrics_encoder_t *p_enc, uint16_t keyframe_every);
+
+/**
+ * It makes the next sample a keyframe, used when a sample could not be sent.
+ *
+ * @param p_enc The encoder.
+ */
+void telemetry_metrics_encoder_resync(telemetry_metrics_encoder_t *p_enc);
+
+/**
+ * It encodes a sample against the last one it encoded.
+ *
+ * @param p_enc The encoder.
+ * @param p_sample The sample.
+ * @param p_buf The buffer for the payload.
+ * @param size The size of the buffer, TELEMETRY_METRICS_SIZE_MAX always fits.
+ *
+ * @return The length of the payload, 0 if it does not fit.
+ */
+size_t telemetry_metrics_encode(telemetry_metrics_encoder_t *p_enc, const telemetry_metrics_t *p_sample,
+                                uint8_t *p_buf, size_t size);
+
+/**
+ * It initializes a decoder, it waits for a keyframe.
+ *
+ * @param p_dec The decoder.
+ */
+void telemetry_metrics_decoder_init(telemetry_metrics_decoder_t *p_dec);
+
+/**
+ * It decodes a payload of the metrics topic. Metrics this version does not
+ *       know are skipped, the ones an older sender does not have stay 0.
+ *
+ * @param p_dec The decoder.
+ * @param p_data The payload.
+ * @param len The length of the payload.
+ * @param p_sample The decoded sample.
+ *
+ * @return true if the payload is valid and the decoder is in sync, false for
+ *         a repeat of the last sample too.
+ */
+bool telemetry_metrics_decode(telemetry_metrics_decoder_t *p_dec, const uint8_t *p_data, int len,
+                              telemetry_metrics_t *p_sample);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __TELEMETRY_METRICS_H__
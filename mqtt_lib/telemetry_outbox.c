@@ -0,0 +1,455 @@
+/**
+* @file telemetry_outbox.c
+
+* @brief Outbox of game reports published on the score topic.
+
+* @par Results that cannot be published are kept in a RAM ring. A full ring is
+*       spilled as one segment to the persistent store of the driver, which keeps
+*       TELEMETRY_OUTBOX_SEGMENTS of them and overwrites the oldest when full.
+*       Retained results are new high scores, only the latest one matters to the
+*       broker, so it is kept in a slot of its own and written through to the store.
+*
+*       On every (re)connect the outbox is published oldest first, the segments,
+*       then the ring and the retained result last. The messages are enqueued into
+*       the outbox of the client with QoS 1, which sends them in one burst. A
+*       segment and the retained result stay in the store until the broker
+*       acknowledged every message of them, what was not acknowledged by the next
+*       connect is published again, so a result may arrive twice but is not lost.
+*
+*       Binary reports go to MQTT_SCORE_TOPIC. Firmware that predates them only
+*       parses "score,owner" strings, so a won game is also published as one on
+*       MQTT_HOMEWORK_TOPIC. Strings queued as they are only go to the latter.
+*
+* COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "telemetry_outbox.h"
+#include "mqtt_client_esp.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+//---------------------------------- MACROS -----------------------------------
+#define OUTBOX_RETAINED_SLOT (TELEMETRY_OUTBOX_SEGMENTS)
+#define OUTBOX_NO_SEGMENT    (0xFFu)
+#define OUTBOX_NO_MSG_ID     (-1)
+#define OUTBOX_INFLIGHT_MAX  (TELEMETRY_OUTBOX_SEGMENTS * TELEMETRY_OUTBOX_RAM_LEN)
+/* Score, comma and owner */
+#define OUTBOX_LEGACY_SIZE   (10u + 1u + TELEMETRY_REPORT_OWNER_MAX + 1u)
+//-------------------------------- DATA TYPES ---------------------------------
+typedef struct
+{
+    uint8_t len;    /* 0 if empty */
+    uint8_t msg[TELEMETRY_OUTBOX_MSG_MAX];
+} outbox_record_t;
+
+typedef struct
+{
+    uint32_t seq;   /* order the segments were spilled in */
+    uint8_t count;
+    outbox_record_t records[TELEMETRY_OUTBOX_RAM_LEN];
+} outbox_segment_t;
+
+typedef struct
+{
+    int msg_id;
+    uint8_t slot;   /* OUTBOX_NO_SEGMENT if unused */
+} outbox_inflight_t;
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+/**
+ * It reads the state of the store the first time the outbox is used, the store
+ *       may not be ready before.
+ */
+static void _outbox_load(void);
+
+/**
+ * It queues a result, spilling the ring to the store if it is full.
+ *
+ * @param p_data The result.
+ * @param len The length of the result.
+ * @param retain true if the result is a retained one.
+ */
+static void _outbox_push(const void *p_data, uint8_t len, bool retain);
+
+/**
+ * It writes the ring as a new segment to the store and empties it.
+ *
+ * @return true if the ring was written.
+ */
+static bool _outbox_spill(void);
+
+/**
+ * It returns the segment spilled first.
+ *
+ * @param b_unsent_only true to skip the segments waiting for acknowledgements.
+ *
+ * @return The slot of the segment, OUTBOX_NO_SEGMENT if there is none.
+ */
+static uint8_t _outbox_oldest(bool b_unsent_only);
+
+/**
+ * It forgets the messages of a segment waiting for acknowledgements, the
+ *       segment is published again by the next flush.
+ *
+ * @param slot The slot of the segment.
+ */
+static void _outbox_forget(uint8_t slot);
+
+/**
+ * It returns how many results are queued and not yet handed to the client,
+ *       the lock is held.
+ *
+ * @return The number of results.
+ */
+static int _outbox_pending(void);
+
+/**
+ * It enqueues results into the outbox of the client.
+ *
+ * @param p_records The results.
+ * @param count The number of results.
+ * @param retain true if the results are retained ones.
+ * @param slot The segment waiting for their acknowledgements, OUTBOX_NO_SEGMENT
+ *             if nothing waits.
+ *
+ * @return The number of results enqueued, the rest failed.
+ */
+static uint8_t _outbox_publish(const outbox_record_t *p_records, uint8_t count, bool retain, uint8_t slot);
+
+/**
+ * It publishes one result with QoS 1 on the topic for its format, a won game
+ *       also as a legacy string.
+ *
+ * @param p_data The result.
+ * @param len The length of the result.
+ * @param retain true if the result is a retained one.
+ *
+ * @return The id of the message on its own topic, negative if it could not be
+ *         queued. The legacy copy is best effort.
+ */
+static int _outbox_publish_one(const uint8_t *p_data, uint8_t len, bool retain);
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+static outbox_record_t ring[TELEMETRY_OUTBOX_RAM_LEN];
+static uint8_t ring_head;
+static uint8_t ring_count;
+static outbox_record_t retained;
+static uint32_t seg_seq[TELEMETRY_OUTBOX_SEGMENTS];
+static uint8_t seg_count[TELEMETRY_OUTBOX_SEGMENTS];
+static uint8_t seg_unacked[TELEMETRY_OUTBOX_SEGMENTS];
+static bool seg_b_sent[TELEMETRY_OUTBOX_SEGMENTS];  /* all its messages are in the client */
+static outbox_inflight_t inflight[OUTBOX_INFLIGHT_MAX];
+static int retained_msg_id = OUTBOX_NO_MSG_ID;
+static uint32_t next_seq;
+static uint32_t dropped;
+static bool b_loaded;
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+telemetry_err_t telemetry_outbox_send(const void *p_data, size_t len, bool retain)
+{
+    if ((0u == len) || (TELEMETRY_OUTBOX_MSG_MAX < len))
+    {
+        return TELEMETRY_SEND_FAILED;
+    }
+
+    driver_telemetry_lock();
+    _outbox_load();
+    bool b_direct = (0 == _outbox_pending());
+    driver_telemetry_unlock();
+
+    /* Older results go first, a result only skips the outbox if it is empty */
+    if (b_direct && (0 <= _outbox_publish_one(p_data, (uint8_t)len, retain)))
+    {
+        return TELEMETRY_OK;
+    }
+    driver_telemetry_lock();
+    _outbox_push(p_data, (uint8_t)len, retain);
+    driver_telemetry_unlock();
+    return TELEMETRY_OK;
+}
+
+void telemetry_outbox_flush(void)
+{
+    static outbox_segment_t batch;
+
+    /* The lock is held across the burst, publishing only copies into the client outbox */
+    driver_telemetry_lock();
+    _outbox_load();
+    for (uint8_t slot = 0u; slot < TELEMETRY_OUTBOX_SEGMENTS; slot++)
+    {
+        _outbox_forget(slot);
+    }
+    if ((OUTBOX_NO_MSG_ID != retained_msg_id) && (0u == retained.len) &&
+        (sizeof(retained) == driver_telemetry_store_read(OUTBOX_RETAINED_SLOT, &retained, sizeof(retained))))
+    {
+        /* Not acknowledged before the connection dropped */
+        retained_msg_id = OUTBOX_NO_MSG_ID;
+    }
+    for (uint8_t slot = _outbox_oldest(true); OUTBOX_NO_SEGMENT != slot; slot = _outbox_oldest(true))
+    {
+        size_t len = driver_telemetry_store_read(slot, &batch, sizeof(batch));
+        if ((offsetof(outbox_segment_t, records) > len) || (TELEMETRY_OUTBOX_RAM_LEN < batch.count))
+        {
+            /* Unreadable, nothing more can be done with it */
+            dropped += seg_count[slot];
+            driver_telemetry_store_erase(slot);
+            seg_count[slot] = 0u;
+            continue;
+        }
+        if (batch.count != _outbox_publish(batch.records, batch.count, false, slot))
+        {
+            /* Kept whole, the next flush publishes it again */
+            _outbox_forget(slot);
+            driver_telemetry_unlock();
+            return;
+        }
+        seg_b_sent[slot] = true;
+    }
+
+    while (0u != ring_count)
+    {
+        uint8_t run = (((ring_head + ring_count) > TELEMETRY_OUTBOX_RAM_LEN)
+                       ? (TELEMETRY_OUTBOX_RAM_LEN - ring_head) : (ring_count));
+        uint8_t sent = _outbox_publish(&ring[ring_head], run, false, OUTBOX_NO_SEGMENT);
+        ring_head = (ring_head + sent) % TELEMETRY_OUTBOX_RAM_LEN;
+        ring_count -= sent;
+        if (sent != run)
+        {
+            driver_telemetry_unlock();
+            return;
+        }
+    }
+    ring_head = 0u;
+
+    if (0u != retained.len)
+    {
+        int msg_id = _outbox_publish_one(retained.msg, retained.len, true);
+        if (0 <= msg_id)
+        {
+            /* Stays in the store until it is acknowledged */
+            retained.len = 0u;
+            retained_msg_id = msg_id;
+        }
+    }
+    driver_telemetry_unlock();
+}
+
+void telemetry_outbox_on_published(int msg_id)
+{
+    driver_telemetry_lock();
+    if (msg_id == retained_msg_id)
+    {
+        retained_msg_id = OUTBOX_NO_MSG_ID;
+        /* Unless a newer one replaced it in the store meanwhile */
+        if (0u == retained.len)
+        {
+            driver_telemetry_store_erase(OUTBOX_RETAINED_SLOT);
+        }
+    }
+    for (uint8_t i = 0u; i < OUTBOX_INFLIGHT_MAX; i++)
+    {
+        uint8_t slot = inflight[i].slot;
+        if ((OUTBOX_NO_SEGMENT == slot) || (msg_id != inflight[i].msg_id))
+        {
+            continue;
+        }
+        inflight[i].slot = OUTBOX_NO_SEGMENT;
+        seg_unacked[slot]--;
+        if (seg_b_sent[slot] && (0u == seg_unacked[slot]))
+        {
+            driver_telemetry_store_erase(slot);
+            seg_count[slot] = 0u;
+            seg_b_sent[slot] = false;
+        }
+        break;
+    }
+    driver_telemetry_unlock();
+}
+
+int telemetry_outbox_pending(void)
+{
+    driver_telemetry_lock();
+    _outbox_load();
+    int pending = _outbox_pending();
+    driver_telemetry_unlock();
+    return pending;
+}
+
+uint32_t telemetry_outbox_dropped(void)
+{
+    driver_telemetry_lock();
+    uint32_t ret = dropped;
+    driver_telemetry_unlock();
+    return ret;
+}
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static void _outbox_load(void)
+{
+    static outbox_segment_t segment;
+
+    if (b_loaded)
+    {
+        return;
+    }
+    b_loaded = true;
+    for (uint8_t i = 0u; i < OUTBOX_INFLIGHT_MAX; i++)
+    {
+        inflight[i].slot = OUTBOX_NO_SEGMENT;
+    }
+    for (uint8_t slot = 0u; slot < TELEMETRY_OUTBOX_SEGMENTS; slot++)
+    {
+        size_t len = driver_telemetry_store_read(slot, &segment, sizeof(segment));
+        if ((offsetof(outbox_segment_t, records) <= len) && (TELEMETRY_OUTBOX_RAM_LEN >= segment.count) &&
+            (len >= (offsetof(outbox_segment_t, records) + (segment.count * sizeof(outbox_record_t)))))
+        {
+            seg_seq[slot] = segment.seq;
+            seg_count[slot] = segment.count;
+            next_seq = ((segment.seq >= next_seq) ? (segment.seq + 1u) : (next_seq));
+        }
+    }
+    if ((sizeof(retained) != driver_telemetry_store_read(OUTBOX_RETAINED_SLOT, &retained, sizeof(retained))) ||
+        (TELEMETRY_OUTBOX_MSG_MAX < retained.len))
+    {
+        retained.len = 0u;
+    }
+}
+
+static void _outbox_push(const void *p_data, uint8_t len, bool retain)
+{
+    outbox_record_t *p_record = &retained;
+
+    if (!retain)
+    {
+        if ((TELEMETRY_OUTBOX_RAM_LEN == ring_count) && (!_outbox_spill()))
+        {
+            /* No store, the oldest result makes room */
+            ring_head = (ring_head + 1u) % TELEMETRY_OUTBOX_RAM_LEN;
+            ring_count--;
+            dropped++;
+        }
+        p_record = &ring[(ring_head + ring_count) % TELEMETRY_OUTBOX_RAM_LEN];
+        ring_count++;
+    }
+    p_record->len = len;
+    memcpy(p_record->msg, p_data, len);
+
+    if (retain)
+    {
+        /* A newer high score supersedes the queued one */
+        (void)driver_telemetry_store_write(OUTBOX_RETAINED_SLOT, &retained, sizeof(retained));
+    }
+}
+
+static bool _outbox_spill(void)
+{
+    static outbox_segment_t segment;
+    uint8_t slot = OUTBOX_NO_SEGMENT;
+
+    for (uint8_t i = 0u; (i < TELEMETRY_OUTBOX_SEGMENTS) && (OUTBOX_NO_SEGMENT == slot); i++)
+    {
+        slot = ((0u == seg_count[i]) ? (i) : (slot));
+    }
+    slot = ((OUTBOX_NO_SEGMENT == slot) ? (_outbox_oldest(false)) : (slot));
+
+    segment.seq = next_seq;
+    segment.count = ring_count;
+    for (uint8_t i = 0u; i < ring_count; i++)
+    {
+        segment.records[i] = ring[(ring_head + i) % TELEMETRY_OUTBOX_RAM_LEN];
+    }
+    if (!driver_telemetry_store_write(slot, &segment, sizeof(segment)))
+    {
+        return false;
+    }
+    /* An overwritten segment may still wait for acknowledgements */
+    _outbox_forget(slot);
+    dropped += seg_count[slot];
+    seg_seq[slot] = next_seq++;
+    seg_count[slot] = ring_count;
+    ring_head = 0u;
+    ring_count = 0u;
+    return true;
+}
+
+static uint8_t _outbox_oldest(bool b_unsent_only)
+{
+    uint8_t oldest = OUTBOX_NO_SEGMENT;
+    for (uint8_t i = 0u; i < TELEMETRY_OUTBOX_SEGMENTS; i++)
+    {
+        if ((0u != seg_count[i]) && (!(b_unsent_only && seg_b_sent[i])) &&
+            ((OUTBOX_NO_SEGMENT == oldest) || (seg_seq[i] < seg_seq[oldest])))
+        {
+            oldest = i;
+        }
+    }
+    return oldest;
+}
+
+static void _outbox_forget(uint8_t slot)
+{
+    for (uint8_t i = 0u; i < OUTBOX_INFLIGHT_MAX; i++)
+    {
+        inflight[i].slot = ((slot == inflight[i].slot) ? (OUTBOX_NO_SEGMENT) : (inflight[i].slot));
+    }
+    seg_unacked[slot] = 0u;
+    seg_b_sent[slot] = false;
+}
+
+static int _outbox_pending(void)
+{
+    /* Segments in the client are sent before anything published after them */
+    int pending = ring_count + ((0u != retained.len) ? (1) : (0));
+    for (uint8_t i = 0u; i < TELEMETRY_OUTBOX_SEGMENTS; i++)
+    {
+        pending += (seg_b_sent[i] ? (0) : (seg_count[i]));
+    }
+    return pending;
+}
+
+static uint8_t _outbox_publish(const outbox_record_t *p_records, uint8_t count, bool retain, uint8_t slot)
+{
+    uint8_t sent = 0u;
+    uint8_t free = 0u;
+    for (; sent < count; sent++)
+    {
+        int msg_id = _outbox_publish_one(p_records[sent].msg, p_records[sent].len, retain);
+        if (0 > msg_id)
+        {
+            break;
+        }
+        if (OUTBOX_NO_SEGMENT == slot)
+        {
+            continue;
+        }
+        /* A segment only waits for its own messages, there is an entry for each */
+        while (OUTBOX_NO_SEGMENT != inflight[free].slot)
+        {
+            free++;
+        }
+        inflight[free].msg_id = msg_id;
+        inflight[free].slot = slot;
+        seg_unacked[slot]++;
+    }
+    return sent;
+}
+
+static int _outbox_publish_one(const uint8_t *p_data, uint8_t len, bool retain)
+{
+    telemetry_report_t report;
+
+    if ((0u == len) || (('0' <= p_data[0]) && ('9' >= p_data[0])))
+    {
+        return driver_telemetry_publish_acked(MQTT_HOMEWORK_TOPIC, p_data, len, retain);
+    }
+    int msg_id = driver_telemetry_publish_acked(MQTT_SCORE_TOPIC, p_data, len, retain);
+    if ((0 <= msg_id) && telemetry_report_decode(p_data, len, &report) && (0u != report.score))
+    {
+        char legacy[OUTBOX_LEGACY_SIZE];
+        int legacy_len = snprintf(legacy, sizeof(legacy), "%lu,%.*s", (unsigned long)report.score,
+                                  (int)report.owner_len, report.p_owner);
+        (void)driver_telemetry_publish(MQTT_HOMEWORK_TOPIC, legacy, legacy_len, 0, retain);
+    }
+    return msg_id;
+}
+//---------------------------- INTERRUPT HANDLERS -----------------------------
@@ -0,0 +1,79 @@
+/**
+* @file telemetry_outbox.h
+
+* @brief See the source file.
+
+* @par
+*
+* COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __TELEMETRY_OUTBOX_H__
+#define __TELEMETRY_OUTBOX_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "app_mqtt_defines.h"
+#include "telemetry_report.h"
+#include <stdbool.h>
+#include <stddef.h>
+//---------------------------------- MACROS -----------------------------------
+#define TELEMETRY_OUTBOX_RAM_LEN  (8u)  /* results kept in RAM before a spill */
+#define TELEMETRY_OUTBOX_SEGMENTS (4u)  /* spilled rings kept in the store */
+#define TELEMETRY_OUTBOX_MSG_MAX  (TELEMETRY_REPORT_SIZE_MAX)
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * It publishes a result on the score topic, or queues it if the client is
+ *       offline or older results are still queued. A retained result
+ *       supersedes the retained results queued before it. Binary reports go
+ *       to MQTT_SCORE_TOPIC, won games also as "score,owner" to
+ *       MQTT_HOMEWORK_TOPIC, strings only to the latter.
+ *
+ * @param p_data The result.
+ * @param len The length of the result, up to TELEMETRY_OUTBOX_MSG_MAX.
+ * @param retain true if the broker should keep the result for new subscribers.
+ *
+ * @return TELEMETRY_OK if the result was published or queued.
+ */
+telemetry_err_t telemetry_outbox_send(const void *p_data, size_t len, bool retain);
+
+/**
+ * It publishes every queued result, oldest first, in one pass over the
+ *       outbox. Called on every (re)connect.
+ */
+void telemetry_outbox_flush(void);
+
+/**
+ * It releases what the store kept for a message once the broker acknowledged
+ *       it. Called from the on published callback of the driver.
+ *
+ * @param msg_id The id of the message.
+ */
+void telemetry_outbox_on_published(int msg_id);
+
+/**
+ * It returns how many results are queued, in RAM and in the store, and not
+ *       yet handed to the client.
+ *
+ * @return The number of results.
+ */
+int telemetry_outbox_pending(void);
+
+/**
+ * It returns how many results were lost because the outbox was full.
+ *
+ * @return The number of results.
+ */
+uint32_t telemetry_outbox_dropped(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __TELEMETRY_OUTBOX_H__
@@ -0,0 +1,123 @@
+/**
+* @file telemetry_report.c
+
+* @brief Payload of the score topic.
+
+* @par A report is a version byte followed by the fields as unsigned LEB128
+*       varints: score, duration_ms, aliens, blocks, winner and the owner length,
+*       then the owner. Newer versions only append fields, so a decoder reads
+*       the fields it knows and skips the rest. Versions stay below '0', the
+*       first byte tells a report from a legacy "score,owner" string.
+*
+* COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "telemetry_report.h"
+#include "telemetry_varint.h"
+#include <string.h>
+//---------------------------------- MACROS -----------------------------------
+
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+/**
+ * It decodes a legacy "score,owner" string, the owner ends at a space.
+ *
+ * @param p_data The payload.
+ * @param len The length of the payload.
+ * @param p_report The decoded report.
+ *
+ * @return true if the payload is a valid string.
+ */
+static bool _report_decode_ascii(const uint8_t *p_data, int len, telemetry_report_t *p_report);
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+size_t telemetry_report_encode(const telemetry_report_t *p_report, uint8_t *p_buf, size_t size)
+{
+    uint8_t tmp[TELEMETRY_REPORT_SIZE_MAX];
+    uint8_t owner_len = ((TELEMETRY_REPORT_OWNER_MAX < p_report->owner_len)
+                         ? (TELEMETRY_REPORT_OWNER_MAX) : (p_report->owner_len));
+    uint8_t *p_pos = tmp;
+
+    *p_pos++ = TELEMETRY_REPORT_VERSION;
+    p_pos = telemetry_varint_put(p_pos, p_report->score);
+    p_pos = telemetry_varint_put(p_pos, p_report->duration_ms);
+    p_pos = telemetry_varint_put(p_pos, p_report->aliens);
+    p_pos = telemetry_varint_put(p_pos, p_report->blocks);
+    p_pos = telemetry_varint_put(p_pos, p_report->winner);
+    *p_pos++ = owner_len;
+    memcpy(p_pos, p_report->p_owner, owner_len);
+    p_pos += owner_len;
+
+    size_t len = p_pos - tmp;
+    if (size < len)
+    {
+        return 0u;
+    }
+    memcpy(p_buf, tmp, len);
+    return len;
+}
+
+bool telemetry_report_decode(const uint8_t *p_data, int len, telemetry_report_t *p_report)
+{
+    if ((NULL == p_data) || (0 >= len))
+    {
+        return false;
+    }
+    if ('0' <= p_data[0])
+    {
+        return _report_decode_ascii(p_data, len, p_report);
+    }
+    if (0u == p_data[0])
+    {
+        return false;
+    }
+
+    telemetry_varint_reader_t reader = { .p_pos = p_data + 1, .p_end = p_data + len, .b_ok = true };
+    p_report->score = telemetry_varint_get(&reader, UINT32_MAX);
+    p_report->duration_ms = telemetry_varint_get(&reader, UINT32_MAX);
+    p_report->aliens = telemetry_varint_get(&reader, UINT16_MAX);
+    p_report->blocks = telemetry_varint_get(&reader, UINT16_MAX);
+    p_report->winner = telemetry_varint_get(&reader, UINT8_MAX);
+    p_report->owner_len = telemetry_varint_get(&reader, TELEMETRY_REPORT_OWNER_MAX);
+    p_report->p_owner = (const char *)reader.p_pos;
+    return (reader.b_ok && ((reader.p_end - reader.p_pos) >= p_report->owner_len));
+}
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static bool _report_decode_ascii(const uint8_t *p_data, int len, telemetry_report_t *p_report)
+{
+    const uint8_t *p_end = p_data + len;
+    uint32_t score = 0u;
+    const uint8_t *p_pos = p_data;
+
+    for (; (p_pos != p_end) && ('0' <= *p_pos) && ('9' >= *p_pos); p_pos++)
+    {
+        if (((UINT32_MAX - (*p_pos - '0')) / 10u) < score)
+        {
+            return false;
+        }
+        score = (score * 10u) + (*p_pos - '0');
+    }
+    if ((p_pos == p_end) || (',' != *p_pos))
+    {
+        return false;
+    }
+    const uint8_t *p_owner = ++p_pos;
+    while ((p_pos != p_end) && (' ' != *p_pos) && ('\0' != *p_pos))
+    {
+        p_pos++;
+    }
+
+    memset(p_report, 0, sizeof(*p_report));
+    p_report->score = score;
+    p_report->p_owner = (const char *)p_owner;
+    p_report->owner_len = (((p_pos - p_owner) > TELEMETRY_REPORT_OWNER_MAX)
+                           ? (TELEMETRY_REPORT_OWNER_MAX) : (p_pos - p_owner));
+    return true;
+}
+//---------------------------- INTERRUPT HANDLERS -----------------------------
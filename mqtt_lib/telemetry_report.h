@@ -0,0 +1,69 @@
+/**
+* @file telemetry_report.h
+
+* @brief See the source file.
+
+* @par
+*
+* COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __TELEMETRY_REPORT_H__
+#define __TELEMETRY_REPORT_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+//---------------------------------- MACROS -----------------------------------
+#define TELEMETRY_REPORT_VERSION   (1u)
+#define TELEMETRY_REPORT_OWNER_MAX (12u)
+/* Version, varints of up to 5, 5, 3, 3 and 2 bytes, owner length and owner */
+#define TELEMETRY_REPORT_SIZE_MAX  (1u + 5u + 5u + 3u + 3u + 2u + 1u + TELEMETRY_REPORT_OWNER_MAX)
+//-------------------------------- DATA TYPES ---------------------------------
+typedef struct
+{
+    uint32_t    score;       /* 0 unless the game was won */
+    uint32_t    duration_ms; /* wall time of the game */
+    uint16_t    aliens;      /* left at the end of the game */
+    uint16_t    blocks;      /* left at the end of the game */
+    uint8_t     winner;      /* aasi_game_winner_t, 0 if unknown */
+    const char *p_owner;     /* not terminated, decoded it points into the payload */
+    uint8_t     owner_len;
+} telemetry_report_t;
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * It encodes a game report, an owner longer than TELEMETRY_REPORT_OWNER_MAX
+ *       is cut.
+ *
+ * @param p_report The report.
+ * @param p_buf The buffer for the payload.
+ * @param size The size of the buffer, TELEMETRY_REPORT_SIZE_MAX always fits.
+ *
+ * @return The length of the payload, 0 if it does not fit.
+ */
+size_t telemetry_report_encode(const telemetry_report_t *p_report, uint8_t *p_buf, size_t size);
+
+/**
+ * It decodes a payload of the score topic without copying it. Binary reports
+ *       of any version are read up to the fields this version knows, legacy 
+ *       "score,owner" strings only carry the score and the owner.
+ *
+ * @param p_data The payload, it must outlive the report.
+ * @param len The length of the payload.
+ * @param p_report The decoded report.
+ *
+ * @return true if the payload is a valid report.
+ */
+bool telemetry_report_decode(const uint8_t *p_data, int len, telemetry_report_t *p_report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __TELEMETRY_REPORT_H__
@@ -0,0 +1,94 @@
+/**
+* @file telemetry_varint.h
+
+* @brief Unsigned LEB128 varints of up to 32 bits, shared by the telemetry
+*        payloads.
+
+* @par A value is written 7 bits per byte starting with the lowest, every byte
+*      but the last has the top bit set. A reader fails on a truncated varint
+*      and on one with bits above bit 31, and keeps failing afterwards, so a
+*      decoder checks it once after reading all of its fields.
+*
+* COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __TELEMETRY_VARINT_H__
+#define __TELEMETRY_VARINT_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include <stdbool.h>
+#include <stdint.h>
+//---------------------------------- MACROS -----------------------------------
+#define TELEMETRY_VARINT_MAX (5u)
+//-------------------------------- DATA TYPES ---------------------------------
+typedef struct
+{
+    const uint8_t *p_pos;
+    const uint8_t *p_end;
+    bool b_ok;
+} telemetry_varint_reader_t;
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * It appends a varint.
+ *
+ * @param p_pos Where to write it, at least TELEMETRY_VARINT_MAX bytes.
+ * @param value The value.
+ *
+ * @return The position after the varint.
+ */
+static inline uint8_t *telemetry_varint_put(uint8_t *p_pos, uint32_t value)
+{
+    while (0x7Fu < value)
+    {
+        *p_pos++ = (value & 0x7Fu) | 0x80u;
+        value >>= 7;
+    }
+    *p_pos++ = value;
+    return p_pos;
+}
+
+/**
+ * It reads a varint, a truncated, too long or too large one fails the reader.
+ *
+ * @param p_reader The reader.
+ * @param max The largest valid value.
+ *
+ * @return The value, 0 once the reader failed.
+ */
+static inline uint32_t telemetry_varint_get(telemetry_varint_reader_t *p_reader, uint32_t max)
+{
+    uint32_t value = 0u;
+    for (uint8_t shift = 0u; p_reader->b_ok; shift += 7u)
+    {
+        if ((p_reader->p_pos == p_reader->p_end) || ((7u * TELEMETRY_VARINT_MAX) <= shift))
+        {
+            p_reader->b_ok = false;
+            break;
+        }
+        uint8_t byte = *p_reader->p_pos++;
+        /* The 5th byte holds bits 28 to 31, anything above them does not fit */
+        if (((7u * (TELEMETRY_VARINT_MAX - 1u)) == shift) && (0x0Fu < byte))
+        {
+            p_reader->b_ok = false;
+            break;
+        }
+        value |= (uint32_t)(byte & 0x7Fu) << shift;
+        if (0u == (byte & 0x80u))
+        {
+            p_reader->b_ok = (value <= max);
+            return (p_reader->b_ok ? (value) : (0u));
+        }
+    }
+    return 0u;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __TELEMETRY_VARINT_H__
@@ -0,0 +1,213 @@
+/**
+* @file topic_router.c
+
+* @brief Routes received messages to the callbacks subscribed to their topic.
+
+* @par Exact filters sit in a hash table chained through the routes, so finding
+*       them costs one hash of the topic whatever the number of routes. Filters
+*       with wildcards are kept in a list and matched level by level.
+*
+* COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "topic_router.h"
+#include <string.h>
+//---------------------------------- MACROS -----------------------------------
+#define ROUTER_FNV_OFFSET (2166136261u)
+#define ROUTER_FNV_PRIME  (16777619u)
+//-------------------------------- DATA TYPES ---------------------------------
+
+//---------------------- PRIVATE FUNCTION PROTOTYPES --------------------------
+/**
+ * It hashes a topic with 32 bit FNV-1a.
+ *
+ * @param p_topic The topic.
+ * @param len The length of the topic.
+ *
+ * @return The hash.
+ */
+static uint32_t _router_hash(const char *p_topic, int len);
+
+/**
+ * It checks that wildcards fill whole levels and # is the last level.
+ *
+ * @param p_filter The filter.
+ * @param len The length of the filter.
+ * @param p_b_wildcard Set to true if the filter has wildcards.
+ *
+ * @return true if the filter is valid.
+ */
+static bool _router_filter_valid(const char *p_filter, int len, bool *p_b_wildcard);
+//------------------------- STATIC DATA & CONSTANTS ---------------------------
+
+//------------------------------- GLOBAL DATA ---------------------------------
+
+//------------------------------ PUBLIC FUNCTIONS -----------------------------
+void topic_router_init(topic_router_t *p_router)
+{
+    memset(p_router, 0, sizeof(*p_router));
+}
+
+bool topic_router_add(topic_router_t *p_router, const char *p_filter, telemetry_on_data_cb_t cbk)
+{
+    size_t len = strlen(p_filter);
+    bool b_wildcard = false;
+
+    if ((NULL == cbk) || (UINT16_MAX < len) || (!_router_filter_valid(p_filter, len, &b_wildcard)))
+    {
+        return false;
+    }
+    uint8_t index = atomic_load_explicit(&p_router->route_num, memory_order_relaxed);
+    for (uint8_t i = 0u; i < index; i++)
+    {
+        if ((cbk == p_router->routes[i].cbk) && (len == p_router->routes[i].filter_len) &&
+            (0 == memcmp(p_filter, p_router->routes[i].p_filter, len)))
+        {
+            return true;
+        }
+    }
+    if (MQTT_SUBSCRIPTIONS_MAX <= index)
+    {
+        return false;
+    }
+
+    topic_route_t *p_route = &p_router->routes[index];
+    p_route->p_filter = p_filter;
+    p_route->filter_len = len;
+    p_route->hash = _router_hash(p_filter, len);
+    p_route->cbk = cbk;
+    atomic_store_explicit(&p_route->next, TOPIC_ROUTER_NO_ROUTE, memory_order_relaxed);
+    atomic_store_explicit(&p_router->route_num, index + 1u, memory_order_release);
+
+    /* Linked last, a dispatch running meanwhile sees the route whole or not at all */
+    if (b_wildcard)
+    {
+        uint8_t wildcard_num = atomic_load_explicit(&p_router->wildcard_num, memory_order_relaxed);
+        p_router->wildcards[wildcard_num] = index;
+        atomic_store_explicit(&p_router->wildcard_num, wildcard_num + 1u, memory_order_release);
+    }
+    else
+    {
+        atomic_uint_least8_t *p_link = &p_router->buckets[p_route->hash & (TOPIC_ROUTER_BUCKETS - 1u)];
+        uint8_t link;
+        while (TOPIC_ROUTER_NO_ROUTE != (link = atomic_load_explicit(p_link, memory_order_relaxed)))
+        {
+            p_link = &p_router->routes[link - 1u].next;
+        }
+        atomic_store_explicit(p_link, index + 1u, memory_order_release);
+    }
+    return true;
+}
+
+uint8_t topic_router_count(const topic_router_t *p_router)
+{
+    return atomic_load_explicit(&p_router->route_num, memory_order_acquire);
+}
+
+int topic_router_dispatch(const topic_router_t *p_router, const char *p_topic, int topic_len,
+                          const uint8_t *p_data, int len)
+{
+    int called = 0;
+    uint32_t hash = _router_hash(p_topic, topic_len);
+
+    for (uint8_t link = atomic_load_explicit(&p_router->buckets[hash & (TOPIC_ROUTER_BUCKETS - 1u)],
+                                             memory_order_acquire);
+         TOPIC_ROUTER_NO_ROUTE != link;
+         link = atomic_load_explicit(&p_router->routes[link - 1u].next, memory_order_acquire))
+    {
+        const topic_route_t *p_route = &p_router->routes[link - 1u];
+        if ((hash == p_route->hash) && (topic_len == p_route->filter_len) &&
+            (0 == memcmp(p_topic, p_route->p_filter, topic_len)))
+        {
+            p_route->cbk(p_data, len);
+            called++;
+        }
+    }
+    uint8_t wildcard_num = atomic_load_explicit(&p_router->wildcard_num, memory_order_acquire);
+    for (uint8_t i = 0u; i < wildcard_num; i++)
+    {
+        const topic_route_t *p_route = &p_router->routes[p_router->wildcards[i]];
+        if (topic_router_match(p_route->p_filter, p_route->filter_len, p_topic, topic_len))
+        {
+            p_route->cbk(p_data, len);
+            called++;
+        }
+    }
+    return called;
+}
+
+bool topic_router_match(const char *p_filter, int filter_len, const char *p_topic, int topic_len)
+{
+    int f = 0;
+    int t = 0;
+
+    /* Wildcards do not match the $ topics of the broker */
+    if ((0 < filter_len) && (0 < topic_len) && ('$' == p_topic[0]) && ('$' != p_filter[0]))
+    {
+        return false;
+    }
+    while (f < filter_len)
+    {
+        if ('#' == p_filter[f])
+        {
+            return true;
+        }
+        if ('+' == p_filter[f])
+        {
+            while ((t < topic_len) && ('/' != p_topic[t]))
+            {
+                t++;
+            }
+            f++;
+        }
+        else
+        {
+            if ((t == topic_len) || (p_filter[f] != p_topic[t]))
+            {
+                /* "a/#" also matches its parent "a" */
+                return ((t == topic_len) && ('/' == p_filter[f]) && ((f + 2) == filter_len) &&
+                        ('#' == p_filter[f + 1]));
+            }
+            f++;
+            t++;
+        }
+    }
+    return (t == topic_len);
+}
+//---------------------------- PRIVATE FUNCTIONS ------------------------------
+static uint32_t _router_hash(const char *p_topic, int len)
+{
+    uint32_t hash = ROUTER_FNV_OFFSET;
+    for (int i = 0; i < len; i++)
+    {
+        hash = (hash ^ (uint8_t)p_topic[i]) * ROUTER_FNV_PRIME;
+    }
+    return hash;
+}
+
+static bool _router_filter_valid(const char *p_filter, int len, bool *p_b_wildcard)
+{
+    *p_b_wildcard = false;
+    if (0 == len)
+    {
+        return false;
+    }
+    for (int i = 0; i < len; i++)
+    {
+        if (('+' != p_filter[i]) && ('#' != p_filter[i]))
+        {
+            continue;
+        }
+        bool b_level_start = ((0 == i) || ('/' == p_filter[i - 1]));
+        bool b_level_end = (((i + 1) == len) || ('/' == p_filter[i + 1]));
+        if ((!b_level_start) || (!b_level_end) || (('#' == p_filter[i]) && ((i + 1) != len)))
+        {
+            return false;
+        }
+        *p_b_wildcard = true;
+    }
+    return true;
+}
+//---------------------------- INTERRUPT HANDLERS -----------------------------
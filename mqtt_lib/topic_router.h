@@ -0,0 +1,110 @@
+/**
+* @file topic_router.h
+
+* @brief See the source file.
+
+* @par
+*
+* COPYRIGHT NOTICE: (c) 2022 Byte Lab Grupa d.o.o.
+* All rights reserved.
+*/
+
+#ifndef __TOPIC_ROUTER_H__
+#define __TOPIC_ROUTER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//--------------------------------- INCLUDES ----------------------------------
+#include "app_mqtt_defines.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+//---------------------------------- MACROS -----------------------------------
+#define TOPIC_ROUTER_BUCKETS  (16u) /* a power of two */
+#define TOPIC_ROUTER_NO_ROUTE (0u)  /* links hold the index of a route plus one */
+//-------------------------------- DATA TYPES ---------------------------------
+typedef struct
+{
+    const char            *p_filter;    /* not copied, it must stay valid */
+    uint16_t               filter_len;
+    uint32_t               hash;        /* of the filter, only used for exact ones */
+    telemetry_on_data_cb_t cbk;
+    atomic_uint_least8_t   next;        /* next exact route in the same bucket */
+} topic_route_t;
+
+typedef struct
+{
+    topic_route_t        routes[MQTT_SUBSCRIPTIONS_MAX];
+    atomic_uint_least8_t route_num;
+    atomic_uint_least8_t buckets[TOPIC_ROUTER_BUCKETS];     /* first exact route of each bucket */
+    uint8_t              wildcards[MQTT_SUBSCRIPTIONS_MAX]; /* routes with + or # filters */
+    atomic_uint_least8_t wildcard_num;
+} topic_router_t;
+//---------------------- PUBLIC FUNCTION PROTOTYPES --------------------------
+/**
+ * It leaves the router without routes, a zeroed router is one too.
+ *
+ * @param p_router The router.
+ */
+void topic_router_init(topic_router_t *p_router);
+
+/**
+ * It adds a route from a topic filter to a callback. A filter may have several
+ *       callbacks, adding the same pair again does nothing. Routes are written
+ *       before they are linked and counted with release stores, so dispatching
+ *       may run on another task. Adding is not reentrant, the caller keeps two
+ *       tasks from adding at once.
+ *
+ * @param p_router The router.
+ * @param p_filter The topic filter, + and # wildcards fill whole levels and
+ *                 # is the last one.
+ * @param cbk The callback.
+ *
+ * @return true if the route was added or already there, false if the filter
+ *         is invalid or MQTT_SUBSCRIPTIONS_MAX routes are used.
+ */
+bool topic_router_add(topic_router_t *p_router, const char *p_filter, telemetry_on_data_cb_t cbk);
+
+/**
+ * It returns how many routes there are, the routes below are complete.
+ *
+ * @param p_router The router.
+ *
+ * @return The number of routes.
+ */
+uint8_t topic_router_count(const topic_router_t *p_router);
+
+/**
+ * It passes a message to every callback whose filter matches its topic. Exact
+ *       filters are found by the hash of the topic, only wildcard filters are
+ *       matched one by one.
+ *
+ * @param p_router The router.
+ * @param p_topic The topic, not terminated.
+ * @param topic_len The length of the topic.
+ * @param p_data The payload.
+ * @param len The length of the payload.
+ *
+ * @return The number of callbacks called.
+ */
+int topic_router_dispatch(const topic_router_t *p_router, const char *p_topic, int topic_len,
+                          const uint8_t *p_data, int len);
+
+/**
+ * It matches a topic against a filter with wildcards.
+ *
+ * @param p_filter The filter.
+ * @param filter_len The length of the filter.
+ * @param p_topic The topic, not terminated.
+ * @param topic_len The length of the topic.
+ *
+ * @return true if the filter matches the topic.
+ */
+bool topic_router_match(const char *p_filter, int filter_len, const char *p_topic, int topic_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __TOPIC_ROUTER_H__
@@ -0,0 +1,102 @@
+// Host autoplayer: benchmarks the engine under the Monte Carlo bot and writes replay corpora.
+//
+// build: gcc -std=gnu11 -O2 -Iaasi/inc -Iaasi aasi/*.c tools/aasi_autoplay.c -o aasi_autoplay
+// usage: aasi_autoplay [games] [replay_dir]
+//
+// Each replay file holds "seed <n>" followed by "<timestamp_ms> <key>" lines, which is enough
+// to reproduce the game with aasi_game_new_with_random_provider() and the same seed.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <aasi/game.h>
+#include <aasi/display.h>
+#include <aasi/bot.h>
+
+#define WORLD_WIDTH 40
+#define WORLD_HEIGHT 12
+#define NUM_ALIENS 5
+#define NUM_BLOCKS 3
+
+static unsigned int _rnd_state;
+
+static unsigned int _rnd() {
+	_rnd_state ^= _rnd_state << 13;
+	_rnd_state ^= _rnd_state >> 17;
+	_rnd_state ^= _rnd_state << 5;
+	return _rnd_state;
+}
+
+static double _now_s() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+	const int games = argc > 1 ? atoi(argv[1]) : 10;
+	const char *replay_dir = argc > 2 ? argv[2] : NULL;
+	int wins[AASI_GAME_WINNER_NO_ONE + 1] = {0};
+	unsigned long rollouts = 0, ticks = 0;
+
+	aasi_display_t disp;
+	aasi_display_init_headless(&disp, WORLD_WIDTH, WORLD_HEIGHT);
+
+	const double t0 = _now_s();
+	for (int g = 0; g < games; ++g) {
+		const unsigned int seed = g + 1;
+		_rnd_state = seed;
+		aasi_game_t *game = aasi_game_new_with_random_provider(&disp, NUM_ALIENS, NUM_BLOCKS, _rnd);
+		aasi_bot_config_t cfg;
+		aasi_bot_default_config(&cfg);
+		cfg.seed = seed;
+		aasi_bot_t *bot = aasi_bot_new(&cfg);
+		if (!game || !bot) {
+			fprintf(stderr, "out of memory\n");
+			return 1;
+		}
+
+		FILE *replay = NULL;
+		if (replay_dir) {
+			char path[256];
+			snprintf(path, sizeof(path), "%s/aasi_%04d.replay", replay_dir, g);
+			replay = fopen(path, "w");
+			if (replay) {
+				fprintf(replay, "seed %u\n", seed);
+			}
+		}
+
+		unsigned long ts = 0, ts_next = 0;
+		while (aasi_game_is_running(game)) {
+			if (ts >= ts_next) {
+				const aasi_button_t key = aasi_bot_choose(bot, game);
+				if (key != AASI_GAME_KEY_NOT_MAPPED) {
+					aasi_game_handle_key(game, key);
+					if (replay) {
+						fprintf(replay, "%lu %d\n", ts, key);
+					}
+				}
+				ts_next = ts + cfg.step_ms;
+			}
+			ts += cfg.tick_ms;
+			aasi_game_task(game, ts);
+		}
+
+		wins[aasi_game_get_winner(game)]++;
+		rollouts += aasi_bot_get_rollouts(bot);
+		ticks += aasi_bot_get_ticks(bot);
+		if (replay) {
+			fclose(replay);
+		}
+		aasi_bot_delete(bot);
+		aasi_game_delete(game);
+	}
+	const double dt = _now_s() - t0;
+
+	printf("games %d: hero %d, aliens %d, timeout %d\n", games,
+	       wins[AASI_GAME_WINNER_HERO], wins[AASI_GAME_WINNER_ALIENS], wins[AASI_GAME_WINNER_TIME]);
+	printf("rollouts %lu (%.0f/s), simulated ticks %lu (%.0f/s)\n",
+	       rollouts, rollouts / dt, ticks, ticks / dt);
+	return 0;
+}
@@ -0,0 +1,350 @@
+// Host fleet load generator: simulated devices, each a process running the telemetry client of
+// the firmware, publish game reports and subscribe to MQTT_SCORE_TOPIC like the firmware,
+// to size the broker and check the client at fleet scale.
+//
+// build: gcc -std=gnu11 -O2 -Iaasi/inc -Iaasi -Imqtt_lib -Imqtt_lib/platform/inc aasi/*.c
+//        mqtt_lib/app_mqtt_client.c mqtt_lib/telemetry_outbox.c mqtt_lib/telemetry_report.c
+//        mqtt_lib/telemetry_metrics.c mqtt_lib/topic_router.c
+//        mqtt_lib/platform/src/mqtt_client_posix.c tools/aasi_fleet.c -lpthread -o aasi_fleet
+// usage: aasi_fleet [-d devices] [-r reports_per_s] [-t seconds] [-m metrics_s]
+//                   [-b bucket_shift] [-B broker_binary] [-p port]
+//
+// The broker is taken from MQTT_BROKER and defaults to aasi_mqtt_broker on localhost. With -B
+// the broker is started on the given port for the run, and its counters are printed at the end.
+//
+// Every device publishes its reports with telemetry_send_report(), retained when the score
+// beats the best one it has seen, as the firmware does. The latency of a report is the time
+// from publishing it to its copy arriving back on the subscription of the device. When all
+// devices are done, a late joiner subscribes and checks that the retained report is the best
+// one published.
+
+#include <errno.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <aasi/histogram.h>
+#include "app_mqtt_client.h"
+#include "telemetry_metrics.h"
+#include "telemetry_outbox.h"
+
+#define MAX_DEVICES 200
+#define PENDING 1024
+#define OWNER_LEN 6	// "dev" and three digits
+
+// What a device reports to the parent when it is done.
+typedef struct {
+	unsigned long sent, retained, send_failed;
+	unsigned long received, own, late;
+	unsigned long bytes_in, metrics_bytes;
+	unsigned long outbox_dropped;
+	uint32_t best_retained;
+	aasi_hist_t latency_us;
+} device_result_t;
+
+static volatile sig_atomic_t _quit;
+
+static char _owner[OWNER_LEN + 1];
+static unsigned long long _sent_us[PENDING];
+static atomic_uint _best_seen;
+static device_result_t _result;
+
+// The late joiner.
+static atomic_bool _got_retained;
+static uint32_t _retained_score;
+static char _retained_owner[TELEMETRY_REPORT_OWNER_MAX + 1];
+
+static unsigned long long _now_us() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static void _on_signal(int sig) {
+	_quit = 1;
+}
+
+static unsigned int _rnd(unsigned int *state) {
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+// Runs on the MQTT driver thread. The duration of a simulated game carries its sequence number.
+static void _on_report(const uint8_t *data, int len) {
+	telemetry_report_t report;
+	if (!telemetry_report_decode(data, len, &report)) {
+		return;
+	}
+	_result.received++;
+	_result.bytes_in += len;
+	unsigned int best = atomic_load(&_best_seen);
+	while (report.score > best && !atomic_compare_exchange_weak(&_best_seen, &best, report.score)) {
+	}
+	if (report.owner_len != OWNER_LEN || memcmp(report.p_owner, _owner, OWNER_LEN)) {
+		return;
+	}
+	// older than the send times kept, or from an earlier run
+	if (report.duration_ms >= _result.sent || _result.sent - report.duration_ms > PENDING) {
+		_result.late++;
+		return;
+	}
+	const unsigned long long sent = _sent_us[report.duration_ms % PENDING];
+	_result.own++;
+	aasi_hist_add(&_result.latency_us, _now_us() - sent);
+}
+
+static void _device(int id, double rate, double seconds, double metrics_s, int shift, int out) {
+	snprintf(_owner, sizeof(_owner), "dev%03d", id);
+	aasi_hist_init(&_result.latency_us, shift);
+	unsigned int rnd = 0x9e3779b9u * (id + 1);
+
+	if (telemetry_init() != TELEMETRY_OK) {
+		fprintf(stderr, "%s: cannot connect to %s\n", _owner, getenv("MQTT_BROKER"));
+		_exit(1);
+	}
+	telemetry_subscribe(MQTT_SCORE_TOPIC, _on_report);
+	char metrics_topic[sizeof(MQTT_METRICS_TOPIC) + OWNER_LEN + 1];
+	snprintf(metrics_topic, sizeof(metrics_topic), "%s/%s", MQTT_METRICS_TOPIC, _owner);
+	static telemetry_metrics_encoder_t encoder;
+	telemetry_metrics_encoder_init(&encoder, 6);
+	telemetry_metrics_t sample = { { 0 } };
+	// let the subscription reach the broker before the first report
+	usleep(200000);
+
+	// the devices start spread over one period, so they do not publish in lockstep
+	const unsigned long long t0 = _now_us() + _rnd(&rnd) % (unsigned int)(1e6 / rate);
+	unsigned long long next_metrics = t0;
+	for (unsigned long i = 0; !_quit; ++i) {
+		const unsigned long long due = t0 + i * 1e6 / rate;
+		if (due - t0 >= seconds * 1e6) {
+			break;
+		}
+		unsigned long long now = _now_us();
+		if (metrics_s > 0 && now >= next_metrics) {
+			uint8_t payload[TELEMETRY_METRICS_SIZE_MAX];
+			sample.value[TELEMETRY_METRIC_UPTIME_S] = (now - t0) / 1000000;
+			sample.value[TELEMETRY_METRIC_HEAP_FREE] = 120000 - _rnd(&rnd) % 512;
+			sample.value[TELEMETRY_METRIC_GAME_TICKS] = (now - t0) / 10000;
+			sample.value[TELEMETRY_METRIC_RSSI_DBM] = -60 - (int)(_rnd(&rnd) % 8);
+			const size_t len = telemetry_metrics_encode(&encoder, &sample, payload, sizeof(payload));
+			if (telemetry_publish(metrics_topic, payload, len, 0, false) == TELEMETRY_OK) {
+				_result.metrics_bytes += len;
+			} else {
+				telemetry_metrics_encoder_resync(&encoder);
+			}
+			next_metrics += metrics_s * 1e6;
+		}
+		if (due > now) {
+			usleep(due - now);
+			now = _now_us();
+		}
+
+		const uint32_t score = 1 + _rnd(&rnd) % 1000000;
+		unsigned int best = atomic_load(&_best_seen);
+		const bool retain = score > best;
+		while (retain && score > best && !atomic_compare_exchange_weak(&_best_seen, &best, score)) {
+		}
+		const telemetry_report_t report = {
+			.score = score,
+			.duration_ms = i,
+			.winner = 1,
+			.p_owner = _owner,
+			.owner_len = OWNER_LEN,
+		};
+		_sent_us[i % PENDING] = now;
+		_result.sent = i + 1;
+		if (telemetry_send_report(&report, retain) != TELEMETRY_OK) {
+			_result.send_failed++;
+			continue;
+		}
+		if (retain) {
+			_result.retained++;
+			_result.best_retained = score;
+		}
+	}
+	// reports still on their way
+	usleep(500000);
+	_result.outbox_dropped = telemetry_outbox_dropped();
+	telemetry_disconnect();
+	if (write(out, &_result, sizeof(_result)) != sizeof(_result)) {
+		_exit(1);
+	}
+	_exit(0);
+}
+
+// Runs on the MQTT driver thread. Nothing else publishes by now, the first report is the retained one.
+static void _on_retained(const uint8_t *data, int len) {
+	telemetry_report_t report;
+	if (atomic_load(&_got_retained) || !telemetry_report_decode(data, len, &report)) {
+		return;
+	}
+	_retained_score = report.score;
+	memcpy(_retained_owner, report.p_owner, report.owner_len);
+	_retained_owner[report.owner_len] = '\0';
+	atomic_store(&_got_retained, true);
+}
+
+static pid_t _start_broker(const char *path, int port) {
+	char port_arg[8];
+	snprintf(port_arg, sizeof(port_arg), "%d", port);
+	const pid_t pid = fork();
+	if (pid == 0) {
+		execl(path, path, "-p", port_arg, (char *)NULL);
+		perror(path);
+		_exit(1);
+	}
+	// until it listens
+	usleep(200000);
+	char uri[32];
+	snprintf(uri, sizeof(uri), "mqtt://127.0.0.1:%d", port);
+	setenv("MQTT_BROKER", uri, 1);
+	return pid;
+}
+
+int main(int argc, char *argv[]) {
+	int devices = 16, port = 18830, shift = 8, opt;
+	double rate = 1, seconds = 10, metrics_s = 0;
+	const char *broker = NULL;
+	while ((opt = getopt(argc, argv, "d:r:t:m:b:B:p:")) != -1) {
+		switch (opt) {
+		case 'd':
+			devices = atoi(optarg);
+			break;
+		case 'r':
+			rate = atof(optarg);
+			break;
+		case 't':
+			seconds = atof(optarg);
+			break;
+		case 'm':
+			metrics_s = atof(optarg);
+			break;
+		case 'b':
+			shift = atoi(optarg);
+			break;
+		case 'B':
+			broker = optarg;
+			break;
+		case 'p':
+			port = atoi(optarg);
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-d devices] [-r reports_per_s] [-t seconds] [-m metrics_s]\n"
+			                "       %*s [-b bucket_shift] [-B broker_binary] [-p port]\n",
+			        argv[0], (int)strlen(argv[0]), "");
+			return 1;
+		}
+	}
+	if (devices < 1 || devices > MAX_DEVICES || rate <= 0 || seconds <= 0) {
+		fprintf(stderr, "1 to %d devices, a positive rate and duration\n", MAX_DEVICES);
+		return 1;
+	}
+	signal(SIGINT, _on_signal);
+	signal(SIGTERM, _on_signal);
+	signal(SIGPIPE, SIG_IGN);
+	const pid_t broker_pid = broker ? _start_broker(broker, port) : 0;
+	setenv("MQTT_BROKER", "mqtt://127.0.0.1:1883", 0);
+
+	// a process per device, the client of the firmware is one per process
+	static int pipes[MAX_DEVICES];
+	static pid_t pids[MAX_DEVICES];
+	const unsigned long long t0 = _now_us();
+	for (int i = 0; i < devices; ++i) {
+		int fds[2];
+		if (pipe(fds)) {
+			perror("pipe");
+			return 1;
+		}
+		pids[i] = fork();
+		if (pids[i] == 0) {
+			close(fds[0]);
+			_device(i, rate, seconds, metrics_s, shift, fds[1]);
+		}
+		close(fds[1]);
+		pipes[i] = fds[0];
+	}
+
+	device_result_t total = { 0 };
+	aasi_hist_init(&total.latency_us, shift);
+	int done = 0;
+	for (int i = 0; i < devices; ++i) {
+		device_result_t r;
+		ssize_t got;
+		while ((got = read(pipes[i], &r, sizeof(r))) < 0 && errno == EINTR) {
+		}
+		close(pipes[i]);
+		waitpid(pids[i], NULL, 0);
+		if (got != sizeof(r)) {
+			fprintf(stderr, "dev%03d: no result\n", i);
+			continue;
+		}
+		done++;
+		total.sent += r.sent;
+		total.retained += r.retained;
+		total.send_failed += r.send_failed;
+		total.received += r.received;
+		total.own += r.own;
+		total.late += r.late;
+		total.bytes_in += r.bytes_in;
+		total.metrics_bytes += r.metrics_bytes;
+		total.outbox_dropped += r.outbox_dropped;
+		if (r.best_retained > total.best_retained) {
+			total.best_retained = r.best_retained;
+		}
+		for (int b = 0; b < AASI_HIST_BUCKETS; ++b) {
+			total.latency_us.bucket[b] += r.latency_us.bucket[b];
+		}
+		total.latency_us.count += r.latency_us.count;
+		total.latency_us.sum += r.latency_us.sum;
+		if (r.latency_us.max > total.latency_us.max) {
+			total.latency_us.max = r.latency_us.max;
+		}
+	}
+	const double dt = (_now_us() - t0) / 1e6;
+
+	// every report goes to every device that completed
+	const unsigned long expected = total.sent * done;
+	printf("devices %d of %d, %.1f reports/s each for %.0fs\n", done, devices, rate, seconds);
+	printf("sent %lu (%.0f/s) retained %lu failed %lu outbox dropped %lu\n", total.sent,
+	       total.sent / seconds, total.retained, total.send_failed, total.outbox_dropped);
+	printf("received %lu of %lu (%.1f%%), %.0f msgs/s %.0f bytes/s, late %lu\n", total.received,
+	       expected, expected ? 100.0 * total.received / expected : 0.0, total.received / seconds,
+	       total.bytes_in / seconds, total.late);
+	if (metrics_s > 0) {
+		printf("metrics %.0f bytes/s\n", total.metrics_bytes / seconds);
+	}
+	printf("latency us: mean %u p50 %u p90 %u p99 %u max %u\n", aasi_hist_mean(&total.latency_us),
+	       aasi_hist_percentile(&total.latency_us, 50), aasi_hist_percentile(&total.latency_us, 90),
+	       aasi_hist_percentile(&total.latency_us, 99), total.latency_us.max);
+	aasi_hist_print(&total.latency_us, "latency [us]");
+
+	// the late joiner, a fresh client in this process now that the devices are gone
+	if (telemetry_init() == TELEMETRY_OK) {
+		telemetry_subscribe(MQTT_SCORE_TOPIC, _on_retained);
+		for (int i = 0; i < 50 && !atomic_load(&_got_retained); ++i) {
+			usleep(10000);
+		}
+		telemetry_disconnect();
+	}
+	if (!atomic_load(&_got_retained)) {
+		printf("retained: none, best retained publish %u\n", total.best_retained);
+	} else {
+		printf("retained: %u by %s, best retained publish %u, %s\n", _retained_score, _retained_owner,
+		       total.best_retained, _retained_score == total.best_retained ? "ok" : "stale");
+	}
+	printf("run %.1fs\n", dt);
+
+	if (broker_pid > 0) {
+		fflush(stdout);
+		kill(broker_pid, SIGTERM);
+		waitpid(broker_pid, NULL, 0);
+	}
+	return 0;
+}
@@ -0,0 +1,441 @@
+// Local MQTT broker stand-in for host tests of the telemetry, spectator and controller streams.
+//
+// build: gcc -std=gnu11 -O2 tools/aasi_mqtt_broker.c -o aasi_mqtt_broker
+// usage: aasi_mqtt_broker [-p port] [-v]
+//
+// A single threaded MQTT 3.1.1 subset: CONNECT, PUBLISH with QoS 0 and 1, retained messages,
+// SUBSCRIBE and UNSUBSCRIBE with + and # wildcards, PINGREQ and DISCONNECT. Messages are
+// forwarded with QoS 0. A subscriber that does not read fast enough has messages dropped
+// instead of backing up the publisher. Traffic counters are printed on SIGINT, SIGTERM and,
+// with -v, every second with the traffic since the last print. The retained counters and the
+// deepest send queue of a client are there to size a real broker, see aasi_fleet.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_CLIENTS 256
+#define MAX_SUBS 8
+#define MAX_RETAINED 64
+#define TOPIC_MAX 128
+#define RX_SIZE (16 * 1024)
+#define TX_LIMIT (256 * 1024)
+
+typedef struct {
+	int fd;
+	bool connected;
+	char subs[MAX_SUBS][TOPIC_MAX];
+	int num_subs;
+	uint8_t rx[RX_SIZE];
+	int rx_len;
+	uint8_t *tx;
+	int tx_len;
+	int tx_cap;
+} client_t;
+
+typedef struct {
+	char topic[TOPIC_MAX];
+	uint8_t *data;
+	int len;
+} retained_t;
+
+typedef struct {
+	unsigned long connects;
+	unsigned long msgs_in;
+	unsigned long bytes_in;
+	unsigned long msgs_out;
+	unsigned long bytes_out;
+	unsigned long dropped;
+	unsigned long retained_set;		// publishes replacing a retained message
+	unsigned long retained_cleared;		// empty retained publishes
+	unsigned long retained_full;		// retained messages lost for lack of a slot
+	unsigned long retained_out;		// retained messages sent to new subscriptions
+	int tx_peak;				// deepest send queue of a client, bytes
+} stats_t;
+
+static client_t *_clients[MAX_CLIENTS];
+static retained_t _retained[MAX_RETAINED];
+static stats_t _stats, _last;
+static volatile sig_atomic_t _quit;
+static bool _verbose;
+
+static void _on_signal(int sig) {
+	_quit = 1;
+}
+
+static void _print_stats(void) {
+	int clients = 0;
+	for (int i = 0; i < MAX_CLIENTS; ++i) {
+		clients += _clients[i] != NULL;
+	}
+	int retained = 0;
+	for (int i = 0; i < MAX_RETAINED; ++i) {
+		retained += _retained[i].data != NULL;
+	}
+	printf("clients %d connects %lu in %lu msgs %lu bytes out %lu msgs %lu bytes dropped %lu\n",
+	       clients, _stats.connects, _stats.msgs_in, _stats.bytes_in,
+	       _stats.msgs_out, _stats.bytes_out, _stats.dropped);
+	printf("  since last in %lu msgs %lu bytes out %lu msgs %lu bytes, tx queue peak %d bytes\n",
+	       _stats.msgs_in - _last.msgs_in, _stats.bytes_in - _last.bytes_in,
+	       _stats.msgs_out - _last.msgs_out, _stats.bytes_out - _last.bytes_out, _stats.tx_peak);
+	printf("  retained %d topics set %lu cleared %lu full %lu sent %lu\n", retained,
+	       _stats.retained_set, _stats.retained_cleared, _stats.retained_full, _stats.retained_out);
+	fflush(stdout);
+	_last = _stats;
+}
+
+// MQTT topic filter matching, + is one level and # the rest.
+static bool _topic_matches(const char *filter, const char *topic, int topic_len) {
+	const char *t = topic, *end = topic + topic_len;
+	while (*filter) {
+		if (*filter == '#') {
+			return true;
+		}
+		if (*filter == '+') {
+			while (t < end && *t != '/') {
+				++t;
+			}
+			++filter;
+		} else {
+			if (t == end || *filter != *t) {
+				return false;
+			}
+			++filter;
+			++t;
+		}
+	}
+	return t == end;
+}
+
+static bool _send(client_t *c, uint8_t type, const void *a, int a_len, const void *b, int b_len,
+                  const void *d, int d_len) {
+	const int len = a_len + b_len + d_len;
+	if (c->tx_len + len + 5 > TX_LIMIT) {
+		_stats.dropped++;
+		return false;
+	}
+	if (c->tx_len + len + 5 > c->tx_cap) {
+		int cap = c->tx_cap ? c->tx_cap : 4096;
+		while (cap < c->tx_len + len + 5) {
+			cap *= 2;
+		}
+		uint8_t *tx = realloc(c->tx, cap);
+		if (!tx) {
+			_stats.dropped++;
+			return false;
+		}
+		c->tx = tx;
+		c->tx_cap = cap;
+	}
+	c->tx[c->tx_len++] = type;
+	int remaining = len;
+	do {
+		c->tx[c->tx_len++] = (remaining & 0x7f) | (remaining > 0x7f ? 0x80 : 0);
+		remaining >>= 7;
+	} while (remaining);
+	memcpy(c->tx + c->tx_len, a, a_len);
+	c->tx_len += a_len;
+	memcpy(c->tx + c->tx_len, b, b_len);
+	c->tx_len += b_len;
+	memcpy(c->tx + c->tx_len, d, d_len);
+	c->tx_len += d_len;
+	if (c->tx_len > _stats.tx_peak) {
+		_stats.tx_peak = c->tx_len;
+	}
+	return true;
+}
+
+static void _forward(client_t *c, const char *topic, int topic_len, const uint8_t *data, int len, bool retain) {
+	const uint8_t hdr[2] = { topic_len >> 8, topic_len & 0xff };
+	uint8_t topic_hdr[2 + TOPIC_MAX];
+	memcpy(topic_hdr, hdr, 2);
+	memcpy(topic_hdr + 2, topic, topic_len);
+	if (_send(c, 0x30 | (retain ? 0x01 : 0), topic_hdr, 2 + topic_len, NULL, 0, data, len)) {
+		_stats.msgs_out++;
+		_stats.bytes_out += len;
+	}
+}
+
+static void _retain(const char *topic, int topic_len, const uint8_t *data, int len) {
+	retained_t *slot = NULL;
+	for (int i = 0; i < MAX_RETAINED && !slot; ++i) {
+		if (_retained[i].data && (int)strlen(_retained[i].topic) == topic_len &&
+		    !memcmp(_retained[i].topic, topic, topic_len)) {
+			slot = &_retained[i];
+		}
+	}
+	if (slot) {
+		free(slot->data);
+		slot->data = NULL;
+	}
+	if (!len) {
+		_stats.retained_cleared++;
+		return;
+	}
+	for (int i = 0; i < MAX_RETAINED && !slot; ++i) {
+		if (!_retained[i].data) {
+			slot = &_retained[i];
+		}
+	}
+	if (slot && (slot->data = malloc(len))) {
+		memcpy(slot->topic, topic, topic_len);
+		slot->topic[topic_len] = '\0';
+		memcpy(slot->data, data, len);
+		slot->len = len;
+		_stats.retained_set++;
+	} else {
+		_stats.retained_full++;
+	}
+}
+
+static void _on_publish(client_t *c, uint8_t type, const uint8_t *p, int len) {
+	const int qos = (type >> 1) & 3;
+	if (len < 2) {
+		return;
+	}
+	const int topic_len = p[0] << 8 | p[1];
+	const int payload = 2 + topic_len + (qos ? 2 : 0);
+	if (topic_len >= TOPIC_MAX || payload > len) {
+		return;
+	}
+	const char *topic = (const char *)p + 2;
+	_stats.msgs_in++;
+	_stats.bytes_in += len - payload;
+	if (qos) {
+		_send(c, 0x40, p + 2 + topic_len, 2, NULL, 0, NULL, 0);
+	}
+	if (type & 0x01) {
+		_retain(topic, topic_len, p + payload, len - payload);
+	}
+	for (int i = 0; i < MAX_CLIENTS; ++i) {
+		client_t *sub = _clients[i];
+		for (int s = 0; sub && s < sub->num_subs; ++s) {
+			if (_topic_matches(sub->subs[s], topic, topic_len)) {
+				_forward(sub, topic, topic_len, p + payload, len - payload, false);
+				break;
+			}
+		}
+	}
+}
+
+static void _on_subscribe(client_t *c, const uint8_t *p, int len, bool subscribe) {
+	uint8_t ack[2 + MAX_SUBS] = { p[0], p[1] };
+	int acks = 0;
+	for (int pos = 2; pos + 2 <= len; ) {
+		const int topic_len = p[pos] << 8 | p[pos + 1];
+		pos += 2;
+		if (pos + topic_len + (subscribe ? 1 : 0) > len || topic_len >= TOPIC_MAX) {
+			break;
+		}
+		char filter[TOPIC_MAX];
+		memcpy(filter, p + pos, topic_len);
+		filter[topic_len] = '\0';
+		pos += topic_len + (subscribe ? 1 : 0);
+
+		int found = -1;
+		for (int s = 0; s < c->num_subs; ++s) {
+			if (!strcmp(c->subs[s], filter)) {
+				found = s;
+			}
+		}
+		if (subscribe) {
+			bool ok = found >= 0 || c->num_subs < MAX_SUBS;
+			if (ok && found < 0) {
+				strcpy(c->subs[c->num_subs++], filter);
+			}
+			if (acks < MAX_SUBS) {
+				ack[2 + acks++] = ok ? 0x00 : 0x80;
+			}
+			for (int r = 0; ok && r < MAX_RETAINED; ++r) {
+				if (_retained[r].data &&
+				    _topic_matches(filter, _retained[r].topic, strlen(_retained[r].topic))) {
+					_forward(c, _retained[r].topic, strlen(_retained[r].topic),
+					         _retained[r].data, _retained[r].len, true);
+					_stats.retained_out++;
+				}
+			}
+		} else if (found >= 0) {
+			c->subs[found][0] = '\0';
+			strcpy(c->subs[found], c->subs[--c->num_subs]);
+		}
+	}
+	_send(c, subscribe ? 0x90 : 0xb0, ack, 2 + acks, NULL, 0, NULL, 0);
+}
+
+// Returns false if the client has to be closed.
+static bool _on_packet(client_t *c, uint8_t type, const uint8_t *p, int len) {
+	if (!c->connected && (type & 0xf0) != 0x10) {
+		return false;
+	}
+	switch (type & 0xf0) {
+	case 0x10: {
+		static const uint8_t connack[2] = { 0, 0 };
+		c->connected = true;
+		_stats.connects++;
+		_send(c, 0x20, connack, 2, NULL, 0, NULL, 0);
+		return true;
+	}
+	case 0x30:
+		_on_publish(c, type, p, len);
+		return true;
+	case 0x80:
+		_on_subscribe(c, p, len, true);
+		return len >= 2;
+	case 0xa0:
+		_on_subscribe(c, p, len, false);
+		return len >= 2;
+	case 0xc0:
+		_send(c, 0xd0, NULL, 0, NULL, 0, NULL, 0);
+		return true;
+	case 0xe0:
+		return false;
+	default:
+		// PUBACK and friends, nothing is sent with QoS 1 so nothing waits for them
+		return true;
+	}
+}
+
+static bool _on_readable(client_t *c) {
+	const ssize_t got = recv(c->fd, c->rx + c->rx_len, sizeof(c->rx) - c->rx_len, 0);
+	if (got <= 0) {
+		return got < 0 && errno == EAGAIN;
+	}
+	c->rx_len += got;
+	int pos = 0;
+	for (;;) {
+		int remaining = 0, hdr = 1, shift = 0;
+		while (pos + hdr < c->rx_len && (c->rx[pos + hdr] & 0x80) && hdr < 4) {
+			remaining |= (c->rx[pos + hdr] & 0x7f) << shift;
+			shift += 7;
+			++hdr;
+		}
+		if (pos + hdr >= c->rx_len) {
+			break;
+		}
+		remaining |= (c->rx[pos + hdr] & 0x7f) << shift;
+		++hdr;
+		if (pos + hdr + remaining > c->rx_len) {
+			break;
+		}
+		if (!_on_packet(c, c->rx[pos], c->rx + pos + hdr, remaining)) {
+			return false;
+		}
+		pos += hdr + remaining;
+	}
+	memmove(c->rx, c->rx + pos, c->rx_len - pos);
+	c->rx_len -= pos;
+	return c->rx_len < (int)sizeof(c->rx);
+}
+
+static bool _on_writable(client_t *c) {
+	const ssize_t sent = send(c->fd, c->tx, c->tx_len, MSG_NOSIGNAL);
+	if (sent < 0) {
+		return errno == EAGAIN;
+	}
+	memmove(c->tx, c->tx + sent, c->tx_len - sent);
+	c->tx_len -= sent;
+	return true;
+}
+
+static void _close(int i) {
+	close(_clients[i]->fd);
+	free(_clients[i]->tx);
+	free(_clients[i]);
+	_clients[i] = NULL;
+}
+
+int main(int argc, char *argv[]) {
+	int port = 1883, opt;
+	while ((opt = getopt(argc, argv, "p:v")) != -1) {
+		switch (opt) {
+		case 'p':
+			port = atoi(optarg);
+			break;
+		case 'v':
+			_verbose = true;
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-p port] [-v]\n", argv[0]);
+			return 1;
+		}
+	}
+	signal(SIGINT, _on_signal);
+	signal(SIGTERM, _on_signal);
+
+	const int lfd = socket(AF_INET, SOCK_STREAM, 0);
+	const int one = 1;
+	setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+	struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(port),
+	                            .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+	if (bind(lfd, (struct sockaddr *)&addr, sizeof(addr)) || listen(lfd, 64)) {
+		perror("listen");
+		return 1;
+	}
+	printf("listening on 127.0.0.1:%d\n", port);
+	fflush(stdout);
+
+	time_t last_print = time(NULL);
+	while (!_quit) {
+		struct pollfd fds[MAX_CLIENTS + 1];
+		int idx[MAX_CLIENTS + 1];
+		int n = 0;
+		fds[n] = (struct pollfd){ .fd = lfd, .events = POLLIN };
+		idx[n++] = -1;
+		for (int i = 0; i < MAX_CLIENTS; ++i) {
+			if (_clients[i]) {
+				fds[n] = (struct pollfd){ .fd = _clients[i]->fd,
+				                          .events = POLLIN | (_clients[i]->tx_len ? POLLOUT : 0) };
+				idx[n++] = i;
+			}
+		}
+		if (poll(fds, n, 200) < 0) {
+			continue;
+		}
+
+		if (fds[0].revents & POLLIN) {
+			const int fd = accept(lfd, NULL, NULL);
+			int slot = -1;
+			for (int i = 0; i < MAX_CLIENTS && slot < 0; ++i) {
+				if (!_clients[i]) {
+					slot = i;
+				}
+			}
+			if (fd >= 0 && slot >= 0 && (_clients[slot] = calloc(1, sizeof(client_t)))) {
+				fcntl(fd, F_SETFL, O_NONBLOCK);
+				_clients[slot]->fd = fd;
+			} else if (fd >= 0) {
+				close(fd);
+			}
+		}
+		for (int k = 1; k < n; ++k) {
+			client_t *c = _clients[idx[k]];
+			bool ok = true;
+			if (fds[k].revents & (POLLIN | POLLHUP | POLLERR)) {
+				ok = _on_readable(c);
+			}
+			if (ok && (fds[k].revents & POLLOUT)) {
+				ok = _on_writable(c);
+			}
+			if (!ok) {
+				_close(idx[k]);
+			}
+		}
+
+		if (_verbose && time(NULL) != last_print) {
+			last_print = time(NULL);
+			_print_stats();
+		}
+	}
+	_print_stats();
+	return 0;
+}
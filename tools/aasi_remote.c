@@ -0,0 +1,215 @@
+// Host remote controller: a stand-in device taking key events over MQTT and a load generator
+// measuring the round trip from publishing an event to its acknowledgement.
+//
+// build: gcc -std=gnu11 -O2 -Iaasi/inc -Iaasi -Imqtt_lib -Imqtt_lib/platform/inc aasi/*.c
+//        mqtt_lib/app_mqtt_client.c mqtt_lib/telemetry_outbox.c mqtt_lib/telemetry_report.c
+//        mqtt_lib/topic_router.c mqtt_lib/platform/src/mqtt_client_posix.c
+//        tools/aasi_remote.c -lpthread -o aasi_remote
+// usage: aasi_remote device [-t seconds]
+//        aasi_remote load [-r events_per_s] [-n events] [-b bucket_shift]
+//
+// The broker is taken from MQTT_BROKER and defaults to aasi_mqtt_broker on localhost. The
+// device runs the game loop of the firmware in real time, one tick every 10 ms, so round
+// trips include waiting for the next tick as they do on hardware.
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <aasi/game.h>
+#include <aasi/display.h>
+#include <aasi/remote.h>
+#include <aasi/histogram.h>
+#include "app_mqtt_client.h"
+
+#define WORLD_WIDTH 40
+#define WORLD_HEIGHT 30
+#define TICK_US 10000
+// indices as the button_t ids of the firmware, the load only presses left, right and fire
+#define BUTTON_LEFT 2
+#define BUTTON_RIGHT 3
+#define BUTTON_A 4
+#define LOAD_PENDING 4096
+
+static const aasi_button_t _button_map[] = {
+	AASI_GAME_KEY_NOT_MAPPED, AASI_GAME_KEY_NOT_MAPPED, AASI_GAME_KEY_LEFT, AASI_GAME_KEY_RIGHT,
+	AASI_GAME_KEY_FIRE, AASI_GAME_KEY_DIE, AASI_GAME_KEY_NOT_MAPPED,
+};
+
+static volatile sig_atomic_t _quit;
+static aasi_remote_t _remote;
+static aasi_game_t *_Atomic _game;
+static atomic_uint _game_users;
+
+static aasi_hist_t _rtt_us;
+static unsigned long _acked, _rejected, _stale;
+
+static unsigned long long _now_us() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static void _on_signal(int sig) {
+	_quit = 1;
+}
+
+static bool _ack(void *priv, const char *msg, size_t len) {
+	return telemetry_publish(MQTT_CONTROL_ACK_TOPIC, msg, len, 0, false) == TELEMETRY_OK;
+}
+
+// Runs on the MQTT driver thread, like the MQTT event handler on the device.
+static void _on_event(const uint8_t *data, int len) {
+	// the game is not deleted while it is held, see the end of a game in _device()
+	atomic_fetch_add(&_game_users, 1);
+	aasi_remote_on_event(&_remote, atomic_load(&_game), data, len);
+	atomic_fetch_sub(&_game_users, 1);
+}
+
+static int _device(int argc, char *argv[]) {
+	double seconds = 0;
+	int opt;
+	while ((opt = getopt(argc, argv, "t:")) != -1) {
+		if (opt != 't') {
+			return 1;
+		}
+		seconds = atof(optarg);
+	}
+
+	aasi_display_t disp;
+	aasi_display_init_headless(&disp, WORLD_WIDTH, WORLD_HEIGHT);
+	aasi_remote_init(&_remote, _button_map, sizeof(_button_map) / sizeof(*_button_map), _ack, NULL);
+	telemetry_subscribe(MQTT_CONTROL_TOPIC, _on_event);
+
+	// the time limit also ends the game in play
+	const unsigned long long end = seconds > 0 ? _now_us() + seconds * 1e6 : ULLONG_MAX;
+	int games = 0;
+	while (!_quit && _now_us() < end) {
+		aasi_game_t *game = aasi_game_new(&disp, 5, 3);
+		const unsigned long long start = _now_us();
+		unsigned long long next = start;
+		_game = game;
+		while (aasi_game_is_running(game) && !_quit && _now_us() < end) {
+			aasi_game_task(game, (_now_us() - start) / 1000 / GAME_SPEED_FACTOR);
+			aasi_remote_task(&_remote, game);
+			next += TICK_US;
+			const unsigned long long now = _now_us();
+			if (next > now) {
+				usleep(next - now);
+			}
+		}
+		atomic_store(&_game, NULL);
+		while (atomic_load(&_game_users)) {
+			usleep(100);
+		}
+		aasi_remote_task(&_remote, game);
+		aasi_remote_abort(&_remote);
+		aasi_game_delete(game);
+		games++;
+	}
+	printf("games %d\n", games);
+	aasi_remote_print(&_remote, "remote");
+	return 0;
+}
+
+static unsigned long long _sent_us[LOAD_PENDING];
+
+static void _on_ack(const uint8_t *data, int len) {
+	char msg[AASI_REMOTE_MSG_MAX];
+	unsigned int id;
+	unsigned long long ts;
+	long tick;
+	if (len >= (int)sizeof(msg)) {
+		return;
+	}
+	memcpy(msg, data, len);
+	msg[len] = '\0';
+	if (sscanf(msg, "%u %llu %ld", &id, &ts, &tick) != 3) {
+		return;
+	}
+	if (ts != _sent_us[id % LOAD_PENDING]) {
+		_stale++;
+		return;
+	}
+	if (tick < 0) {
+		_rejected++;
+		return;
+	}
+	_acked++;
+	aasi_hist_add(&_rtt_us, _now_us() - ts);
+}
+
+static int _load(int argc, char *argv[]) {
+	double rate = 50;
+	long count = 1000;
+	int shift = 9, opt;
+	while ((opt = getopt(argc, argv, "r:n:b:")) != -1) {
+		switch (opt) {
+		case 'r':
+			rate = atof(optarg);
+			break;
+		case 'n':
+			count = atol(optarg);
+			break;
+		case 'b':
+			shift = atoi(optarg);
+			break;
+		default:
+			return 1;
+		}
+	}
+
+	aasi_hist_init(&_rtt_us, shift);
+	telemetry_subscribe(MQTT_CONTROL_ACK_TOPIC, _on_ack);
+	// let the subscription reach the broker before the first event
+	usleep(100000);
+
+	static const int buttons[] = { BUTTON_LEFT, BUTTON_RIGHT, BUTTON_A };
+	const unsigned long long t0 = _now_us();
+	for (long i = 0; i < count && !_quit; ++i) {
+		const unsigned long long due = t0 + i * 1e6 / rate;
+		unsigned long long now = _now_us();
+		if (due > now) {
+			usleep(due - now);
+			now = _now_us();
+		}
+		char msg[AASI_REMOTE_MSG_MAX];
+		_sent_us[i % LOAD_PENDING] = now;
+		const int len = snprintf(msg, sizeof(msg), "%ld %llu %d", i, now, buttons[i % 3]);
+		telemetry_publish(MQTT_CONTROL_TOPIC, msg, len, 0, false);
+	}
+	// acknowledgements still on their way
+	usleep(500000);
+
+	printf("sent %ld acked %lu rejected %lu stale %lu lost %ld\n", count, _acked, _rejected, _stale,
+	       count - (long)(_acked + _rejected + _stale));
+	printf("rtt us: mean %u p50 %u p90 %u p99 %u max %u\n", aasi_hist_mean(&_rtt_us),
+	       aasi_hist_percentile(&_rtt_us, 50), aasi_hist_percentile(&_rtt_us, 90),
+	       aasi_hist_percentile(&_rtt_us, 99), _rtt_us.max);
+	aasi_hist_print(&_rtt_us, "rtt [us]");
+	return 0;
+}
+
+int main(int argc, char *argv[]) {
+	if (argc < 2 || (strcmp(argv[1], "device") && strcmp(argv[1], "load"))) {
+		fprintf(stderr, "usage: %s device [-t seconds]\n"
+		                "       %s load [-r events_per_s] [-n events] [-b bucket_shift]\n", argv[0], argv[0]);
+		return 1;
+	}
+	signal(SIGINT, _on_signal);
+	signal(SIGTERM, _on_signal);
+	setenv("MQTT_BROKER", "mqtt://127.0.0.1:1883", 0);
+	if (telemetry_init() != TELEMETRY_OK) {
+		fprintf(stderr, "cannot connect to %s\n", getenv("MQTT_BROKER"));
+		return 1;
+	}
+
+	const int ret = !strcmp(argv[1], "device") ? _device(argc - 1, argv + 1) : _load(argc - 1, argv + 1);
+	telemetry_disconnect();
+	return ret;
+}
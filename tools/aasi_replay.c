@@ -0,0 +1,123 @@
+// Host replayer: plays aasi_autoplay replays on the ANSI terminal backend.
+//
+// build: gcc -std=gnu11 -O2 -Iaasi/inc -Iaasi aasi/*.c tools/aasi_replay.c -o aasi_replay
+// usage: aasi_replay [-q] [-s speed] replay...
+//
+// By default the games are drawn to stdout, -s sets how many times faster than real time
+// (0, the default, runs as fast as the terminal takes it). With -q nothing is drawn and only
+// the bytes every frame would have cost are counted, which is how rendering efficiency of
+// engine changes is compared over a whole corpus.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <aasi/game.h>
+#include <aasi/term.h>
+#include <aasi/bot.h>
+
+// must match aasi_autoplay
+#define WORLD_WIDTH 40
+#define WORLD_HEIGHT 12
+#define NUM_ALIENS 5
+#define NUM_BLOCKS 3
+
+static unsigned int _rnd_state;
+
+static unsigned int _rnd() {
+	_rnd_state ^= _rnd_state << 13;
+	_rnd_state ^= _rnd_state >> 17;
+	_rnd_state ^= _rnd_state << 5;
+	return _rnd_state;
+}
+
+static void _write_stdout(void *priv, const char *buf, size_t len) {
+	fwrite(buf, 1, len, stdout);
+	fflush(stdout);
+}
+
+static double _now_s() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static bool _replay(aasi_term_t *term, FILE *in, unsigned long tick_ms, double speed) {
+	unsigned int seed;
+	if (fscanf(in, "seed %u", &seed) != 1) {
+		return false;
+	}
+	_rnd_state = seed;
+	aasi_game_t *game = aasi_game_new_with_random_provider(aasi_term_display(term), NUM_ALIENS, NUM_BLOCKS, _rnd);
+	if (!game) {
+		return false;
+	}
+	aasi_display_start(aasi_term_display(term));
+
+	unsigned long ts = 0, ts_key;
+	int key;
+	bool have_key = fscanf(in, "%lu %d", &ts_key, &key) == 2;
+	while (aasi_game_is_running(game)) {
+		while (have_key && ts_key <= ts) {
+			aasi_game_handle_key(game, key);
+			have_key = fscanf(in, "%lu %d", &ts_key, &key) == 2;
+		}
+		ts += tick_ms;
+		aasi_game_task(game, ts);
+		if (speed > 0) {
+			usleep(tick_ms * 1000 / speed);
+		}
+	}
+	aasi_game_delete(game);
+	aasi_display_destroy(aasi_term_display(term));
+	return true;
+}
+
+int main(int argc, char *argv[]) {
+	bool quiet = false;
+	double speed = 0;
+	int opt;
+	while ((opt = getopt(argc, argv, "qs:")) != -1) {
+		switch (opt) {
+		case 'q':
+			quiet = true;
+			break;
+		case 's':
+			speed = atof(optarg);
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-q] [-s speed] replay...\n", argv[0]);
+			return 1;
+		}
+	}
+
+	aasi_bot_config_t cfg;
+	aasi_bot_default_config(&cfg);
+	aasi_term_t *term = aasi_term_new(WORLD_WIDTH, WORLD_HEIGHT, quiet ? NULL : _write_stdout, NULL);
+	if (!term) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+
+	int games = 0;
+	const double t0 = _now_s();
+	for (int i = optind; i < argc; ++i) {
+		FILE *in = fopen(argv[i], "r");
+		if (!in || !_replay(term, in, cfg.tick_ms, speed)) {
+			fprintf(stderr, "%s: cannot replay\n", argv[i]);
+		} else {
+			games++;
+		}
+		if (in) {
+			fclose(in);
+		}
+	}
+	const double dt = _now_s() - t0;
+
+	printf("games %d in %.2fs\n", games, dt);
+	aasi_term_print(term, "term");
+	aasi_term_delete(term);
+	return 0;
+}
@@ -0,0 +1,224 @@
+// Host spectator: streams replays to MQTT_SPECTATOR_TOPIC and watches the stream in a terminal.
+//
+// build: gcc -std=gnu11 -O2 -Iaasi/inc -Iaasi -Imqtt_lib -Imqtt_lib/platform/inc aasi/*.c
+//        mqtt_lib/app_mqtt_client.c mqtt_lib/telemetry_outbox.c mqtt_lib/telemetry_report.c
+//        mqtt_lib/topic_router.c mqtt_lib/platform/src/mqtt_client_posix.c
+//        tools/aasi_spectate.c -lpthread -o aasi_spectate
+// usage: aasi_spectate play [-s speed] replay...
+//        aasi_spectate watch [-q] [-t seconds]
+//
+// The broker is taken from MQTT_BROKER and defaults to aasi_mqtt_broker on localhost, so
+//
+//   aasi_mqtt_broker & aasi_spectate watch & aasi_spectate play -s 4 replays/*.replay
+//
+// runs the stream end to end. Both sides print a checksum of the last frame, which match
+// when the watcher kept up with the stream.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <aasi/game.h>
+#include <aasi/display.h>
+#include <aasi/spectator.h>
+#include <aasi/term.h>
+#include <aasi/bot.h>
+#include "app_mqtt_client.h"
+
+// must match aasi_autoplay
+#define WORLD_WIDTH 40
+#define WORLD_HEIGHT 12
+#define NUM_ALIENS 5
+#define NUM_BLOCKS 3
+
+static unsigned int _rnd_state;
+static volatile sig_atomic_t _quit;
+
+static aasi_spec_view_t _view;
+static aasi_term_t *_term;
+static unsigned long _packets, _bytes, _applied;
+
+static unsigned int _rnd() {
+	_rnd_state ^= _rnd_state << 13;
+	_rnd_state ^= _rnd_state >> 17;
+	_rnd_state ^= _rnd_state << 5;
+	return _rnd_state;
+}
+
+static double _now_s() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void _on_signal(int sig) {
+	_quit = 1;
+}
+
+static unsigned int _checksum(const char *cells, int count) {
+	unsigned int h = 2166136261u;
+	for (int i = 0; i < count; ++i) {
+		h = (h ^ (unsigned char)cells[i]) * 16777619u;
+	}
+	return h;
+}
+
+static bool _publish(void *priv, const uint8_t *data, size_t len) {
+	return telemetry_publish(MQTT_SPECTATOR_TOPIC, data, len, 0, false) == TELEMETRY_OK;
+}
+
+static int _backlog(void *priv) {
+	return telemetry_outbox_size();
+}
+
+static void _write_stdout(void *priv, const char *buf, size_t len) {
+	fwrite(buf, 1, len, stdout);
+	fflush(stdout);
+}
+
+// Runs on the MQTT driver thread.
+static void _on_frame(const uint8_t *data, int len) {
+	_packets++;
+	_bytes += len;
+	if (!aasi_spec_view_apply(&_view, data, len)) {
+		return;
+	}
+	_applied++;
+	if (_term) {
+		aasi_term_show_cells(_term, _view.cells);
+	}
+}
+
+static int _play(int argc, char *argv[]) {
+	double speed = 1;
+	int opt;
+	while ((opt = getopt(argc, argv, "s:")) != -1) {
+		if (opt != 's') {
+			return 1;
+		}
+		speed = atof(optarg);
+	}
+
+	aasi_display_t disp;
+	aasi_display_init_headless(&disp, WORLD_WIDTH, WORLD_HEIGHT);
+	aasi_spec_config_t spec_cfg;
+	aasi_spec_default_config(&spec_cfg);
+	static aasi_spec_t spec;
+	aasi_spec_init(&spec, &spec_cfg, WORLD_WIDTH, WORLD_HEIGHT, _publish, _backlog, NULL);
+	aasi_bot_config_t cfg;
+	aasi_bot_default_config(&cfg);
+	static char cells[WORLD_WIDTH * WORLD_HEIGHT];
+
+	// the spectator runs on stream time, which is game time across all replays
+	unsigned long ts_stream = 0;
+	const double t0 = _now_s();
+	for (int i = optind; i < argc && !_quit; ++i) {
+		FILE *in = fopen(argv[i], "r");
+		unsigned int seed;
+		if (!in || fscanf(in, "seed %u", &seed) != 1) {
+			fprintf(stderr, "%s: cannot replay\n", argv[i]);
+			if (in) {
+				fclose(in);
+			}
+			continue;
+		}
+		_rnd_state = seed;
+		aasi_game_t *game = aasi_game_new_with_random_provider(&disp, NUM_ALIENS, NUM_BLOCKS, _rnd);
+		aasi_spec_restart(&spec);
+
+		unsigned long ts = 0, ts_key;
+		int key;
+		bool have_key = fscanf(in, "%lu %d", &ts_key, &key) == 2;
+		while (aasi_game_is_running(game) && !_quit) {
+			while (have_key && ts_key <= ts) {
+				aasi_game_handle_key(game, key);
+				have_key = fscanf(in, "%lu %d", &ts_key, &key) == 2;
+			}
+			ts += cfg.tick_ms;
+			ts_stream += cfg.tick_ms;
+			aasi_game_task(game, ts);
+			if (aasi_spec_frame(&spec, game, ts_stream)) {
+				aasi_game_get_cells(game, cells);
+			}
+			if (speed > 0) {
+				const double ahead = ts_stream / 1000.0 / speed - (_now_s() - t0);
+				if (ahead > 0) {
+					usleep(ahead * 1e6);
+				}
+			}
+		}
+		aasi_game_delete(game);
+		fclose(in);
+	}
+	while (telemetry_outbox_size() && !_quit) {
+		usleep(10000);
+	}
+	const double dt = _now_s() - t0;
+
+	aasi_spec_print(&spec, "spectator");
+	printf("stream %.1fs in %.1fs, %.0f bytes/s of stream time, last frame %08x\n",
+	       ts_stream / 1000.0, dt, aasi_spec_get_stats(&spec)->bytes / (ts_stream / 1000.0),
+	       _checksum(cells, sizeof(cells)));
+	return 0;
+}
+
+static int _watch(int argc, char *argv[]) {
+	bool quiet = false;
+	double seconds = 0;
+	int opt;
+	while ((opt = getopt(argc, argv, "qt:")) != -1) {
+		switch (opt) {
+		case 'q':
+			quiet = true;
+			break;
+		case 't':
+			seconds = atof(optarg);
+			break;
+		default:
+			return 1;
+		}
+	}
+
+	aasi_spec_view_init(&_view);
+	if (!quiet) {
+		_term = aasi_term_new(WORLD_WIDTH, WORLD_HEIGHT, _write_stdout, NULL);
+		aasi_display_start(aasi_term_display(_term));
+	}
+	if (telemetry_subscribe(MQTT_SPECTATOR_TOPIC, _on_frame) != TELEMETRY_OK) {
+		fprintf(stderr, "cannot subscribe\n");
+		return 1;
+	}
+	const double t0 = _now_s();
+	while (!_quit && (seconds <= 0 || _now_s() - t0 < seconds)) {
+		usleep(10000);
+	}
+	if (_term) {
+		aasi_display_destroy(aasi_term_display(_term));
+		aasi_term_delete(_term);
+	}
+	printf("packets %lu applied %lu lost %lu bytes %lu, last frame %08x\n",
+	       _packets, _applied, _view.lost, _bytes, _checksum(_view.cells, _view.width * _view.height));
+	return 0;
+}
+
+int main(int argc, char *argv[]) {
+	if (argc < 2 || (strcmp(argv[1], "play") && strcmp(argv[1], "watch"))) {
+		fprintf(stderr, "usage: %s play [-s speed] replay...\n"
+		                "       %s watch [-q] [-t seconds]\n", argv[0], argv[0]);
+		return 1;
+	}
+	signal(SIGINT, _on_signal);
+	signal(SIGTERM, _on_signal);
+	setenv("MQTT_BROKER", "mqtt://127.0.0.1:1883", 0);
+	if (telemetry_init() != TELEMETRY_OK) {
+		fprintf(stderr, "cannot connect to %s\n", getenv("MQTT_BROKER"));
+		return 1;
+	}
+
+	const int ret = !strcmp(argv[1], "play") ? _play(argc - 1, argv + 1) : _watch(argc - 1, argv + 1);
+	telemetry_disconnect();
+	return ret;
+}
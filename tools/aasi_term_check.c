@@ -0,0 +1,232 @@
+// Host check of the ANSI terminal backend: feeds it random frames and replays what it writes
+// on a virtual terminal, which has to show every frame exactly.
+//
+// build: gcc -std=gnu11 -O2 -fsanitize=address -Iaasi/inc -Iaasi aasi/*.c tools/aasi_term_check.c
+//        -o aasi_term_check
+// usage: aasi_term_check [-n frames] [-s seed]
+//
+// Grids are presented cell by cell on sizes from the smallest display to rows several times
+// wider than the output buffer, then as labels drawn, moved and deleted through the display
+// API. The virtual terminal takes the subset of sequences the backend uses and fails on
+// anything else, on a move off the screen and on a character written past the last column.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <aasi/display.h>
+#include <aasi/term.h>
+
+#define LABELS 8
+
+typedef struct {
+	int width;
+	int height;
+	char *cells;
+	int y;
+	int x;			// width while the cursor waits in the last column
+	char seq[32];	// escape sequence split across writes
+	size_t seq_len;
+	unsigned long errors;
+} vt_t;
+
+static unsigned int _rnd_state;
+
+static unsigned int _rnd() {
+	_rnd_state ^= _rnd_state << 13;
+	_rnd_state ^= _rnd_state >> 17;
+	_rnd_state ^= _rnd_state << 5;
+	return _rnd_state;
+}
+
+static void _vt_fail(vt_t *vt, const char *what) {
+	if (vt->errors++ < 10) {
+		fprintf(stderr, "vt %dx%d: %s at %d,%d\n", vt->width, vt->height, what, vt->y, vt->x);
+	}
+}
+
+static void _vt_sequence(vt_t *vt) {
+	const char *const s = vt->seq + 2;
+	int a = 0, b = 0;
+	char end = vt->seq[vt->seq_len - 1];
+	if (!strcmp(s, "?25l") || !strcmp(s, "?25h")) {
+		return;
+	}
+	if (!strcmp(s, "2J")) {
+		memset(vt->cells, ' ', vt->width * vt->height);
+	} else if (!strcmp(s, "H")) {
+		vt->y = vt->x = 0;
+	} else if (end == 'H' && sscanf(s, "%d;%dH", &a, &b) == 2) {
+		// the destroy sequence parks the cursor on the row below the game
+		if (a < 1 || a > vt->height + 1 || b < 1 || b > vt->width) {
+			_vt_fail(vt, "move off the screen");
+		}
+		vt->y = a - 1;
+		vt->x = b - 1;
+	} else if (end == 'C' && sscanf(s, "%dC", &a) == 1) {
+		if (vt->x + a >= vt->width) {
+			_vt_fail(vt, "forward move off the screen");
+		}
+		vt->x += a;
+	} else {
+		_vt_fail(vt, "unknown sequence");
+	}
+}
+
+static void _vt_write(void *priv, const char *buf, size_t len) {
+	vt_t *vt = priv;
+	for (size_t i = 0; i < len; ++i) {
+		const char c = buf[i];
+		if (vt->seq_len) {
+			if (vt->seq_len == sizeof(vt->seq) - 1) {
+				_vt_fail(vt, "sequence too long");
+				vt->seq_len = 0;
+				continue;
+			}
+			vt->seq[vt->seq_len++] = c;
+			if (vt->seq_len > 2 && c >= '@' && c <= '~') {
+				vt->seq[vt->seq_len] = '\0';
+				_vt_sequence(vt);
+				vt->seq_len = 0;
+			}
+		} else if (c == '\033') {
+			vt->seq[vt->seq_len++] = c;
+		} else if (c == '\r') {
+			vt->x = 0;
+		} else if (c == '\n') {
+			vt->y++;
+		} else if (vt->y >= vt->height || vt->x >= vt->width) {
+			_vt_fail(vt, "character off the screen");
+		} else {
+			vt->cells[vt->y * vt->width + vt->x++] = c;
+		}
+	}
+}
+
+static bool _vt_matches(vt_t *vt, const char *cells, const char *what, int frame) {
+	if (!memcmp(vt->cells, cells, vt->width * vt->height)) {
+		return true;
+	}
+	_vt_fail(vt, what);
+	fprintf(stderr, "  frame %d differs\n", frame);
+	return false;
+}
+
+// Each frame changes a random share of the cells, from none to all of them, so some rows
+// change as a single run.
+static unsigned long _check_cells(int width, int height, int frames) {
+	const int size = width * height;
+	vt_t vt = { .width = width, .height = height, .cells = malloc(size) };
+	char *grid = malloc(size);
+	aasi_term_t *term = aasi_term_new(width, height, _vt_write, &vt);
+	if (!vt.cells || !grid || !term) {
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+	aasi_display_start(aasi_term_display(term));
+	memset(grid, ' ', size);
+	for (int frame = 0; frame < frames; ++frame) {
+		const unsigned int share = frame % 4 ? _rnd() % 101 : 100;
+		for (int i = 0; i < size; ++i) {
+			if (_rnd() % 100 < share) {
+				grid[i] = ' ' + (grid[i] - ' ' + 1 + _rnd() % 94) % 95;
+			}
+		}
+		aasi_term_show_cells(term, grid);
+		if (!_vt_matches(&vt, grid, "cells", frame)) {
+			break;
+		}
+	}
+	aasi_display_destroy(aasi_term_display(term));
+	aasi_term_delete(term);
+	free(grid);
+	free(vt.cells);
+	return vt.errors;
+}
+
+// One label per row at most, so the expected grid does not depend on the slot order.
+static unsigned long _check_labels(int width, int height, int frames) {
+	const int size = width * height;
+	vt_t vt = { .width = width, .height = height, .cells = malloc(size) };
+	char *grid = malloc(size);
+	aasi_term_t *term = aasi_term_new(width, height, _vt_write, &vt);
+	if (!vt.cells || !grid || !term) {
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+	aasi_display_t *display = aasi_term_display(term);
+	const int labels = height < LABELS ? height : LABELS;
+	void *obj[LABELS] = { NULL };
+	int row[LABELS], col[LABELS];
+	char text[LABELS][AASI_TERM_TEXT_MAX + 1];
+	aasi_display_start(display);
+	for (int frame = 0; frame < frames; ++frame) {
+		const int label = _rnd() % labels;
+		if (obj[label] && _rnd() % 4 == 0) {
+			aasi_display_objdel(display, &obj[label]);
+		} else {
+			const int len = 1 + _rnd() % AASI_TERM_TEXT_MAX;
+			for (int i = 0; i < len; ++i) {
+				text[label][i] = '!' + _rnd() % 94;
+			}
+			text[label][len] = '\0';
+			row[label] = label;
+			col[label] = _rnd() % width;
+			aasi_display_mvputs(display, &obj[label], row[label], col[label], text[label]);
+		}
+		aasi_display_present(display);
+
+		memset(grid, ' ', size);
+		for (int i = 0; i < labels; ++i) {
+			if (obj[i]) {
+				int len = strlen(text[i]);
+				len = col[i] + len > width ? width - col[i] : len;
+				memcpy(grid + row[i] * width + col[i], text[i], len);
+			}
+		}
+		if (!_vt_matches(&vt, grid, "labels", frame)) {
+			break;
+		}
+	}
+	aasi_display_destroy(display);
+	aasi_term_delete(term);
+	free(grid);
+	free(vt.cells);
+	return vt.errors;
+}
+
+int main(int argc, char *argv[]) {
+	static const int sizes[][2] = {
+		{ 8, 3 }, { 9, 4 }, { 40, 12 }, { 80, 24 }, { 200, 60 },
+		{ AASI_TERM_OUT_SIZE - 1, 3 }, { AASI_TERM_OUT_SIZE + 1, 3 }, { 3 * AASI_TERM_OUT_SIZE + 7, 4 },
+	};
+	int frames = 200;
+	unsigned int seed = 1;
+	int opt;
+	while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+		switch (opt) {
+		case 'n':
+			frames = atoi(optarg);
+			break;
+		case 's':
+			seed = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-n frames] [-s seed]\n", argv[0]);
+			return 1;
+		}
+	}
+	_rnd_state = seed ? seed : 1;
+
+	unsigned long errors = 0;
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+		const int width = sizes[i][0], height = sizes[i][1];
+		const unsigned long cells = _check_cells(width, height, frames);
+		const unsigned long labels = _check_labels(width, height, frames);
+		printf("%5dx%-3d cells %s labels %s\n", width, height, cells ? "FAIL" : "ok", labels ? "FAIL" : "ok");
+		errors += cells + labels;
+	}
+	printf("%s\n", errors ? "FAIL" : "ok");
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,167 @@
+// Host benchmark of the button drivers on the Linux HAL backend: bouncy presses on a GPIO
+// button through the debounce state machine, and noisy levels on an ADC button pair.
+//
+// build: gcc -std=gnu11 -O2 -Iboard_io -Iboard_io/platform/inc -Ibutton -Ibutton/platform/inc
+//        board_io/platform/src/board_io_linux.c button/button_fsm.c button/platform/src/button_gpio.c
+//        button/platform/src/button_adc.c tools/button_bench.c -o button_bench
+// usage: button_bench [-n presses] [-a adc_noise_mV] [-s seed]
+//
+// The service task of the firmware is replaced by a loop stepping the virtual clock by
+// STEP_US, edges reach the state machine from the edge callback as they do from the ISR.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "board_io_linux.h"
+#include "button_fsm.h"
+
+#define GPIO_PIN 32
+#define ADC_PIN 34
+#define STEP_US 100
+#define ADC_SAMPLE_US 10000
+#define BOUNCE_MAX 6
+#define BOUNCE_SPAN_US 5000
+
+static button_gpio_t *_gpio;
+static button_fsm_t _fsm;
+static unsigned long _presses, _releases, _repeats;
+static long long _press_err_us;
+static int64_t _expected_press_us;
+
+static double _now_s() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void _on_event(button_t btn_name, button_event_type_t type, int64_t timestamp_us) {
+	switch (type) {
+	case BUTTON_EVENT_PRESS:
+		_presses++;
+		_press_err_us += llabs(timestamp_us - _expected_press_us);
+		break;
+	case BUTTON_EVENT_RELEASE:
+		_releases++;
+		break;
+	default:
+		_repeats++;
+		break;
+	}
+}
+
+static void _on_edge(void *p_param) {
+	button_fsm_level(&_fsm, button_gpio_is_pressed(_gpio), board_io_time_us());
+}
+
+// Appends a bouncy edge to level at t, the bounces settle within BOUNCE_SPAN_US.
+static size_t _edge(board_io_linux_step_t *steps, size_t n, int64_t t, uint32_t level) {
+	const int bounces = rand() % (BOUNCE_MAX / 2 + 1) * 2;
+	int64_t at = t;
+	steps[n++] = (board_io_linux_step_t){ at, level };
+	for (int i = 0; i < bounces; ++i) {
+		at += 1 + rand() % (BOUNCE_SPAN_US / BOUNCE_MAX);
+		steps[n++] = (board_io_linux_step_t){ at, (i % 2) ? level : !level };
+	}
+	return n;
+}
+
+static void _debounce(long count, unsigned int seed) {
+	// active low: 1 is released, each press is a falling and a rising edge with bounces
+	board_io_linux_step_t *steps = malloc(sizeof(*steps) * (1 + count * 2 * (BOUNCE_MAX + 1)));
+	int64_t *press_us = malloc(sizeof(*press_us) * count);
+	size_t n = 0;
+	int64_t t = 1000;
+	steps[n++] = (board_io_linux_step_t){ 0, 1 };
+	for (long i = 0; i < count; ++i) {
+		t += 30000 + rand() % 120000;
+		press_us[i] = t;
+		n = _edge(steps, n, t, 0);
+		t += 30000 + rand() % 120000;
+		n = _edge(steps, n, t, 1);
+	}
+	const int64_t end = t + 100000;
+
+	board_io_linux_reset(seed);
+	board_io_linux_script(GPIO_PIN, steps, n);
+	_gpio = button_gpio_create(GPIO_PIN, BUTTON_A, false, _on_edge);
+	button_fsm_init(&_fsm, BUTTON_A, _on_event);
+	button_fsm_t *const fsm = &_fsm;
+
+	const double t0 = _now_s();
+	long next = 0;
+	for (int64_t now = 0; now < end; now += STEP_US) {
+		if (next < count && press_us[next] <= now + STEP_US) {
+			_expected_press_us = press_us[next++];
+		}
+		board_io_linux_run_until(now + STEP_US);
+		if (board_io_time_us() >= fsm->deadline_us) {
+			button_fsm_deadline(fsm, button_gpio_is_pressed(_gpio), board_io_time_us());
+		}
+	}
+	const double wall = _now_s() - t0;
+
+	printf("debounce: %ld presses (%zu edges) in %.1f s simulated, %.3f s wall, %.0f presses/s\n",
+	       count, n, end / 1e6, wall, count / wall);
+	printf("  press events %lu release events %lu repeats %lu, mean press stamp error %.1f us\n",
+	       _presses, _releases, _repeats, _presses ? (double)_press_err_us / _presses : 0.0);
+	button_gpio_destroy(_gpio);
+	free(press_us);
+	free(steps);
+}
+
+static void _adc(long count, uint32_t noise_mV, unsigned int seed) {
+	static const uint32_t levels[] = { 0, BUTTON_HIGH_VOLTAGE_LVL, BUTTON_LOW_VOLTAGE_LVL };
+	board_io_linux_step_t *steps = malloc(sizeof(*steps) * count);
+	for (long i = 0; i < count; ++i) {
+		steps[i] = (board_io_linux_step_t){ (int64_t)i * ADC_SAMPLE_US, levels[rand() % 3] };
+	}
+	board_io_linux_reset(seed);
+	button_adc_t *high = button_adc_create(ADC_PIN, BUTTON_LEFT, BUTTON_HIGH_VOLTAGE_LVL);
+	button_adc_t *low = button_adc_create(ADC_PIN, BUTTON_RIGHT, BUTTON_LOW_VOLTAGE_LVL);
+	board_io_linux_script(ADC_PIN, steps, count);
+	board_io_linux_set_noise(ADC_PIN, noise_mV);
+
+	unsigned long wrong = 0;
+	const double t0 = _now_s();
+	for (long i = 0; i < count; ++i) {
+		board_io_linux_run_until((int64_t)i * ADC_SAMPLE_US);
+		button_adc_sample();
+		wrong += button_adc_is_pressed(high) != (steps[i].value == BUTTON_HIGH_VOLTAGE_LVL);
+		wrong += button_adc_is_pressed(low) != (steps[i].value == BUTTON_LOW_VOLTAGE_LVL);
+	}
+	const double wall = _now_s() - t0;
+
+	printf("adc: %ld samples at +-%u mV noise, %lu of %ld button states wrong (%.3f%%), %.0f samples/s\n",
+	       count, noise_mV, wrong, 2 * count, 100.0 * wrong / (2 * count), count / wall);
+	button_adc_destroy(high);
+	button_adc_destroy(low);
+	free(steps);
+}
+
+int main(int argc, char *argv[]) {
+	long count = 10000;
+	unsigned int noise = 50, seed = 1;
+	int opt;
+	while ((opt = getopt(argc, argv, "n:a:s:")) != -1) {
+		switch (opt) {
+		case 'n':
+			count = atol(optarg);
+			break;
+		case 'a':
+			noise = atoi(optarg);
+			break;
+		case 's':
+			seed = atoi(optarg);
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-n presses] [-a adc_noise_mV] [-s seed]\n", argv[0]);
+			return 1;
+		}
+	}
+	srand(seed);
+	_debounce(count, seed);
+	_adc(count, noise, seed);
+	return 0;
+}
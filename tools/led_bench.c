@@ -0,0 +1,140 @@
+// Host benchmark of the LED sequencer on the Linux HAL backend: random pattern switches,
+// with and without timeouts, checked against a reference model of the step tables.
+//
+// build: gcc -std=gnu11 -O2 -Iboard_io -Iboard_io/platform/inc -Iled -Iled/platform/inc
+//        board_io/platform/src/board_io_linux.c led/led_seq.c led/platform/src/led_gpio.c
+//        tools/led_bench.c -o led_bench
+// usage: led_bench [-n switches] [-s seed]
+//
+// The timer of the firmware is replaced by jumping the virtual clock straight to the next
+// deadline, so the recording shows the pattern timing without the tick rounding.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "board_io_linux.h"
+#include "led_seq.h"
+
+#define LED_PIN 2
+#define SWITCH_MAX_MS 3000
+
+static const led_step_t _off[] = { { false, 0 } };
+static const led_step_t _on[] = { { true, 0 } };
+static const led_step_t _slow[] = { { true, LED_SLOW_BLINKING_MS }, { false, LED_SLOW_BLINKING_MS } };
+static const led_step_t _fast[] = { { true, LED_FAST_BLINKING_MS }, { false, LED_FAST_BLINKING_MS } };
+static const led_step_t _prov[] = { { true, LED_PROVISIONING_MS }, { false, LED_PROVISIONING_MS } };
+static const led_step_t _double[] = { { true, 50 }, { false, 50 }, { true, 50 }, { false, 400 } };
+
+static const led_sequence_t _patterns[] = {
+	{ _off, 1, 0 }, { _on, 1, 0 }, { _slow, 2, 0 }, { _fast, 2, 0 }, { _prov, 2, 0 },
+	{ _double, 4, 3 },	// custom: three double blinks, then off
+};
+#define PATTERN_NUM (sizeof(_patterns) / sizeof(*_patterns))
+
+typedef struct {
+	int64_t start_ms;
+	const led_sequence_t *seq;
+	uint32_t timeout_ms;
+} segment_t;
+
+static double _now_s() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Level of the sequence elapsed_ms after it started.
+static bool _reference(const led_sequence_t *seq, uint32_t timeout_ms, int64_t elapsed_ms) {
+	if (timeout_ms && elapsed_ms >= timeout_ms) {
+		return false;
+	}
+	for (unsigned loops = 0; !seq->repeat || loops < seq->repeat; ++loops) {
+		for (int i = 0; i < seq->step_num; ++i) {
+			if (!seq->p_steps[i].duration_ms || elapsed_ms < seq->p_steps[i].duration_ms) {
+				return seq->p_steps[i].b_on;
+			}
+			elapsed_ms -= seq->p_steps[i].duration_ms;
+		}
+	}
+	return false;
+}
+
+int main(int argc, char *argv[]) {
+	long count = 10000;
+	unsigned int seed = 1;
+	int opt;
+	while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+		switch (opt) {
+		case 'n':
+			count = atol(optarg);
+			break;
+		case 's':
+			seed = atoi(optarg);
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-n switches] [-s seed]\n", argv[0]);
+			return 1;
+		}
+	}
+	srand(seed);
+	board_io_linux_reset(seed);
+
+	segment_t *segments = malloc(sizeof(*segments) * (count + 1));
+	int64_t t = 0;
+	for (long i = 0; i < count; ++i) {
+		segments[i].start_ms = t;
+		segments[i].seq = &_patterns[rand() % PATTERN_NUM];
+		segments[i].timeout_ms = rand() % 4 ? 0 : 1 + rand() % SWITCH_MAX_MS;
+		t += 1 + rand() % SWITCH_MAX_MS;
+	}
+	segments[count] = (segment_t){ t, &_patterns[0], 0 };
+
+	const size_t log_len = count * 64;
+	board_io_linux_transition_t *log = malloc(sizeof(*log) * log_len);
+	board_io_linux_record(log, log_len);
+	led_seq_t seq;
+	led_seq_init(&seq, led_gpio_create(LED_PIN));
+
+	unsigned long advances = 0;
+	const double t0 = _now_s();
+	int64_t next_ms = LED_SEQ_NO_DEADLINE;
+	for (long i = 0; i <= count; ++i) {
+		const int64_t switch_ms = segments[i].start_ms;
+		while (next_ms <= switch_ms) {
+			board_io_linux_run_until(next_ms * 1000);
+			next_ms = led_seq_advance(&seq, next_ms);
+			advances++;
+		}
+		board_io_linux_run_until(switch_ms * 1000);
+		led_seq_start(&seq, segments[i].seq, segments[i].timeout_ms, switch_ms);
+		next_ms = led_seq_advance(&seq, switch_ms);
+	}
+	const double wall = _now_s() - t0;
+	const size_t recorded = board_io_linux_recorded();
+
+	// replay the recording against the reference, sampling the middle of every millisecond
+	unsigned long wrong = 0;
+	size_t at = 0;
+	bool level = false;
+	for (long i = 0; i < count && recorded <= log_len; ++i) {
+		for (int64_t ms = segments[i].start_ms; ms < segments[i + 1].start_ms; ++ms) {
+			while (at < recorded && log[at].t_us <= ms * 1000 + 500) {
+				level = log[at++].b_level;
+			}
+			wrong += level != _reference(segments[i].seq, segments[i].timeout_ms, ms - segments[i].start_ms);
+		}
+	}
+
+	printf("%ld switches over %.0f s simulated: %zu transitions, %lu advances, %.3f s wall, %.0f switches/s\n",
+	       count, t / 1e3, recorded, advances, wall, count / wall);
+	if (recorded > log_len) {
+		printf("recording overflowed, not checked\n");
+		return 1;
+	}
+	printf("%lu of %lld ms differ from the reference\n", wrong, (long long)t);
+	free(log);
+	free(segments);
+	return wrong != 0;
+}
@@ -0,0 +1,177 @@
+// Host check of the metrics payload: encodes random samples with telemetry_metrics_encode(),
+// passes them through a lossy channel and decodes them with telemetry_metrics_decode().
+//
+// build: gcc -std=gnu11 -O2 -Imqtt_lib mqtt_lib/telemetry_metrics.c tools/telemetry_metrics_check.c
+//        -o telemetry_metrics_check
+// usage: telemetry_metrics_check [-n samples] [-k keyframe_every] [-s seed]
+//
+// The channel drops samples, delivers some twice, cuts some short before delivering them and
+// restarts the sender, which starts its sequence again like a device that rebooted. A model of
+// the decoder follows the channel: every sample decoded has to equal the one encoded, the
+// decoder has to refuse samples from a lost keyframe up to the next one, repeats and cut ones
+// have to be refused without changing anything, and the loss it counts has to be the samples
+// dropped, not counting the ones dropped right before a restart.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "telemetry_metrics.h"
+
+// out of 1000 samples
+#define DROP 80
+#define REPEAT 60
+#define CUT 30
+#define SEND_FAILED 10
+#define RESTART 5
+// the first sample after a restart has to go back in the sequence
+#define RESTART_AFTER 64
+
+static unsigned int _rnd_state;
+
+static unsigned int _rnd() {
+	_rnd_state ^= _rnd_state << 13;
+	_rnd_state ^= _rnd_state >> 17;
+	_rnd_state ^= _rnd_state << 5;
+	return _rnd_state;
+}
+
+// Most metrics stay put, some move a little and a few jump anywhere, the extremes included.
+static void _next_sample(telemetry_metrics_t *sample) {
+	for (int i = 0; i < TELEMETRY_METRIC_COUNT; ++i) {
+		const unsigned int r = _rnd() % 100;
+		if (r < 60) {
+			continue;
+		} else if (r < 95) {
+			sample->value[i] = (int32_t)((uint32_t)sample->value[i] + _rnd() % 65 - 32);
+		} else if (r < 98) {
+			sample->value[i] = (int32_t)_rnd();
+		} else {
+			sample->value[i] = _rnd() % 2 ? INT32_MAX : INT32_MIN;
+		}
+	}
+}
+
+int main(int argc, char *argv[]) {
+	unsigned long samples = 100000;
+	unsigned int keyframe_every = 8;
+	unsigned int seed = 1;
+	int opt;
+	while ((opt = getopt(argc, argv, "n:k:s:")) != -1) {
+		switch (opt) {
+		case 'n':
+			samples = strtoul(optarg, NULL, 0);
+			break;
+		case 'k':
+			keyframe_every = strtoul(optarg, NULL, 0);
+			break;
+		case 's':
+			seed = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-n samples] [-k keyframe_every] [-s seed]\n", argv[0]);
+			return 1;
+		}
+	}
+	_rnd_state = seed ? seed : 1;
+
+	telemetry_metrics_encoder_t enc;
+	telemetry_metrics_decoder_t dec;
+	telemetry_metrics_encoder_init(&enc, keyframe_every);
+	telemetry_metrics_decoder_init(&dec);
+	telemetry_metrics_t sample = { { 0 } };
+
+	// the model of the decoder
+	bool started = false, synced = false;
+	unsigned int epoch = 0, last_epoch = 0;
+	unsigned long pending = 0, lost = 0;
+
+	unsigned long errors = 0, decoded = 0, refused = 0, dropped = 0, repeated = 0, cut = 0;
+	unsigned long restarts = 0, bytes = 0, keyframe_bytes = 0, keyframes = 0;
+	unsigned long n;
+	for (n = 0; n < samples && errors < 10; ++n) {
+		if (enc.seq >= RESTART_AFTER && _rnd() % 1000 < RESTART) {
+			telemetry_metrics_encoder_init(&enc, keyframe_every);
+			epoch++;
+			restarts++;
+		}
+		_next_sample(&sample);
+		uint8_t payload[TELEMETRY_METRICS_SIZE_MAX];
+		const size_t len = telemetry_metrics_encode(&enc, &sample, payload, sizeof(payload));
+		if (!len) {
+			fprintf(stderr, "sample %lu: does not fit\n", n);
+			errors++;
+			continue;
+		}
+		// the flags byte, a keyframe brings the decoder back in sync
+		const bool keyframe = payload[1] & 1;
+		bytes += len;
+		keyframe_bytes += keyframe ? len : 0;
+		keyframes += keyframe;
+
+		const unsigned int r = _rnd() % 1000;
+		if (r < DROP + SEND_FAILED) {
+			if (r >= DROP) {
+				telemetry_metrics_encoder_resync(&enc);
+			}
+			dropped++;
+			pending++;
+			continue;
+		}
+
+		const telemetry_metrics_t before = dec.last;
+		telemetry_metrics_t got;
+		if (r < DROP + SEND_FAILED + CUT) {
+			cut++;
+			if (telemetry_metrics_decode(&dec, payload, _rnd() % len, &got) ||
+			    memcmp(&before, &dec.last, sizeof(before))) {
+				fprintf(stderr, "sample %lu: a cut payload was taken\n", n);
+				errors++;
+			}
+		}
+
+		if (started && epoch == last_epoch) {
+			lost += pending;
+			synced = synced && !pending;
+		} else {
+			synced = false;
+		}
+		started = true;
+		last_epoch = epoch;
+		pending = 0;
+		synced = synced || keyframe;
+
+		const bool ok = telemetry_metrics_decode(&dec, payload, len, &got);
+		if (ok != synced) {
+			fprintf(stderr, "sample %lu: decoded %d, expected %d\n", n, ok, synced);
+			errors++;
+		} else if (ok && memcmp(&got, &sample, sizeof(got))) {
+			fprintf(stderr, "sample %lu: decoded a different sample\n", n);
+			errors++;
+		}
+		decoded += ok;
+		refused += !ok;
+
+		if (r < DROP + SEND_FAILED + CUT + REPEAT) {
+			repeated++;
+			const telemetry_metrics_t last = dec.last;
+			if (telemetry_metrics_decode(&dec, payload, len, &got) || memcmp(&last, &dec.last, sizeof(last))) {
+				fprintf(stderr, "sample %lu: a repeat was taken\n", n);
+				errors++;
+			}
+		}
+		if (dec.lost != lost) {
+			fprintf(stderr, "sample %lu: lost %u, expected %lu\n", n, dec.lost, lost);
+			errors++;
+		}
+	}
+
+	printf("samples %lu: decoded %lu, refused %lu, dropped %lu, repeated %lu, cut %lu, restarts %lu, "
+	       "lost %u\n", n, decoded, refused, dropped, repeated, cut, restarts, dec.lost);
+	printf("bytes per sample %.1f, keyframe %.1f, delta %.1f\n", (double)bytes / n,
+	       keyframes ? (double)keyframe_bytes / keyframes : 0.0,
+	       n > keyframes ? (double)(bytes - keyframe_bytes) / (n - keyframes) : 0.0);
+	printf("%s\n", errors ? "FAIL" : "ok");
+	return errors ? 1 : 0;
+}
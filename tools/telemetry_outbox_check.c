@@ -0,0 +1,212 @@
+// Host check of the telemetry outbox: queues reports while offline and flushes them through a
+// stub of the MQTT driver, which records what is published and acknowledges it on demand.
+//
+// build: gcc -std=gnu11 -O2 -Imqtt_lib -Imqtt_lib/platform/inc mqtt_lib/telemetry_outbox.c
+//        mqtt_lib/telemetry_report.c tools/telemetry_outbox_check.c -o telemetry_outbox_check
+// usage: telemetry_outbox_check
+//
+// The outbox keeps its state in statics, so the steps run in order in one process:
+//   - 40 reports queued offline fill the RAM ring and every segment, a flush publishes all of
+//     them oldest first;
+//   - a flush before the broker acknowledged anything may publish them again, but loses none;
+//   - acknowledging the messages of the last flush empties the store;
+//   - 50 reports queued offline drop the 16 oldest, two segments overwritten by newer ones, the
+//     drops are counted and a flush publishes the other 34 once each.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mqtt_client_esp.h"
+#include "telemetry_outbox.h"
+
+#define STORE_SLOTS ((int)TELEMETRY_OUTBOX_SEGMENTS + 1)
+#define STORE_SIZE 1024
+#define PUBLISHED_MAX 256
+#define SCORES_MAX 128
+#define OWNER "outbox"
+
+static bool _online;
+static int _next_msg_id = 1;
+
+static struct {
+	size_t len;		// 0 if empty
+	uint8_t data[STORE_SIZE];
+} _store[STORE_SLOTS];
+
+// Reports published on MQTT_SCORE_TOPIC, with the id of their message.
+static struct {
+	int msg_id;
+	uint32_t score;
+} _published[PUBLISHED_MAX];
+static int _published_num;
+
+static int _errors;
+
+// The stub driver, only what the outbox uses.
+
+void driver_telemetry_lock(void) {
+}
+
+void driver_telemetry_unlock(void) {
+}
+
+bool driver_telemetry_store_write(uint8_t slot, const void *p_data, size_t len) {
+	if (slot >= STORE_SLOTS || len > STORE_SIZE) {
+		return false;
+	}
+	memcpy(_store[slot].data, p_data, len);
+	_store[slot].len = len;
+	return true;
+}
+
+size_t driver_telemetry_store_read(uint8_t slot, void *p_data, size_t len) {
+	if (slot >= STORE_SLOTS || !_store[slot].len || _store[slot].len > len) {
+		return 0;
+	}
+	memcpy(p_data, _store[slot].data, _store[slot].len);
+	return _store[slot].len;
+}
+
+void driver_telemetry_store_erase(uint8_t slot) {
+	if (slot < STORE_SLOTS) {
+		_store[slot].len = 0;
+	}
+}
+
+int driver_telemetry_publish_acked(const char *p_topic, const void *p_data, int len, bool retain) {
+	telemetry_report_t report;
+	if (!_online) {
+		return -1;
+	}
+	if (!strcmp(p_topic, MQTT_SCORE_TOPIC) && telemetry_report_decode(p_data, len, &report)) {
+		if (_published_num == PUBLISHED_MAX) {
+			fprintf(stderr, "too many messages published\n");
+			exit(1);
+		}
+		_published[_published_num].msg_id = _next_msg_id;
+		_published[_published_num].score = report.score;
+		_published_num++;
+	}
+	return _next_msg_id++;
+}
+
+telemetry_err_t driver_telemetry_publish(const char *p_topic, const void *p_data, int len, int qos, bool retain) {
+	return _online ? TELEMETRY_OK : TELEMETRY_SEND_FAILED;
+}
+
+static void _check(bool ok, const char *step, const char *what) {
+	if (!ok) {
+		fprintf(stderr, "%s: %s\n", step, what);
+		_errors++;
+	}
+}
+
+static void _send(uint32_t score) {
+	uint8_t payload[TELEMETRY_REPORT_SIZE_MAX];
+	const telemetry_report_t report = {
+		.score = score,
+		.winner = 1,
+		.p_owner = OWNER,
+		.owner_len = sizeof(OWNER) - 1,
+	};
+	const size_t len = telemetry_report_encode(&report, payload, sizeof(payload));
+	_check(telemetry_outbox_send(payload, len, false) == TELEMETRY_OK, "send", "refused");
+}
+
+static int _store_used(void) {
+	int used = 0;
+	for (int i = 0; i < STORE_SLOTS; ++i) {
+		used += _store[i].len != 0;
+	}
+	return used;
+}
+
+// Counts how often each score in first..last was published, and the scores outside of it.
+static void _count(uint32_t first, uint32_t last, int times[SCORES_MAX], int *others) {
+	memset(times, 0, SCORES_MAX * sizeof(int));
+	*others = 0;
+	for (int i = 0; i < _published_num; ++i) {
+		const uint32_t score = _published[i].score;
+		if (score >= first && score <= last) {
+			times[score]++;
+		} else {
+			(*others)++;
+		}
+	}
+}
+
+static void _check_published(const char *step, uint32_t first, uint32_t last, bool once, bool in_order) {
+	int times[SCORES_MAX], others;
+	_count(first, last, times, &others);
+	for (uint32_t score = first; score <= last; ++score) {
+		if (!times[score] || (once && times[score] > 1)) {
+			fprintf(stderr, "%s: report %u published %d times\n", step, score, times[score]);
+			_errors++;
+		}
+	}
+	_check(!others, step, "reports published that were not queued");
+	for (int i = 1; in_order && i < _published_num; ++i) {
+		if (_published[i].score <= _published[i - 1].score) {
+			fprintf(stderr, "%s: report %u published after %u\n", step, _published[i].score,
+			        _published[i - 1].score);
+			_errors++;
+			break;
+		}
+	}
+}
+
+static void _ack_published(int from) {
+	for (int i = from; i < _published_num; ++i) {
+		telemetry_outbox_on_published(_published[i].msg_id);
+	}
+}
+
+int main(void) {
+	const char *step = "40 offline";
+	for (uint32_t score = 1; score <= 40; ++score) {
+		_send(score);
+	}
+	_check(telemetry_outbox_pending() == 40, step, "not all queued");
+	_check(telemetry_outbox_dropped() == 0, step, "dropped");
+	_check(_store_used() == TELEMETRY_OUTBOX_SEGMENTS, step, "not every segment spilled");
+	_online = true;
+	telemetry_outbox_flush();
+	_check_published(step, 1, 40, true, true);
+	_check(telemetry_outbox_pending() == 0, step, "left in the outbox");
+	_check(_store_used() == TELEMETRY_OUTBOX_SEGMENTS, step, "segments erased before their acks");
+	printf("%-12s published %d, store %d segments\n", step, _published_num, _store_used());
+
+	// a reconnect before the acks, what the first flush published stays counted
+	step = "reflush";
+	const int reflush_from = _published_num;
+	telemetry_outbox_flush();
+	_check_published(step, 1, 40, false, false);
+	_check(telemetry_outbox_pending() == 0, step, "left in the outbox");
+	printf("%-12s published %d, store %d segments\n", step, _published_num, _store_used());
+
+	// acks of the first flush were forgotten by the second one, those of the last flush count
+	step = "acks";
+	_ack_published(reflush_from);
+	_check(_store_used() == 0, step, "store not empty");
+	printf("%-12s acked %d, store %d segments\n", step, _published_num - reflush_from, _store_used());
+	_published_num = 0;
+
+	step = "50 offline";
+	_online = false;
+	for (uint32_t score = 41; score <= 90; ++score) {
+		_send(score);
+	}
+	_check(telemetry_outbox_dropped() == 16, step, "wrong drop count");
+	_check(telemetry_outbox_pending() == 34, step, "wrong number queued");
+	_online = true;
+	telemetry_outbox_flush();
+	_check_published(step, 57, 90, true, true);
+	_ack_published(0);
+	_check(_store_used() == 0, step, "store not empty");
+	printf("%-12s dropped %u, published %d, store %d segments\n", step, telemetry_outbox_dropped(),
+	       _published_num, _store_used());
+
+	printf("%s\n", _errors ? "FAIL" : "ok");
+	return _errors ? 1 : 0;
+}
@@ -112,6 +112,13 @@ wifi_err_t wifi_event_handler_register(wifi_on_status_changed_cb_t wifi_status_c
  */
 bool is_connected();
 
+/**
+ * It reads the RSSI of the access point from the WiFi driver.
+ * 
+ * @return The RSSI in dBm, 0 if not connected.
+ */
+int8_t get_rssi(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -275,6 +275,16 @@ bool is_connected()
 {
     return _b_is_wifi_connected;
 }
+
+int8_t get_rssi(void)
+{
+    wifi_ap_record_t ap_info;
+    if ((!_b_is_wifi_connected) || (ESP_OK != esp_wifi_sta_get_ap_info(&ap_info)))
+    {
+        return 0;
+    }
+    return ap_info.rssi;
+}
 //---------------------------- PRIVATE FUNCTIONS ------------------------------
 static esp_err_t _nvs_init(void)
 {
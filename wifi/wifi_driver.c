@@ -86,6 +86,11 @@ bool is_connected_wifi()
 {
     return is_connected();
 }
+
+int8_t wifi_get_rssi(void)
+{
+    return get_rssi();
+}
 //---------------------------- PRIVATE FUNCTIONS ------------------------------
 
 //---------------------------- INTERRUPT HANDLERS -----------------------------
@@ -54,6 +54,13 @@ void wifi_register_on_status_changed(wifi_on_status_changed_cb_t cbk);
  */
 bool is_connected_wifi();
 
+/**
+ * It returns the signal strength of the access point the station is joined to.
+ * 
+ * @return The RSSI in dBm, 0 if not connected.
+ */
+int8_t wifi_get_rssi(void);
+
 #ifdef __cplusplus
 }
 #endif